@@ -0,0 +1,223 @@
+# libfort-time - Time utilities for the FORmicidae Tracker.
+#
+# Copyright (C) 2017-2023  Universitée de Lausanne
+#
+# This file is part of libfort-time.
+#
+# libfort-time is free software: you can redistribute it and/or modify it under
+# the terms of the GNU General Public License as published by the Free Software
+# Foundation, either version 3 of the License, or (at your option) any later
+# version.
+#
+# libfort-time is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+# details.
+#
+# You should have received a copy of the GNU General Public License along with
+# libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+
+# Compares benchmark results against a baseline.
+#
+#   cmake -DBENCHMARK=<executable> -DBASELINE=<baseline.json>
+#         -DOUTPUT=<results.json> [-DREPETITIONS=5] [-DUPDATE=On]
+#         -P BenchmarkGate.cmake
+#
+# Each benchmark listed in the baseline is run REPETITIONS times, and the
+# results are written to OUTPUT in the google benchmark JSON format. The
+# median CPU time of a benchmark fails the gate if it exceeds its baseline
+# time by more than its tolerance, in percent:
+#
+#   {
+#   	"tolerance": 25,
+#   	"benchmarks": [
+#   		{ "name": "BM_TimeNow", "cpu_time": 89.125, "time_unit": "ns",
+#   		  "tolerance": 50 }
+#   	]
+#   }
+#
+# A benchmark without tolerance uses the top-level one. With UPDATE, the
+# baseline times are replaced by the measured ones, keeping tolerances.
+# Times only compare on the same machine and build type.
+
+cmake_minimum_required(VERSION 3.19)
+
+foreach(var BENCHMARK BASELINE OUTPUT)
+	if(NOT DEFINED ${var})
+		message(FATAL_ERROR "${var} is not defined")
+	endif(NOT DEFINED ${var})
+endforeach(var BENCHMARK BASELINE OUTPUT)
+
+if(NOT DEFINED REPETITIONS)
+	set(REPETITIONS 5)
+endif(NOT DEFINED REPETITIONS)
+
+# Converts a time, in decimal or scientific notation, to integer
+# picoseconds. CMake math() only handles integers.
+function(to_picoseconds value unit out)
+	if(NOT value MATCHES "^([0-9]+)(\\.([0-9]*))?([eE]([+-]?[0-9]+))?$")
+		message(FATAL_ERROR "invalid time '${value}'")
+	endif(NOT value MATCHES "^([0-9]+)(\\.([0-9]*))?([eE]([+-]?[0-9]+))?$")
+	set(digits "${CMAKE_MATCH_1}${CMAKE_MATCH_3}")
+	string(LENGTH "${CMAKE_MATCH_3}" fraction)
+	string(REGEX REPLACE "^\\+" "" exponent "0${CMAKE_MATCH_5}")
+	string(REGEX REPLACE "^0([+-])" "\\1" exponent "${exponent}")
+
+	if(unit STREQUAL "ns")
+		set(scale 3)
+	elseif(unit STREQUAL "us")
+		set(scale 6)
+	elseif(unit STREQUAL "ms")
+		set(scale 9)
+	elseif(unit STREQUAL "s")
+		set(scale 12)
+	else(unit STREQUAL "ns")
+		message(FATAL_ERROR "invalid time unit '${unit}'")
+	endif(unit STREQUAL "ns")
+
+	math(EXPR exponent "${exponent} - ${fraction} + ${scale}")
+	if(exponent GREATER_EQUAL 0)
+		string(REPEAT "0" ${exponent} zeros)
+		string(APPEND digits "${zeros}")
+	else(exponent GREATER_EQUAL 0)
+		string(LENGTH "${digits}" length)
+		math(EXPR length "${length} + ${exponent}")
+		if(length GREATER 0)
+			string(SUBSTRING "${digits}" 0 ${length} digits)
+		else(length GREATER 0)
+			set(digits 0)
+		endif(length GREATER 0)
+	endif(exponent GREATER_EQUAL 0)
+	# leading zeros could be read as octal.
+	string(REGEX REPLACE "^0+([0-9])" "\\1" digits "${digits}")
+	set(${out}
+		${digits}
+		PARENT_SCOPE
+	)
+endfunction(to_picoseconds)
+
+# Formats integer picoseconds as nanoseconds with three decimals.
+function(format_nanoseconds picoseconds out)
+	math(EXPR integer "${picoseconds} / 1000")
+	math(EXPR decimals "${picoseconds} % 1000 + 1000")
+	string(SUBSTRING "${decimals}" 1 3 decimals)
+	set(${out}
+		"${integer}.${decimals}"
+		PARENT_SCOPE
+	)
+endfunction(format_nanoseconds)
+
+file(READ ${BASELINE} baseline)
+string(JSON default_tolerance GET "${baseline}" tolerance)
+string(JSON count LENGTH "${baseline}" benchmarks)
+if(count EQUAL 0)
+	message(FATAL_ERROR "no benchmark in ${BASELINE}")
+endif(count EQUAL 0)
+math(EXPR last "${count} - 1")
+
+set(names)
+foreach(i RANGE ${last})
+	string(JSON name GET "${baseline}" benchmarks ${i} name)
+	string(JSON time GET "${baseline}" benchmarks ${i} cpu_time)
+	string(JSON unit GET "${baseline}" benchmarks ${i} time_unit)
+	string(
+		JSON
+		tolerance
+		ERROR_VARIABLE
+		no_tolerance
+		GET
+		"${baseline}"
+		benchmarks
+		${i}
+		tolerance
+	)
+	if(no_tolerance)
+		set(tolerance ${default_tolerance})
+	endif(no_tolerance)
+	list(APPEND names ${name})
+	to_picoseconds(${time} ${unit} baseline_${name})
+	set(tolerance_${name} ${tolerance})
+endforeach(i RANGE ${last})
+
+list(JOIN names "|" filter)
+execute_process(
+	COMMAND
+		${BENCHMARK} "--benchmark_filter=^(${filter})$"
+		--benchmark_repetitions=${REPETITIONS}
+		--benchmark_report_aggregates_only=true --benchmark_out=${OUTPUT}
+		--benchmark_out_format=json
+	RESULT_VARIABLE benchmark_result
+)
+if(NOT benchmark_result EQUAL 0)
+	message(FATAL_ERROR "${BENCHMARK} failed: ${benchmark_result}")
+endif(NOT benchmark_result EQUAL 0)
+
+file(READ ${OUTPUT} results)
+string(JSON count LENGTH "${results}" benchmarks)
+if(count GREATER 0)
+	math(EXPR last "${count} - 1")
+	foreach(i RANGE ${last})
+		string(JSON aggregate ERROR_VARIABLE not_aggregate GET "${results}"
+			   benchmarks ${i} aggregate_name
+		)
+		if(not_aggregate OR NOT aggregate STREQUAL "median")
+			continue()
+		endif(not_aggregate OR NOT aggregate STREQUAL "median")
+		string(JSON name GET "${results}" benchmarks ${i} run_name)
+		string(JSON time GET "${results}" benchmarks ${i} cpu_time)
+		string(JSON unit GET "${results}" benchmarks ${i} time_unit)
+		to_picoseconds(${time} ${unit} measured_${name})
+	endforeach(i RANGE ${last})
+endif(count GREATER 0)
+
+set(missing 0)
+set(regressions 0)
+set(updated "{\n\t\"tolerance\": ${default_tolerance},\n\t\"benchmarks\": [")
+set(separator "")
+foreach(name ${names})
+	if(NOT DEFINED measured_${name})
+		message("${name}: not run")
+		math(EXPR missing "${missing} + 1")
+		continue()
+	endif(NOT DEFINED measured_${name})
+
+	set(measured ${measured_${name}})
+	set(reference ${baseline_${name}})
+	set(tolerance ${tolerance_${name}})
+	format_nanoseconds(${measured} measured_ns)
+	format_nanoseconds(${reference} reference_ns)
+	string(APPEND updated "${separator}\n\t\t{\n\t\t\t\"name\": \"${name}\",\n"
+		   "\t\t\t\"cpu_time\": ${measured_ns},\n"
+		   "\t\t\t\"time_unit\": \"ns\",\n"
+		   "\t\t\t\"tolerance\": ${tolerance}\n\t\t}"
+	)
+	set(separator ",")
+
+	math(EXPR limit "${reference} * (100 + ${tolerance}) / 100")
+	if(reference GREATER 0)
+		math(EXPR change "(${measured} - ${reference}) * 100 / ${reference}")
+	else(reference GREATER 0)
+		set(change 0)
+	endif(reference GREATER 0)
+	if(measured GREATER limit)
+		set(status "REGRESSION")
+		math(EXPR regressions "${regressions} + 1")
+	else(measured GREATER limit)
+		set(status "ok")
+	endif(measured GREATER limit)
+	message("${name}: ${measured_ns} ns, baseline ${reference_ns} ns, "
+			"${change}% (tolerance ${tolerance}%) ${status}"
+	)
+endforeach(name ${names})
+string(APPEND updated "\n\t]\n}\n")
+
+if(missing GREATER 0)
+	message(FATAL_ERROR "${missing} benchmark(s) of ${BASELINE} did not run")
+endif(missing GREATER 0)
+
+if(UPDATE)
+	file(WRITE ${BASELINE} "${updated}")
+	message("updated ${BASELINE}")
+elseif(regressions GREATER 0)
+	message(FATAL_ERROR "${regressions} benchmark(s) regressed")
+endif(UPDATE)
@@ -0,0 +1,142 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#include <stdexcept>
+
+#include "CachedClock.hpp"
+
+namespace fort {
+
+CachedClock::Subscription::Subscription(CachedClock &clock)
+    : d_clock(clock) {
+	d_clock.Subscribe();
+}
+
+CachedClock::Subscription::~Subscription() {
+	d_clock.Unsubscribe();
+}
+
+CachedClock::CachedClock(const Duration &interval, Clock &source)
+    : d_interval(interval)
+    , d_source(source)
+    , d_sequence(0)
+    , d_wallSec(0)
+    , d_wallNsec(0)
+    , d_mono(0)
+    , d_monoID(0)
+    , d_running(false)
+    , d_subscribers(0)
+    , d_stop(false) {
+	if (interval <= 0) {
+		throw std::invalid_argument("Refresh interval must be positive");
+	}
+}
+
+CachedClock::~CachedClock() {
+	{
+		std::lock_guard<std::mutex> lock(d_mutex);
+		d_stop = true;
+	}
+	d_signal.notify_all();
+	if (d_updater.joinable()) {
+		d_updater.join();
+	}
+}
+
+Time CachedClock::Now() {
+	if (Running() == false) {
+		return d_source.Now();
+	}
+	for (;;) {
+		uint64_t sequence = d_sequence.load(std::memory_order_acquire);
+		if ((sequence & 1) != 0) {
+			// the updater is preempted in the middle of Publish().
+			std::this_thread::yield();
+			continue;
+		}
+		int64_t  wallSec  = d_wallSec.load(std::memory_order_relaxed);
+		int32_t  wallNsec = d_wallNsec.load(std::memory_order_relaxed);
+		uint64_t mono     = d_mono.load(std::memory_order_relaxed);
+		uint32_t monoID   = d_monoID.load(std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (d_sequence.load(std::memory_order_relaxed) == sequence) {
+			return details::FromRawTime({wallSec, wallNsec, mono, monoID});
+		}
+	}
+}
+
+void CachedClock::SleepUntil(const Time &deadline) {
+	d_source.SleepUntil(deadline);
+}
+
+void CachedClock::Publish(const Time &t) {
+	// Publish() has a single writer at a time.
+	uint64_t sequence = d_sequence.load(std::memory_order_relaxed);
+	d_sequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	auto raw = details::ToRawTime(t);
+	d_wallSec.store(raw.WallSec, std::memory_order_relaxed);
+	d_wallNsec.store(raw.WallNsec, std::memory_order_relaxed);
+	d_mono.store(raw.Mono, std::memory_order_relaxed);
+	d_monoID.store(raw.MonoID, std::memory_order_relaxed);
+	d_sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void CachedClock::Subscribe() {
+	std::lock_guard<std::mutex> subscribeLock(d_subscribeMutex);
+	if (d_subscribers++ > 0) {
+		return;
+	}
+	Publish(d_source.Now());
+	{
+		std::lock_guard<std::mutex> lock(d_mutex);
+		d_stop = false;
+	}
+	d_running.store(true, std::memory_order_release);
+
+	d_updater = std::thread([this]() {
+		const std::chrono::nanoseconds period(d_interval.Nanoseconds());
+
+		std::unique_lock<std::mutex> lock(d_mutex);
+		for (;;) {
+			// a cache does not need drift-free deadlines.
+			if (d_signal.wait_for(lock, period, [this]() { return d_stop; })) {
+				return;
+			}
+			lock.unlock();
+			Publish(d_source.Now());
+			lock.lock();
+		}
+	});
+}
+
+void CachedClock::Unsubscribe() {
+	std::lock_guard<std::mutex> subscribeLock(d_subscribeMutex);
+	if (--d_subscribers > 0) {
+		return;
+	}
+	d_running.store(false, std::memory_order_release);
+	{
+		std::lock_guard<std::mutex> lock(d_mutex);
+		d_stop = true;
+	}
+	d_signal.notify_all();
+	d_updater.join();
+}
+
+} // namespace fort
@@ -0,0 +1,159 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "Clock.hpp"
+
+namespace fort {
+
+/**
+ * A Clock returning a periodically refreshed Time
+ *
+ * A background thread reads a source Clock every interval and
+ * publishes the Time through a sequence lock. Now() then costs a few
+ * atomic loads and no system call, from any number of threads, at the
+ * price of returning a Time up to one interval old. Successive Now()
+ * never go backward if the source does not.
+ *
+ * The background thread only runs while the CachedClock has at least
+ * one Subscription: the first one starts it, and it stops when the
+ * last one is destroyed. Without Subscription, Now() reads the source
+ * directly.
+ *
+ * ```c++
+ * using namespace fort;
+ * CachedClock clock(Duration::Millisecond);
+ * CachedClock::Subscription subscription(clock);
+ * Clock::Override override(clock);
+ * // Time::Now() now returns a Time refreshed every millisecond.
+ * ```
+ */
+class CachedClock : public Clock {
+public:
+	/**
+	 * Keeps the background thread of a CachedClock running
+	 */
+	class Subscription {
+	public:
+		/**
+		 * Subscribes to a CachedClock
+		 *
+		 * @param clock the CachedClock to subscribe to. It must
+		 *        outlive this Subscription.
+		 */
+		Subscription(CachedClock &clock);
+		/**
+		 * Unsubscribes, stopping the background thread if this was
+		 * the last Subscription.
+		 */
+		~Subscription();
+
+		Subscription(const Subscription &)            = delete;
+		Subscription &operator=(const Subscription &) = delete;
+
+	private:
+		CachedClock &d_clock;
+	};
+
+	/**
+	 * Constructor
+	 *
+	 * @param interval the Duration between two refreshes
+	 * @param source the Clock to cache. It must outlive this
+	 *        CachedClock, and must not be itself installed through
+	 *        this CachedClock.
+	 *
+	 * @throws std::invalid_argument if interval is not positive.
+	 */
+	CachedClock(
+	    const Duration &interval = Duration::Millisecond,
+	    Clock          &source   = SystemClock::Instance()
+	);
+
+	/**
+	 * Stops the background thread, if any.
+	 */
+	virtual ~CachedClock();
+
+	/**
+	 * Gets the last published Time
+	 *
+	 * @return the Time of the source at the last refresh, or the
+	 *         current Time of the source without Subscription.
+	 */
+	Time Now() override;
+
+	/**
+	 * Waits until deadline on the source Clock
+	 *
+	 * @param deadline the Time to wait for
+	 */
+	void SleepUntil(const Time &deadline) override;
+
+	/**
+	 * Gets the refresh interval
+	 *
+	 * @return the Duration between two refreshes.
+	 */
+	inline Duration Interval() const {
+		return d_interval;
+	}
+
+	/**
+	 * Tells if the background thread runs
+	 *
+	 * @return `true` if Now() returns cached values.
+	 */
+	inline bool Running() const {
+		return d_running.load(std::memory_order_acquire);
+	}
+
+private:
+	void Subscribe();
+	void Unsubscribe();
+	void Publish(const Time &t);
+
+	Duration d_interval;
+	Clock   &d_source;
+
+	// Sequence lock: odd while Publish() writes the fields below.
+	alignas(64) std::atomic<uint64_t> d_sequence;
+	std::atomic<int64_t>  d_wallSec;
+	std::atomic<int32_t>  d_wallNsec;
+	std::atomic<uint64_t> d_mono;
+	std::atomic<uint32_t> d_monoID;
+	std::atomic<bool>     d_running;
+
+	// Serializes starting and stopping the updater.
+	alignas(64) std::mutex d_subscribeMutex;
+	size_t                 d_subscribers;
+
+	std::mutex              d_mutex;
+	std::condition_variable d_signal;
+	bool                    d_stop;
+	std::thread             d_updater;
+};
+
+} // namespace fort
@@ -0,0 +1,100 @@
+#include "CachedClock.hpp"
+
+#include <thread>
+#include <vector>
+
+#include "CachedClockUTest.hpp"
+
+namespace fort {
+
+static bool SameMono(const Time &a, const Time &b) {
+	return a.Equals(b) && a.MonotonicValue() == b.MonotonicValue();
+}
+
+TEST_F(CachedClockUTest, RefreshesWhileSubscribed) {
+	EXPECT_THROW(CachedClock(0), std::invalid_argument);
+
+	VirtualClock source(Time::FromUnix(1000, 0));
+	CachedClock  clock(10 * Duration::Microsecond, source);
+	EXPECT_EQ(clock.Interval(), 10 * Duration::Microsecond);
+	EXPECT_FALSE(clock.Running());
+	source.Advance(Duration::Second);
+	EXPECT_TRUE(SameMono(clock.Now(), source.Now()));
+
+	{
+		CachedClock::Subscription first(clock);
+		EXPECT_TRUE(clock.Running());
+		auto start = clock.Now();
+		EXPECT_TRUE(SameMono(start, source.Now()));
+
+		source.Advance(Duration::Second);
+		{
+			CachedClock::Subscription second(clock);
+			for (int i = 0; i < 1000 && SameMono(clock.Now(), start); ++i) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+			EXPECT_TRUE(SameMono(clock.Now(), source.Now()));
+		}
+		EXPECT_TRUE(clock.Running());
+	}
+	EXPECT_FALSE(clock.Running());
+	source.Advance(Duration::Second);
+	EXPECT_TRUE(SameMono(clock.Now(), source.Now()));
+
+	// the updater can be restarted
+	CachedClock::Subscription again(clock);
+	EXPECT_TRUE(clock.Running());
+	EXPECT_TRUE(SameMono(clock.Now(), source.Now()));
+}
+
+TEST_F(CachedClockUTest, ReadsAreConsistent) {
+	// wall and monotonic values of the VirtualClock move together, a
+	// torn read would break it.
+	auto         start = Time::FromUnix(1000, 0);
+	VirtualClock source(start);
+	CachedClock  clock(Duration::Microsecond, source);
+	start = source.Now();
+
+	CachedClock::Subscription subscription(clock);
+	std::atomic<bool>         stop(false);
+	std::vector<std::thread>  readers;
+	std::atomic<size_t>       errors(0);
+	for (size_t i = 0; i < 2; ++i) {
+		readers.emplace_back([&]() {
+			auto last = clock.Now();
+			while (stop.load() == false) {
+				auto t    = clock.Now();
+				auto wall = t.Round(Duration::Nanosecond).Sub(start);
+				if (t.Before(last) ||
+				    wall.Nanoseconds() !=
+				        int64_t(t.MonotonicValue() - start.MonotonicValue())) {
+					errors.fetch_add(1);
+				}
+				last = t;
+			}
+		});
+	}
+	auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(50);
+	for (int64_t i = 0; std::chrono::steady_clock::now() < end; ++i) {
+		source.Advance(Duration::Millisecond + i);
+	}
+	stop.store(true);
+	for (auto &r : readers) {
+		r.join();
+	}
+	EXPECT_EQ(errors.load(), 0);
+}
+
+TEST_F(CachedClockUTest, CachesTheSystemClock) {
+	CachedClock               clock(Duration::Millisecond);
+	CachedClock::Subscription subscription(clock);
+	Clock::Override           override(clock);
+
+	for (size_t i = 0; i < 100; ++i) {
+		auto cached = Time::Now();
+		EXPECT_EQ(cached.MonoID(), Time::MonoclockID(Time::SYSTEM_MONOTONIC_CLOCK));
+		EXPECT_FALSE(SystemClock::Instance().Now().Before(cached));
+	}
+}
+
+} // namespace fort
@@ -0,0 +1,102 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#include "Clock.hpp"
+#include "Ticker.hpp"
+
+namespace fort {
+
+std::atomic<Clock *> Clock::s_installed(nullptr);
+
+Clock::~Clock() {}
+
+Clock::Override::Override(Clock &clock)
+    : d_previous(s_installed.exchange(&clock, std::memory_order_acq_rel)) {}
+
+Clock::Override::~Override() {
+	s_installed.store(d_previous, std::memory_order_release);
+}
+
+Clock &Clock::Current() {
+	auto clock = Installed();
+	if (clock != nullptr) {
+		return *clock;
+	}
+	return SystemClock::Instance();
+}
+
+SystemClock &SystemClock::Instance() {
+	static SystemClock instance;
+	return instance;
+}
+
+Time SystemClock::Now() {
+	return details::SystemNow();
+}
+
+void SystemClock::SleepUntil(const Time &deadline) {
+	fort::SleepUntil(deadline);
+}
+
+static Time VirtualStart(const Time &start) {
+	if (start.HasMono() && start.MonoID() == Time::SYSTEM_MONOTONIC_CLOCK) {
+		return start;
+	}
+	return Time::FromTimestampAndMonotonic(
+	    start.ToTimestamp(),
+	    0,
+	    Time::SYSTEM_MONOTONIC_CLOCK
+	);
+}
+
+VirtualClock::VirtualClock(const Time &start)
+    : d_start(VirtualStart(start))
+    , d_elapsed(0) {}
+
+Time VirtualClock::Now() {
+	return d_start.Add(d_elapsed.load(std::memory_order_acquire));
+}
+
+void VirtualClock::SleepUntil(const Time &deadline) {
+	Set(deadline);
+}
+
+void VirtualClock::Advance(const Duration &d) {
+	if (d > 0) {
+		d_elapsed.fetch_add(d.Nanoseconds(), std::memory_order_acq_rel);
+	}
+}
+
+void VirtualClock::Set(const Time &t) {
+	int64_t target  = t.Sub(d_start).Nanoseconds();
+	int64_t elapsed = d_elapsed.load(std::memory_order_acquire);
+	while (elapsed < target &&
+	       d_elapsed.compare_exchange_weak(
+	           elapsed,
+	           target,
+	           std::memory_order_acq_rel,
+	           std::memory_order_acquire
+	       ) == false) {
+	}
+}
+
+Duration VirtualClock::Elapsed() const {
+	return d_elapsed.load(std::memory_order_acquire);
+}
+
+} // namespace fort
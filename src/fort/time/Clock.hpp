@@ -0,0 +1,263 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+#include "Time.hpp"
+
+namespace fort {
+
+/**
+ * A source of current Time
+ *
+ * Clock abstracts Time::Now() and SleepUntil(). A Clock can be
+ * installed process-wide with a Clock::Override, after which
+ * Time::Now(), SleepUntil() and Ticker use it instead of the system
+ * clocks. Components that need their own time base can also hold a
+ * Clock reference and query it directly.
+ *
+ * When no Clock is installed, Time::Now() costs one extra predictable
+ * branch over reading the system clocks.
+ *
+ * SteadyClock should be used where the standard library expects a
+ * _Clock_ type.
+ */
+class Clock {
+public:
+	/**
+	 * Installs a Clock process-wide for the lifetime of this object
+	 *
+	 * ```c++
+	 * using namespace fort;
+	 * VirtualClock clock;
+	 * Clock::Override override(clock);
+	 * // Time::Now() now returns clock.Now()
+	 * ```
+	 *
+	 * Overrides can be nested, the previous Clock is restored on
+	 * destruction.
+	 */
+	class Override {
+	public:
+		/**
+		 * Installs clock process-wide
+		 *
+		 * @param clock the Clock to install. It must outlive this
+		 *        Override.
+		 */
+		Override(Clock &clock);
+		/**
+		 * Restores the previously installed Clock.
+		 */
+		~Override();
+
+		Override(const Override &)            = delete;
+		Override &operator=(const Override &) = delete;
+
+	private:
+		Clock *d_previous;
+	};
+
+	virtual ~Clock();
+
+	/**
+	 * Gets the current Time of this Clock
+	 *
+	 * @return the current Time
+	 */
+	virtual Time Now() = 0;
+
+	/**
+	 * Waits until a deadline of this Clock
+	 *
+	 * @param deadline the Time to wait for.
+	 */
+	virtual void SleepUntil(const Time &deadline) = 0;
+
+	/**
+	 * Gets the Clock installed process-wide
+	 *
+	 * @return the installed Clock, or `nullptr` if the system clocks
+	 *         are used.
+	 */
+	static inline Clock *Installed() {
+		return s_installed.load(std::memory_order_acquire);
+	}
+
+	/**
+	 * Gets the Clock currently in use process-wide
+	 *
+	 * @return the installed Clock, or the SystemClock.
+	 */
+	static Clock &Current();
+
+private:
+	static std::atomic<Clock *> s_installed;
+};
+
+/**
+ * A standard _Clock_ reading `CLOCK_MONOTONIC`
+ *
+ * SteadyClock meets the standard _Clock_ requirements. Its time_point
+ * is the one of `std::chrono::steady_clock`, which shares its epoch,
+ * so deadlines passed to `std::condition_variable::wait_until()` or
+ * `std::this_thread::sleep_until()` are used as is, without the clock
+ * re-reads a foreign clock would need:
+ *
+ * ```c++
+ * using namespace fort;
+ * auto timeout = (10 * Duration::Millisecond).ToChrono();
+ * cv.wait_until(lock, SteadyClock::now() + timeout);
+ * std::this_thread::sleep_until(deadline.ToSteadyTimePoint());
+ * ```
+ *
+ * It is not a Clock and ignores any installed Clock: an override
+ * cannot change the clock the standard library waits on.
+ */
+struct SteadyClock {
+	/** The tick count type of the standard _Clock_ requirements. */
+	typedef int64_t rep;
+	/** The tick period of the standard _Clock_ requirements. */
+	typedef std::nano period;
+	/** The duration type of the standard _Clock_ requirements. */
+	typedef std::chrono::nanoseconds duration;
+	/** The time point type, shared with `std::chrono::steady_clock`. */
+	typedef std::chrono::steady_clock::time_point time_point;
+	/** SteadyClock never goes backward. */
+	static constexpr bool is_steady = true;
+
+	/**
+	 * Reads `CLOCK_MONOTONIC` as a standard time point
+	 *
+	 * @return the current #time_point, comparable with
+	 *         Time::ToSteadyTimePoint().
+	 */
+	static inline time_point now() noexcept {
+		return std::chrono::steady_clock::now();
+	}
+};
+
+/**
+ * The Clock reading the system clocks
+ *
+ * It always uses `CLOCK_REALTIME` and `CLOCK_MONOTONIC`, regardless of
+ * any installed Clock.
+ */
+class SystemClock : public Clock {
+public:
+	/**
+	 * Gets the SystemClock
+	 *
+	 * @return the process SystemClock instance
+	 */
+	static SystemClock &Instance();
+
+	/**
+	 * Gets the system current Time
+	 *
+	 * @return the same Time than Time::Now() with no installed Clock.
+	 */
+	Time Now() override;
+
+	/**
+	 * Sleeps until deadline on `CLOCK_MONOTONIC`
+	 *
+	 * @param deadline the Time to wake up at. It must have a
+	 *        #Time::SYSTEM_MONOTONIC_CLOCK value.
+	 */
+	void SleepUntil(const Time &deadline) override;
+};
+
+/**
+ * A manually advanced Clock
+ *
+ * A VirtualClock only moves when Advance() or Set() is called, or when
+ * a thread sleeps on it: SleepUntil() jumps the Clock to the deadline
+ * instead of waiting. This allows running hour-long scheduling
+ * scenarios in milliseconds.
+ *
+ * Its Time have both a wall and a #Time::SYSTEM_MONOTONIC_CLOCK value,
+ * which move together, so Time::Sub() and comparisons behave as with
+ * the system clocks. It is safe to use from several threads.
+ *
+ * ```c++
+ * using namespace fort;
+ * VirtualClock clock;
+ * Clock::Override override(clock);
+ * Ticker ticker(Duration::Hour);
+ * for (int i = 0; i < 24; ++i) {
+ *     ticker.Wait(); // returns immediately
+ * }
+ * ```
+ */
+class VirtualClock : public Clock {
+public:
+	/**
+	 * Constructor
+	 *
+	 * @param start the initial Time of the Clock. If it has no
+	 *        #Time::SYSTEM_MONOTONIC_CLOCK value, the monotonic
+	 *        value starts at zero.
+	 */
+	VirtualClock(const Time &start = Time::FromUnix(0, 0));
+
+	/**
+	 * Gets the current virtual Time
+	 *
+	 * @return the start Time plus the elapsed virtual Duration.
+	 */
+	Time Now() override;
+
+	/**
+	 * Jumps to deadline if it is in the future.
+	 *
+	 * @param deadline the Time to sleep until
+	 */
+	void SleepUntil(const Time &deadline) override;
+
+	/**
+	 * Advances the Clock
+	 *
+	 * @param d the Duration to advance by. Negative values are
+	 *        ignored, as time cannot go backward.
+	 */
+	void Advance(const Duration &d);
+
+	/**
+	 * Moves the Clock forward to a Time
+	 *
+	 * @param t the Time to move to. Ignored if it is in the past.
+	 */
+	void Set(const Time &t);
+
+	/**
+	 * Gets the total elapsed virtual Duration
+	 *
+	 * @return the Duration since the start Time.
+	 */
+	Duration Elapsed() const;
+
+private:
+	Time                 d_start;
+	std::atomic<int64_t> d_elapsed;
+};
+
+} // namespace fort
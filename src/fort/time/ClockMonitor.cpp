@@ -0,0 +1,148 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#include "ClockMonitor.hpp"
+
+namespace fort {
+
+namespace {
+
+inline uint64_t Magnitude(int64_t v) {
+	return v < 0 ? -uint64_t(v) : uint64_t(v);
+}
+
+inline double PartsPerMillion(int64_t drift, uint64_t elapsed) {
+	return elapsed == 0 ? 0.0 : 1.0e6 * double(drift) / double(elapsed);
+}
+
+} // namespace
+
+ClockMonitor::ClockMonitor(const ClockMonitorOptions &options)
+    : d_options(options)
+    , d_last(0) {
+	if (options.StepThreshold <= 0 || options.SlewThreshold <= 0 ||
+	    options.RateThreshold <= 0.0 || options.RateWindow <= 0) {
+		throw std::invalid_argument(
+		    "ClockMonitor thresholds and window must be positive"
+		);
+	}
+}
+
+ClockMonitor::Reference ClockMonitor::ReferenceOf(const Time &t) {
+	auto raw = details::ToRawTime(t);
+	return {
+	    uint64_t(raw.WallSec) * 1000000000ULL + raw.WallNsec - raw.Mono,
+	    raw.Mono,
+	};
+}
+
+ClockMonitor::Stream &ClockMonitor::FindStream(const Time &t) {
+	if (t.HasMono() == false) {
+		throw std::invalid_argument(
+		    "Time has no monotonic value: " + t.DebugString()
+		);
+	}
+	uint32_t rawID = details::ToRawTime(t).MonoID;
+	if (d_last < d_streams.size() && d_streams[d_last].RawID == rawID) {
+		return d_streams[d_last];
+	}
+	auto fi = std::find_if(
+	    d_streams.begin(),
+	    d_streams.end(),
+	    [rawID](const Stream &s) { return s.RawID == rawID; }
+	);
+	if (fi == d_streams.end()) {
+		// the first Time is the reference of everything.
+		auto ref = ReferenceOf(t);
+		d_streams.push_back({rawID, ref, ref, ref});
+		fi = d_streams.end() - 1;
+	}
+	d_last = fi - d_streams.begin();
+	return *fi;
+}
+
+size_t ClockMonitor::Add(const Time &t, std::vector<ClockEvent> &events) {
+	Stream   &stream = FindStream(t);
+	Reference current = ReferenceOf(t);
+	if (current.Mono < stream.Last.Mono) {
+		stream.Last = stream.Slew = stream.Window = current;
+		return 0;
+	}
+
+	int64_t step = int64_t(current.Offset - stream.Last.Offset);
+	stream.Last  = current;
+	if (Magnitude(step) > uint64_t(d_options.StepThreshold.Nanoseconds())) {
+		events.push_back({t.MonoID(), ClockEventType::STEP, t, step, 0.0});
+		// a step is not part of any drift.
+		stream.Slew = stream.Window = current;
+		return 1;
+	}
+
+	size_t  res  = 0;
+	int64_t slew = int64_t(current.Offset - stream.Slew.Offset);
+	if (Magnitude(slew) > uint64_t(d_options.SlewThreshold.Nanoseconds())) {
+		events.push_back(
+		    {t.MonoID(),
+		     ClockEventType::SLEW,
+		     t,
+		     slew,
+		     PartsPerMillion(slew, current.Mono - stream.Slew.Mono)}
+		);
+		stream.Slew = current;
+		++res;
+	}
+
+	uint64_t elapsed = current.Mono - stream.Window.Mono;
+	if (elapsed >= uint64_t(d_options.RateWindow.Nanoseconds())) {
+		int64_t drift = int64_t(current.Offset - stream.Window.Offset);
+		double  rate  = PartsPerMillion(drift, elapsed);
+		if (std::abs(rate) > d_options.RateThreshold) {
+			events.push_back({t.MonoID(), ClockEventType::RATE, t, drift, rate});
+			++res;
+		}
+		stream.Window = current;
+	}
+	return res;
+}
+
+size_t
+ClockMonitor::Add(const std::vector<Time> &times, std::vector<ClockEvent> &events) {
+	size_t res = 0;
+	for (const auto &t : times) {
+		res += Add(t, events);
+	}
+	return res;
+}
+
+Duration ClockMonitor::Offset(Time::MonoclockID monoID) const {
+	for (const auto &s : d_streams) {
+		if ((s.RawID & ~details::RawTime::HAS_MONO_BIT) == monoID) {
+			return int64_t(s.Last.Offset);
+		}
+	}
+	throw std::out_of_range(
+	    "no Time for MonoclockID " + std::to_string(monoID)
+	);
+}
+
+} // namespace fort
@@ -0,0 +1,207 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Time.hpp"
+
+namespace fort {
+
+/**
+ * The kind of a ClockEvent
+ */
+enum class ClockEventType {
+	/**
+	 * The wall clock jumped between two consecutive Time, e.g. when
+	 * NTP or an operator set it.
+	 */
+	STEP = 0,
+	/**
+	 * The wall clock progressively drifted from the monotonic clock
+	 * by more than the slew threshold, e.g. during a NTP slew or a
+	 * leap second smear.
+	 */
+	SLEW,
+	/**
+	 * The wall clock ran faster or slower than the monotonic clock
+	 * over a whole window.
+	 */
+	RATE,
+};
+
+/**
+ * A change of the wall clock relative to the monotonic clock
+ */
+struct ClockEvent {
+	/**
+	 * The MonoclockID of the stream.
+	 */
+	fort::Time::MonoclockID MonoID;
+	/**
+	 * The kind of change.
+	 */
+	ClockEventType Type;
+	/**
+	 * The Time the change was detected at.
+	 */
+	fort::Time Time;
+	/**
+	 * The change of the wall-minus-monotonic offset: the jump of a
+	 * ClockEventType::STEP, or the drift accumulated since the last
+	 * reference for ClockEventType::SLEW and ClockEventType::RATE.
+	 */
+	Duration Offset;
+	/**
+	 * The drift rate in parts per million, positive if the wall clock
+	 * runs faster. Zero for ClockEventType::STEP.
+	 */
+	double Rate;
+};
+
+/**
+ * Options of a ClockMonitor
+ */
+struct ClockMonitorOptions {
+	/**
+	 * The smallest offset change between two consecutive Time
+	 * reported as a ClockEventType::STEP.
+	 */
+	Duration StepThreshold = Duration::Millisecond;
+	/**
+	 * The smallest drift accumulated since the last reference
+	 * reported as a ClockEventType::SLEW.
+	 */
+	Duration SlewThreshold = Duration::Millisecond;
+	/**
+	 * The smallest drift rate, in parts per million, reported as a
+	 * ClockEventType::RATE.
+	 */
+	double RateThreshold = 100.0;
+	/**
+	 * The monotonic Duration over which the drift rate is measured.
+	 */
+	Duration RateWindow = 10 * Duration::Second;
+};
+
+/**
+ * Detects wall clock steps and slews from Time with monotonic values
+ *
+ * A Time read by Time::Now() holds both a wall and a monotonic value.
+ * Their difference, the offset, is constant as long as nobody touches
+ * the wall clock. For each MonoclockID, ClockMonitor tracks that
+ * offset and reports:
+ *
+ * * a ClockEventType::STEP when it changes by more than
+ *   ClockMonitorOptions::StepThreshold between two consecutive Time.
+ * * a ClockEventType::SLEW when it drifted by more than
+ *   ClockMonitorOptions::SlewThreshold since the last step or slew
+ *   event, or since the first Time.
+ * * a ClockEventType::RATE when it drifted faster than
+ *   ClockMonitorOptions::RateThreshold over each
+ *   ClockMonitorOptions::RateWindow.
+ *
+ * Each stream keeps a fixed size state, and adding a Time is a few
+ * integer operations, so it can run on every frame. A monotonic value
+ * going backward, e.g. when a framegrabber restarts, resets the state
+ * of its stream without event.
+ *
+ * ```c++
+ * using namespace fort;
+ * ClockMonitor monitor;
+ * std::vector<ClockEvent> events;
+ * for (const auto & frame : frames) {
+ *     if (monitor.Add(frame.Time, events) > 0) {
+ *         std::cerr << "wall clock changed at " << events.back().Time << std::endl;
+ *     }
+ * }
+ * ```
+ */
+class ClockMonitor {
+public:
+	/**
+	 * Constructor
+	 *
+	 * @param options the ClockMonitorOptions
+	 *
+	 * @throws std::invalid_argument if a threshold or the window is
+	 *         not positive.
+	 */
+	ClockMonitor(const ClockMonitorOptions &options = ClockMonitorOptions());
+
+	/**
+	 * Adds a Time
+	 *
+	 * @param t the Time to add
+	 * @param events the vector the detected ClockEvent are appended to
+	 *
+	 * @return the number of ClockEvent appended.
+	 *
+	 * @throws std::invalid_argument if t has no monotonic value.
+	 */
+	size_t Add(const Time &t, std::vector<ClockEvent> &events);
+
+	/**
+	 * Adds a batch of Time
+	 *
+	 * @param times the Time to add, in order for each stream
+	 * @param events the vector the detected ClockEvent are appended to
+	 *
+	 * @return the number of ClockEvent appended.
+	 *
+	 * @throws std::invalid_argument if a Time has no monotonic value.
+	 *         The preceding Time are accounted for.
+	 */
+	size_t Add(const std::vector<Time> &times, std::vector<ClockEvent> &events);
+
+	/**
+	 * Gets the current offset of a stream
+	 *
+	 * @param monoID the MonoclockID of the stream
+	 *
+	 * @return the wall time minus the monotonic value of the last
+	 *         Time of the stream.
+	 *
+	 * @throws std::out_of_range if no Time of the stream was added.
+	 */
+	Duration Offset(Time::MonoclockID monoID) const;
+
+private:
+	// Offsets are wall nanoseconds minus monotonic value, computed
+	// modulo 2^64: only their differences are meaningful.
+	struct Reference {
+		uint64_t Offset, Mono;
+	};
+
+	struct Stream {
+		uint32_t  RawID;
+		Reference Last, Slew, Window;
+	};
+
+	static Reference ReferenceOf(const Time &t);
+
+	Stream &FindStream(const Time &t);
+
+	ClockMonitorOptions d_options;
+	std::vector<Stream> d_streams;
+	size_t              d_last;
+};
+
+} // namespace fort
@@ -0,0 +1,134 @@
+#include "ClockMonitor.hpp"
+
+#include <functional>
+
+#include "ClockMonitorUTest.hpp"
+
+namespace fort {
+
+// A Time of stream monoID whose wall clock is offset(mono) ahead of
+// its monotonic value.
+static Time Frame(Time::MonoclockID monoID, uint64_t mono, int64_t offset) {
+	auto wall = Time::FromUnix(1700000000, 0).Add(int64_t(mono) + offset);
+	return Time::FromTimestampAndMonotonic(wall.ToTimestamp(), mono, monoID);
+}
+
+static std::vector<Time> Stream(
+    Time::MonoclockID                    monoID,
+    size_t                               n,
+    const Duration                      &period,
+    std::function<int64_t(uint64_t mono)> offset
+) {
+	std::vector<Time> res;
+	for (size_t i = 0; i < n; ++i) {
+		uint64_t mono = 1000000000ULL + i * period.Nanoseconds();
+		res.push_back(Frame(monoID, mono, offset(mono)));
+	}
+	return res;
+}
+
+TEST_F(ClockMonitorUTest, ChecksArguments) {
+	ClockMonitorOptions options;
+	options.StepThreshold = 0;
+	EXPECT_THROW(ClockMonitor{options}, std::invalid_argument);
+	options               = ClockMonitorOptions();
+	options.RateThreshold = 0.0;
+	EXPECT_THROW(ClockMonitor{options}, std::invalid_argument);
+	options            = ClockMonitorOptions();
+	options.RateWindow = -1;
+	EXPECT_THROW(ClockMonitor{options}, std::invalid_argument);
+
+	ClockMonitor            monitor;
+	std::vector<ClockEvent> events;
+	EXPECT_THROW(monitor.Add(Time::FromUnix(0, 0), events), std::invalid_argument);
+	EXPECT_THROW(monitor.Offset(1), std::out_of_range);
+	monitor.Add(Frame(1, 10, 42), events);
+	EXPECT_EQ(monitor.Offset(1), Duration(1700000000LL * 1000000000LL + 42));
+}
+
+TEST_F(ClockMonitorUTest, DetectsSteps) {
+	auto frames = Stream(1, 1000, 33 * Duration::Millisecond, [](uint64_t mono) {
+		// NTP sets the clock 2s ahead, then an operator sets it back
+		// by 0.5ms, below the threshold.
+		int64_t offset = 0;
+		if (mono > 10000000000ULL) {
+			offset += 2000000000LL;
+		}
+		if (mono > 20000000000ULL) {
+			offset -= 500000LL;
+		}
+		return offset;
+	});
+	ClockMonitor            monitor;
+	std::vector<ClockEvent> events;
+	EXPECT_EQ(monitor.Add(frames, events), 1);
+	ASSERT_EQ(events.size(), 1);
+	EXPECT_EQ(events[0].MonoID, 1);
+	EXPECT_EQ(events[0].Type, ClockEventType::STEP);
+	EXPECT_EQ(events[0].Offset, 2 * Duration::Second);
+	EXPECT_EQ(events[0].Rate, 0.0);
+	EXPECT_EQ(events[0].Time.MonotonicValue(), 1000000000ULL + 273 * 33000000ULL);
+}
+
+TEST_F(ClockMonitorUTest, DetectsLeapSecondSmear) {
+	// a leap second smeared over 24h, with a frame per second.
+	auto frames = Stream(1, 7200, Duration::Second, [](uint64_t mono) {
+		return -int64_t(mono / 86400);
+	});
+	ClockMonitor            monitor;
+	std::vector<ClockEvent> events;
+	monitor.Add(frames, events);
+	// 1ms of drift every 86.4s
+	EXPECT_NEAR(events.size(), 7200 / 86.4, 2.0);
+	for (const auto &e : events) {
+		EXPECT_EQ(e.Type, ClockEventType::SLEW);
+		EXPECT_LT(e.Offset, -Duration::Millisecond);
+		EXPECT_NEAR(e.Rate, -1e6 / 86400, 0.5);
+	}
+}
+
+TEST_F(ClockMonitorUTest, DetectsRateAnomalies) {
+	// NTP slews at its maximal rate of 500ppm for a minute.
+	auto frames = Stream(1, 1800, 100 * Duration::Millisecond, [](uint64_t mono) {
+		int64_t elapsed = std::min<int64_t>(
+		    std::max<int64_t>(int64_t(mono) - 31000000000LL, 0),
+		    60000000000LL
+		);
+		return elapsed / 2000;
+	});
+	ClockMonitor            monitor;
+	std::vector<ClockEvent> events;
+	monitor.Add(frames, events);
+	size_t rates = 0, slews = 0;
+	for (const auto &e : events) {
+		if (e.Type == ClockEventType::RATE) {
+			++rates;
+			EXPECT_EQ(e.Offset, 5 * Duration::Millisecond);
+			EXPECT_NEAR(e.Rate, 500.0, 1.0);
+		} else {
+			EXPECT_EQ(e.Type, ClockEventType::SLEW);
+			++slews;
+		}
+	}
+	EXPECT_EQ(rates, 6);
+	// 30ms drift in total, by steps slightly above 1ms.
+	EXPECT_NEAR(slews, 28, 2);
+}
+
+TEST_F(ClockMonitorUTest, StreamsAreIndependent) {
+	ClockMonitor            monitor;
+	std::vector<ClockEvent> events;
+	for (uint64_t i = 0; i < 100; ++i) {
+		uint64_t mono = 1000000000ULL + i * 10000000ULL;
+		monitor.Add(Frame(1, mono, 0), events);
+		// stream 2 restarts at frame 50, which is not a step.
+		monitor.Add(Frame(2, mono % 500000000ULL, i >= 50 ? 3000000000LL : 0), events);
+	}
+	EXPECT_TRUE(events.empty());
+	monitor.Add(Frame(2, 600000000ULL, 0), events);
+	ASSERT_EQ(events.size(), 1);
+	EXPECT_EQ(events[0].MonoID, 2);
+	EXPECT_EQ(events[0].Offset, -3 * Duration::Second);
+}
+
+} // namespace fort
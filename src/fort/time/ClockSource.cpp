@@ -0,0 +1,152 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#include <errno.h>
+
+#include <stdexcept>
+#include <system_error>
+
+#include "ClockSource.hpp"
+
+namespace fort {
+
+Time::MonoclockID SourceClock::MonoclockID(ClockSource source) {
+	switch (source) {
+	case ClockSource::SYSTEM:
+		return Time::SYSTEM_MONOTONIC_CLOCK;
+	case ClockSource::COARSE:
+		return Time::COARSE_MONOTONIC_CLOCK;
+	case ClockSource::BOOTTIME:
+		return Time::BOOTTIME_CLOCK;
+	case ClockSource::TAI:
+		return Time::TAI_MONOTONIC_CLOCK;
+	}
+	throw std::invalid_argument("Unknown ClockSource");
+}
+
+SourceClock::SourceClock(ClockSource source)
+    : d_source(source)
+    , d_wall(CLOCK_REALTIME)
+    , d_mono(CLOCK_MONOTONIC)
+    , d_monoID(MonoclockID(source)) {
+	switch (source) {
+	case ClockSource::SYSTEM:
+		break;
+	case ClockSource::COARSE:
+		d_wall = CLOCK_REALTIME_COARSE;
+		d_mono = CLOCK_MONOTONIC_COARSE;
+		break;
+	case ClockSource::BOOTTIME:
+		d_mono = CLOCK_BOOTTIME;
+		break;
+	case ClockSource::TAI:
+		d_wall = CLOCK_TAI;
+		break;
+	}
+}
+
+Time SourceClock::Now() {
+	struct timespec wall, mono;
+	if (clock_gettime(d_wall, &wall) < 0 || clock_gettime(d_mono, &mono) < 0) {
+		throw std::system_error(
+		    errno,
+		    std::system_category(),
+		    "On call of clock_gettime()"
+		);
+	}
+	return details::FromRawTime(
+	    {wall.tv_sec,
+	     int32_t(wall.tv_nsec),
+	     Time::MonoFromSecNSec(mono.tv_sec, mono.tv_nsec),
+	     details::RawTime::HAS_MONO_BIT | d_monoID}
+	);
+}
+
+void SourceClock::SleepUntil(const Time &deadline) {
+	if (deadline.HasMono() == false || deadline.MonoID() != d_monoID) {
+		throw std::invalid_argument(
+		    "deadline is not from this SourceClock: " + deadline.DebugString()
+		);
+	}
+	// coarse clocks cannot be slept on, but share the epoch of
+	// CLOCK_MONOTONIC.
+	clockid_t       clock = d_mono == CLOCK_BOOTTIME ? CLOCK_BOOTTIME
+	                                                 : CLOCK_MONOTONIC;
+	uint64_t        mono  = deadline.MonotonicValue();
+	struct timespec ts;
+	ts.tv_sec  = mono / 1000000000ULL;
+	ts.tv_nsec = mono % 1000000000ULL;
+	int res;
+	while ((res = clock_nanosleep(clock, TIMER_ABSTIME, &ts, nullptr)) ==
+	       EINTR) {
+	}
+	if (res != 0) {
+		throw std::system_error(
+		    res,
+		    std::system_category(),
+		    "On call of clock_nanosleep()"
+		);
+	}
+}
+
+static uint64_t ProbeMono() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return uint64_t(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+std::vector<ClockSourceInfo> ProbeClockSources(size_t iterations) {
+	static const std::vector<std::pair<ClockSource, const char *>> sources = {
+	    {ClockSource::SYSTEM, "system"},
+	    {ClockSource::COARSE, "coarse"},
+	    {ClockSource::BOOTTIME, "boottime"},
+	    {ClockSource::TAI, "tai"},
+	};
+	if (iterations == 0) {
+		iterations = 1;
+	}
+
+	std::vector<ClockSourceInfo> res;
+	for (const auto &[source, name] : sources) {
+		ClockSourceInfo info;
+		info.Source     = source;
+		info.Name       = name;
+		info.Available  = false;
+		info.Resolution = 0;
+		info.Cost       = 0;
+
+		SourceClock     clock(source);
+		struct timespec ts;
+		if (clock_getres(clock.d_mono, &ts) == 0 &&
+		    clock_gettime(clock.d_wall, &ts) == 0) {
+			info.Available = true;
+			clock_getres(clock.d_mono, &ts);
+			info.Resolution = ts.tv_sec * Duration::Second.Nanoseconds() +
+			                  ts.tv_nsec;
+			uint64_t start  = ProbeMono();
+			for (size_t i = 0; i < iterations; ++i) {
+				clock.Now();
+			}
+			info.Cost = int64_t((ProbeMono() - start) / iterations);
+		}
+		res.push_back(info);
+	}
+	return res;
+}
+
+} // namespace fort
@@ -0,0 +1,169 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <time.h>
+
+#include <string>
+#include <vector>
+
+#include "Clock.hpp"
+
+namespace fort {
+
+/**
+ * The system clocks a SourceClock can read
+ */
+enum class ClockSource {
+	/**
+	 * `CLOCK_REALTIME` and `CLOCK_MONOTONIC`, as Time::Now(). Uses
+	 * #Time::SYSTEM_MONOTONIC_CLOCK.
+	 */
+	SYSTEM = 0,
+	/**
+	 * `CLOCK_REALTIME_COARSE` and `CLOCK_MONOTONIC_COARSE`. Several
+	 * times cheaper, with a resolution of a scheduler tick. Uses
+	 * #Time::COARSE_MONOTONIC_CLOCK.
+	 */
+	COARSE,
+	/**
+	 * `CLOCK_REALTIME` and `CLOCK_BOOTTIME`, which keeps counting
+	 * during suspend. Uses #Time::BOOTTIME_CLOCK.
+	 */
+	BOOTTIME,
+	/**
+	 * `CLOCK_TAI` and `CLOCK_MONOTONIC`. Wall values are leap-second
+	 * free TAI instead of UTC. Uses #Time::TAI_MONOTONIC_CLOCK.
+	 */
+	TAI,
+};
+
+/**
+ * The result of probing a ClockSource
+ */
+struct ClockSourceInfo {
+	/**
+	 * The probed ClockSource.
+	 */
+	ClockSource Source;
+	/**
+	 * A human readable name of the ClockSource.
+	 */
+	std::string Name;
+	/**
+	 * `true` if the source can be read on this system.
+	 */
+	bool Available;
+	/**
+	 * The resolution of the source monotonic clock, as reported by
+	 * `clock_getres()`.
+	 */
+	Duration Resolution;
+	/**
+	 * The mean cost of a SourceClock::Now() call.
+	 */
+	Duration Cost;
+};
+
+/**
+ * A Clock reading a given ClockSource
+ *
+ * Each ClockSource has its own reserved MonoclockID, so Time::Sub()
+ * and comparisons keep using the monotonic values between Time read
+ * from the same source, and fall back to wall values across sources.
+ *
+ * ```c++
+ * using namespace fort;
+ * SourceClock coarse(ClockSource::COARSE);
+ * for (const auto & line : lines) {
+ *     Log(coarse.Now(), line);
+ * }
+ * ```
+ */
+class SourceClock : public Clock {
+public:
+	/**
+	 * Constructor
+	 *
+	 * @param source the ClockSource to read
+	 */
+	SourceClock(ClockSource source);
+
+	/**
+	 * Gets the current Time of the source
+	 *
+	 * @return the current Time, with a MonoclockID depending on the
+	 *         ClockSource.
+	 *
+	 * @throws std::system_error if the source is not available on
+	 *         this system.
+	 */
+	Time Now() override;
+
+	/**
+	 * Sleeps until a deadline of this source
+	 *
+	 * @param deadline the Time to wake up at. It must have the
+	 *        MonoclockID of this source.
+	 *
+	 * @throws std::invalid_argument if deadline has not the
+	 *         MonoclockID of this source.
+	 */
+	void SleepUntil(const Time &deadline) override;
+
+	/**
+	 * Gets the ClockSource
+	 *
+	 * @return the ClockSource read by this SourceClock.
+	 */
+	inline ClockSource Source() const {
+		return d_source;
+	}
+
+	/**
+	 * Gets the MonoclockID of a ClockSource
+	 *
+	 * @param source the ClockSource to query
+	 *
+	 * @return the MonoclockID used by Time of this source.
+	 */
+	static Time::MonoclockID MonoclockID(ClockSource source);
+
+private:
+	friend std::vector<ClockSourceInfo> ProbeClockSources(size_t iterations);
+
+	ClockSource       d_source;
+	clockid_t         d_wall, d_mono;
+	Time::MonoclockID d_monoID;
+};
+
+/**
+ * Probes the resolution and cost of all ClockSource
+ *
+ * Meant to be called once at startup, to choose the cheapest source
+ * with an acceptable resolution.
+ *
+ * @param iterations the number of SourceClock::Now() calls used to
+ *        measure the cost of each source.
+ *
+ * @return a ClockSourceInfo for each ClockSource.
+ */
+std::vector<ClockSourceInfo> ProbeClockSources(size_t iterations = 1000);
+
+} // namespace fort
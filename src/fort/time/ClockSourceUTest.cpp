@@ -0,0 +1,72 @@
+#include "ClockSource.hpp"
+
+#include <cstdlib>
+
+#include "ClockSourceUTest.hpp"
+
+namespace fort {
+
+TEST_F(ClockSourceUTest, UsesReservedMonoclockIDs) {
+	for (auto source :
+	     {ClockSource::SYSTEM,
+	      ClockSource::COARSE,
+	      ClockSource::BOOTTIME,
+	      ClockSource::TAI}) {
+		SourceClock clock(source);
+		Time        t;
+		try {
+			t = clock.Now();
+		} catch (const std::system_error &) {
+			// not every kernel supports all sources
+			continue;
+		}
+		EXPECT_TRUE(t.HasMono());
+		EXPECT_EQ(t.MonoID(), SourceClock::MonoclockID(source));
+		// within a source, the monotonic path is used
+		auto later = clock.Now();
+		EXPECT_FALSE(later.Before(t));
+		EXPECT_GE(later.Sub(t), 0);
+	}
+	EXPECT_EQ(
+	    SourceClock(ClockSource::SYSTEM).Now().MonoID(),
+	    Time::Now().MonoID()
+	);
+}
+
+TEST_F(ClockSourceUTest, SourcesAgreeOnWallTime) {
+	auto now    = Time::Now();
+	auto coarse = SourceClock(ClockSource::COARSE).Now();
+	auto boot   = SourceClock(ClockSource::BOOTTIME).Now();
+	// different MonoclockID: compared by wall time.
+	EXPECT_LT(std::abs(now.Sub(coarse).Nanoseconds()), 1000000000);
+	EXPECT_LT(std::abs(now.Sub(boot).Nanoseconds()), 1000000000);
+	// boottime counts at least as long as the monotonic clock
+	EXPECT_GE(boot.MonotonicValue(), now.MonotonicValue());
+}
+
+TEST_F(ClockSourceUTest, SleepsOnSourceDeadlines) {
+	SourceClock boot(ClockSource::BOOTTIME);
+	auto        deadline = boot.Now().Add(Duration::Millisecond);
+	boot.SleepUntil(deadline);
+	EXPECT_FALSE(boot.Now().Before(deadline));
+	EXPECT_THROW(boot.SleepUntil(Time::Now()), std::invalid_argument);
+}
+
+TEST_F(ClockSourceUTest, ProbesSources) {
+	auto infos = ProbeClockSources(100);
+	ASSERT_EQ(infos.size(), 4);
+	EXPECT_EQ(infos[0].Source, ClockSource::SYSTEM);
+	EXPECT_EQ(infos[0].Name, "system");
+	EXPECT_TRUE(infos[0].Available);
+	for (const auto &info : infos) {
+		if (info.Available == false) {
+			continue;
+		}
+		EXPECT_GT(info.Resolution, 0) << info.Name;
+		EXPECT_GT(info.Cost, 0) << info.Name;
+	}
+	// coarse clocks have at best the resolution of the fine ones
+	EXPECT_GE(infos[1].Resolution, infos[0].Resolution);
+}
+
+} // namespace fort
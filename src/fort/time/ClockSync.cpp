@@ -0,0 +1,186 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <stdexcept>
+
+#include "ClockSync.hpp"
+
+namespace fort {
+
+SyncTransport::~SyncTransport() {}
+
+LoopbackTransport::LoopbackTransport(
+    Time::MonoclockID remoteID,
+    const Duration   &offset,
+    const Duration   &forward,
+    const Duration   &backward,
+    const Duration   &processing
+)
+    : d_remoteID(remoteID)
+    , d_offset(offset)
+    , d_forward(forward)
+    , d_backward(backward)
+    , d_processing(processing) {}
+
+void LoopbackTransport::SetDelays(
+    const Duration &forward, const Duration &backward
+) {
+	d_forward  = forward;
+	d_backward = backward;
+}
+
+SyncSample LoopbackTransport::Exchange() {
+	SyncSample res;
+	res.Send          = Time::Now();
+	res.RemoteReceive = Time::FromTimestampAndMonotonic(
+	    res.Send.Add(d_offset + d_forward).ToTimestamp(),
+	    res.Send.MonotonicValue() + d_forward.Nanoseconds(),
+	    d_remoteID
+	);
+	res.RemoteReply = res.RemoteReceive.Add(d_processing);
+	res.Receive     = res.Send.Add(d_forward + d_processing + d_backward);
+	return res;
+}
+
+ClockOffsetEstimator::ClockOffsetEstimator(size_t window)
+    : d_window(std::max(window, size_t(1))) {}
+
+void ClockOffsetEstimator::AddSample(const SyncSample &s) {
+	if (s.RemoteReceive.HasMono() == false ||
+	    s.RemoteReply.HasMono() == false ||
+	    s.RemoteReceive.MonoID() != s.RemoteReply.MonoID()) {
+		throw std::invalid_argument(
+		    "remote Time of SyncSample must share a MonoclockID"
+		);
+	}
+	auto host = s.RemoteReceive.MonoID();
+	if ((s.Send.HasMono() && s.Send.MonoID() == host) ||
+	    (s.Receive.HasMono() && s.Receive.MonoID() == host)) {
+		throw std::invalid_argument(
+		    "local and remote Time of SyncSample share the MonoclockID " +
+		    std::to_string(host)
+		);
+	}
+
+	// Remote and local Time have different MonoclockID, so these
+	// differences use the wall clocks.
+	int64_t forward  = s.RemoteReceive.Sub(s.Send).Nanoseconds();
+	int64_t backward = s.RemoteReply.Sub(s.Receive).Nanoseconds();
+	int64_t local    = s.Receive.Sub(s.Send).Nanoseconds();
+	int64_t remote   = s.RemoteReply.Sub(s.RemoteReceive).Nanoseconds();
+
+	Estimate e;
+	e.Offset    = (forward + backward) / 2;
+	e.RoundTrip = std::max(local - remote, int64_t(0));
+
+	auto &h = d_hosts[host];
+	h.Samples.push_back(e);
+	while (h.Samples.size() > d_window) {
+		h.Samples.pop_front();
+	}
+	const Estimate *best = &h.Samples.front();
+	for (const auto &sample : h.Samples) {
+		if (sample.RoundTrip < best->RoundTrip) {
+			best = &sample;
+		}
+	}
+	h.Best.Offset    = best->Offset;
+	h.Best.RoundTrip = best->RoundTrip;
+	h.Best.Error     = (best->RoundTrip.Nanoseconds() + 1) / 2;
+	h.Best.Samples   = h.Samples.size();
+}
+
+ClockOffset
+ClockOffsetEstimator::Synchronize(SyncTransport &transport, size_t exchanges) {
+	if (exchanges == 0) {
+		throw std::invalid_argument("at least one exchange is needed");
+	}
+	Time::MonoclockID host = 0;
+	for (size_t i = 0; i < exchanges; ++i) {
+		auto sample = transport.Exchange();
+		AddSample(sample);
+		host = sample.RemoteReceive.MonoID();
+	}
+	return Offset(host);
+}
+
+ClockOffset ClockOffsetEstimator::Offset(Time::MonoclockID host) const {
+	auto fi = d_hosts.find(host);
+	if (fi == d_hosts.end()) {
+		throw std::out_of_range(
+		    "no synchronization sample for MonoclockID " + std::to_string(host)
+		);
+	}
+	return fi->second.Best;
+}
+
+const ClockOffsetEstimator::Host &
+ClockOffsetEstimator::FindHost(const Time &remote) const {
+	if (remote.HasMono() == false) {
+		throw std::out_of_range(
+		    "Time without MonoclockID has no host: " + remote.DebugString()
+		);
+	}
+	auto fi = d_hosts.find(remote.MonoID());
+	if (fi == d_hosts.end()) {
+		throw std::out_of_range(
+		    "no synchronization sample for " + remote.DebugString()
+		);
+	}
+	return fi->second;
+}
+
+Time ClockOffsetEstimator::ShiftWall(const Time &t, const Duration &offset) {
+	if (t.IsInfinite() == true) {
+		return t;
+	}
+	int64_t ns  = offset.Nanoseconds();
+	auto    raw = details::ToRawTime(t);
+	if (__builtin_sub_overflow(raw.WallSec, ns / 1000000000LL, &raw.WallSec)) {
+		throw Time::Overflow("Wall");
+	}
+	// keeps the monotonic value, one normalization step is enough and
+	// throws Time::Overflow if it cannot be done.
+	raw.WallNsec -= ns % 1000000000LL;
+	return details::FromRawTime(raw);
+}
+
+Time ClockOffsetEstimator::ToLocal(const Time &remote) const {
+	if (remote.IsInfinite() == true) {
+		return remote;
+	}
+	return ShiftWall(remote, FindHost(remote).Best.Offset);
+}
+
+void ClockOffsetEstimator::ToLocal(std::vector<Time> &times) const {
+	const Host       *host   = nullptr;
+	Time::MonoclockID hostID = 0;
+	for (auto &t : times) {
+		if (t.IsInfinite() == true) {
+			continue;
+		}
+		if (host == nullptr || t.HasMono() == false || t.MonoID() != hostID) {
+			host   = &FindHost(t);
+			hostID = t.MonoID();
+		}
+		t = ShiftWall(t, host->Best.Offset);
+	}
+}
+
+} // namespace fort
@@ -0,0 +1,247 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <deque>
+#include <map>
+#include <vector>
+
+#include "Time.hpp"
+
+namespace fort {
+
+/**
+ * A timestamp exchange with a remote host
+ *
+ * Send and Receive are read on the local clock, RemoteReceive and
+ * RemoteReply on the remote one. The remote Time must carry the
+ * MonoclockID identifying the remote host, as do the Time of its
+ * streams.
+ */
+struct SyncSample {
+	/**
+	 * Local Time the request was sent.
+	 */
+	Time Send;
+	/**
+	 * Remote Time the request was received.
+	 */
+	Time RemoteReceive;
+	/**
+	 * Remote Time the reply was sent.
+	 */
+	Time RemoteReply;
+	/**
+	 * Local Time the reply was received.
+	 */
+	Time Receive;
+};
+
+/**
+ * A way to exchange timestamps with a remote host
+ */
+class SyncTransport {
+public:
+	virtual ~SyncTransport();
+
+	/**
+	 * Performs a single timestamp exchange
+	 *
+	 * @return the SyncSample of the exchange.
+	 */
+	virtual SyncSample Exchange() = 0;
+};
+
+/**
+ * A SyncTransport simulating a remote host
+ *
+ * It does not send anything, but computes the SyncSample a remote
+ * host with a given wall clock offset and network delays would
+ * produce. Meant for tests.
+ */
+class LoopbackTransport : public SyncTransport {
+public:
+	/**
+	 * Constructor
+	 *
+	 * @param remoteID the MonoclockID of the simulated host
+	 * @param offset the offset of the remote wall clock to the local one
+	 * @param forward the delay from local to remote host
+	 * @param backward the delay from remote to local host
+	 * @param processing the time the remote host takes to reply
+	 */
+	LoopbackTransport(
+	    Time::MonoclockID remoteID,
+	    const Duration   &offset,
+	    const Duration   &forward    = 0,
+	    const Duration   &backward   = 0,
+	    const Duration   &processing = 0
+	);
+
+	/**
+	 * Simulates an exchange starting at Time::Now()
+	 *
+	 * @return the SyncSample of the exchange.
+	 */
+	SyncSample Exchange() override;
+
+	/**
+	 * Sets the network delays of the next exchanges
+	 *
+	 * @param forward the delay from local to remote host
+	 * @param backward the delay from remote to local host
+	 */
+	void SetDelays(const Duration &forward, const Duration &backward);
+
+private:
+	Time::MonoclockID d_remoteID;
+	Duration          d_offset, d_forward, d_backward, d_processing;
+};
+
+/**
+ * The estimated offset of a remote clock
+ */
+struct ClockOffset {
+	/**
+	 * The offset to subtract from the remote wall time to get the
+	 * local wall time.
+	 */
+	Duration Offset;
+	/**
+	 * The bound of the error on Offset, the true offset lies within
+	 * `[Offset - Error, Offset + Error]`.
+	 */
+	Duration Error;
+	/**
+	 * The round-trip delay of the sample used for the estimation.
+	 */
+	Duration RoundTrip;
+	/**
+	 * The number of samples the estimation is chosen from.
+	 */
+	size_t Samples;
+};
+
+/**
+ * Estimates the wall clock offsets of remote hosts
+ *
+ * Uses the NTP on-wire algorithm: from a SyncSample, the offset
+ * estimate is `((RemoteReceive - Send) + (RemoteReply - Receive)) / 2`
+ * and the round-trip delay is
+ * `(Receive - Send) - (RemoteReply - RemoteReceive)`. As the
+ * asymmetry of the network is unknown, the error on the offset is
+ * bounded by half the round-trip. For each host, the sample with the
+ * smallest round-trip among the last ones is kept, as in the NTP
+ * clock filter.
+ *
+ * Remote hosts are identified by the MonoclockID of their Time, so
+ * ToLocal() can be applied to merged remote streams.
+ *
+ * ```c++
+ * using namespace fort;
+ * ClockOffsetEstimator estimator;
+ * estimator.Synchronize(transport, 8);
+ * estimator.ToLocal(remoteTimes);
+ * ```
+ */
+class ClockOffsetEstimator {
+public:
+	/**
+	 * Constructor
+	 *
+	 * @param window the number of last samples kept per host.
+	 */
+	ClockOffsetEstimator(size_t window = 8);
+
+	/**
+	 * Adds a sample
+	 *
+	 * @param sample the SyncSample to add
+	 *
+	 * @throws std::invalid_argument if the remote Time of sample
+	 *         have no or different MonoclockID, or its local Time
+	 *         share the remote MonoclockID.
+	 */
+	void AddSample(const SyncSample &sample);
+
+	/**
+	 * Performs exchanges and adds their samples
+	 *
+	 * @param transport the SyncTransport to the remote host
+	 * @param exchanges the number of exchanges to perform
+	 *
+	 * @return the updated ClockOffset of the remote host.
+	 */
+	ClockOffset Synchronize(SyncTransport &transport, size_t exchanges = 8);
+
+	/**
+	 * Gets the estimated offset of a host
+	 *
+	 * @param host the MonoclockID of the remote host
+	 *
+	 * @return the ClockOffset of host
+	 *
+	 * @throws std::out_of_range if host has no sample.
+	 */
+	ClockOffset Offset(Time::MonoclockID host) const;
+
+	/**
+	 * Converts a remote Time to the local wall clock
+	 *
+	 * @param remote a Time of a remote host
+	 *
+	 * @return remote, with its wall time corrected by the host
+	 *         offset. Its monotonic value is unchanged. Infinite Time
+	 *         are returned unchanged.
+	 *
+	 * @throws std::out_of_range if the host of remote has no sample.
+	 * @throws Time::Overflow if the corrected wall time overflows.
+	 */
+	Time ToLocal(const Time &remote) const;
+
+	/**
+	 * Converts remote Time to the local wall clock in place
+	 *
+	 * @param times the Time to convert. They may come from several
+	 *        hosts. Infinite Time are left unchanged.
+	 *
+	 * @throws std::out_of_range if the host of a Time has no sample.
+	 * @throws Time::Overflow if a corrected wall time overflows.
+	 */
+	void ToLocal(std::vector<Time> &times) const;
+
+private:
+	struct Estimate {
+		Duration Offset, RoundTrip;
+	};
+
+	struct Host {
+		std::deque<Estimate> Samples;
+		ClockOffset          Best;
+	};
+
+	const Host &FindHost(const Time &remote) const;
+
+	static Time ShiftWall(const Time &t, const Duration &offset);
+
+	size_t                            d_window;
+	std::map<Time::MonoclockID, Host> d_hosts;
+};
+
+} // namespace fort
@@ -0,0 +1,128 @@
+#include "ClockSync.hpp"
+
+#include <limits>
+
+#include "ClockSyncUTest.hpp"
+
+namespace fort {
+
+TEST_F(ClockSyncUTest, EstimatesSymmetricOffset) {
+	LoopbackTransport transport(
+	    42,
+	    -3 * Duration::Second,
+	    Duration::Millisecond,
+	    Duration::Millisecond,
+	    100 * Duration::Microsecond
+	);
+	ClockOffsetEstimator estimator;
+	auto                 offset = estimator.Synchronize(transport, 4);
+	EXPECT_EQ(offset.Offset, -3 * Duration::Second);
+	EXPECT_EQ(offset.RoundTrip, 2 * Duration::Millisecond);
+	EXPECT_EQ(offset.Error, Duration::Millisecond);
+	EXPECT_EQ(offset.Samples, 4);
+	EXPECT_EQ(estimator.Offset(42).Offset, offset.Offset);
+	EXPECT_THROW(estimator.Offset(43), std::out_of_range);
+}
+
+TEST_F(ClockSyncUTest, KeepsTheShortestRoundTrip) {
+	auto                 trueOffset = 250 * Duration::Millisecond;
+	LoopbackTransport    transport(1, trueOffset);
+	ClockOffsetEstimator estimator(4);
+
+	// asymmetric delays bias the estimate, within the error bound.
+	transport.SetDelays(8 * Duration::Millisecond, 2 * Duration::Millisecond);
+	auto offset = estimator.Synchronize(transport, 1);
+	EXPECT_EQ(offset.Offset, trueOffset + 3 * Duration::Millisecond);
+	EXPECT_EQ(offset.Error, 5 * Duration::Millisecond);
+	EXPECT_LE(offset.Offset - offset.Error, trueOffset);
+	EXPECT_GE(offset.Offset + offset.Error, trueOffset);
+
+	transport.SetDelays(Duration::Millisecond, 500 * Duration::Microsecond);
+	offset = estimator.Synchronize(transport, 1);
+	EXPECT_EQ(offset.Offset, trueOffset + 250 * Duration::Microsecond);
+	EXPECT_EQ(offset.Error, 750 * Duration::Microsecond);
+
+	// a congested exchange does not degrade the estimate
+	transport.SetDelays(Duration::Second, 0);
+	offset = estimator.Synchronize(transport, 2);
+	EXPECT_EQ(offset.Error, 750 * Duration::Microsecond);
+	EXPECT_EQ(offset.Samples, 4);
+
+	// until it falls out of the window
+	offset = estimator.Synchronize(transport, 1);
+	EXPECT_EQ(offset.Error, 750 * Duration::Microsecond);
+	offset = estimator.Synchronize(transport, 1);
+	EXPECT_EQ(offset.Error, 500 * Duration::Millisecond);
+}
+
+TEST_F(ClockSyncUTest, ConvertsRemoteStreams) {
+	LoopbackTransport    a(1, 10 * Duration::Second), b(2, -Duration::Minute);
+	ClockOffsetEstimator estimator;
+	estimator.Synchronize(a);
+	estimator.Synchronize(b);
+
+	auto              now = Time::Now();
+	std::vector<Time> times;
+	for (int i = 0; i < 3; ++i) {
+		auto remoteA = now.Add(i * Duration::Millisecond + 10 * Duration::Second);
+		auto remoteB = now.Add(i * Duration::Millisecond - Duration::Minute);
+		times.push_back(Time::FromTimestampAndMonotonic(
+		    remoteA.ToTimestamp(),
+		    1000 + i,
+		    1
+		));
+		times.push_back(Time::FromTimestampAndMonotonic(
+		    remoteB.ToTimestamp(),
+		    2000 + i,
+		    2
+		));
+	}
+	auto first = estimator.ToLocal(times[0]);
+	estimator.ToLocal(times);
+	EXPECT_TRUE(first.Equals(times[0]));
+	for (int i = 0; i < 3; ++i) {
+		for (int j = 0; j < 2; ++j) {
+			const auto &t = times[2 * i + j];
+			EXPECT_EQ(t.MonoID(), j + 1);
+			EXPECT_EQ(t.MonotonicValue(), 1000 * (j + 1) + i);
+			// stripped from its monotonic value, compared by wall time
+			EXPECT_EQ(t.Round(Duration::Nanosecond).Sub(now), i * Duration::Millisecond);
+		}
+	}
+
+	EXPECT_THROW(estimator.ToLocal(Time::Now()), std::out_of_range);
+	EXPECT_THROW(estimator.ToLocal(Time::FromUnix(0, 0)), std::out_of_range);
+}
+
+TEST_F(ClockSyncUTest, ConvertsInfiniteAndExtremeTimes) {
+	LoopbackTransport    transport(1, 10 * Duration::Second);
+	ClockOffsetEstimator estimator;
+	estimator.Synchronize(transport);
+
+	std::vector<Time> times = {Time::SinceEver(), Time::Forever()};
+	estimator.ToLocal(times);
+	EXPECT_TRUE(times[0].IsSinceEver());
+	EXPECT_TRUE(times[1].IsForever());
+	EXPECT_TRUE(estimator.ToLocal(Time::Forever()).IsForever());
+
+	google::protobuf::Timestamp pb;
+	pb.set_seconds(std::numeric_limits<int64_t>::min() + 1);
+	EXPECT_THROW(
+	    estimator.ToLocal(Time::FromTimestampAndMonotonic(pb, 1000, 1)),
+	    Time::Overflow
+	);
+}
+
+TEST_F(ClockSyncUTest, RejectsInconsistentSamples) {
+	ClockOffsetEstimator estimator;
+	SyncSample           sample;
+	sample.Send          = Time::Now();
+	sample.RemoteReceive = sample.Send;
+	sample.RemoteReply   = sample.Send;
+	sample.Receive       = sample.Send;
+	EXPECT_THROW(estimator.AddSample(sample), std::invalid_argument);
+	sample.RemoteReply = Time::FromUnix(0, 0);
+	EXPECT_THROW(estimator.AddSample(sample), std::invalid_argument);
+}
+
+} // namespace fort
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+namespace fort {
+
+class ClockSyncUTest : public ::testing::Test {};
+
+} // namespace fort
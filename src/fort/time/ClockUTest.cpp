@@ -0,0 +1,124 @@
+#include "Clock.hpp"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "Ticker.hpp"
+#include "TimerWheel.hpp"
+
+#include "ClockUTest.hpp"
+
+namespace fort {
+
+TEST_F(ClockUTest, VirtualClockIsManual) {
+	VirtualClock clock(Time::FromUnix(1000, 0));
+	auto         start = clock.Now();
+	EXPECT_TRUE(start.HasMono());
+	EXPECT_EQ(
+	    start.MonoID(),
+	    Time::MonoclockID(Time::SYSTEM_MONOTONIC_CLOCK)
+	);
+	EXPECT_EQ(start.MonotonicValue(), 0);
+	EXPECT_TRUE(clock.Now().Equals(start));
+
+	clock.Advance(Duration::Hour);
+	EXPECT_EQ(clock.Now().Sub(start), Duration::Hour);
+	EXPECT_EQ(clock.Now().ToTimeT(), 1000 + 3600);
+	// time never goes backward
+	clock.Advance(-Duration::Minute);
+	clock.Set(start);
+	EXPECT_EQ(clock.Elapsed(), Duration::Hour);
+
+	clock.SleepUntil(start.Add(2 * Duration::Hour));
+	EXPECT_EQ(clock.Elapsed(), 2 * Duration::Hour);
+}
+
+TEST_F(ClockUTest, OverrideIsScoped) {
+	EXPECT_EQ(Clock::Installed(), nullptr);
+	EXPECT_EQ(&Clock::Current(), &SystemClock::Instance());
+	VirtualClock clock(Time::FromUnix(1000, 0));
+	{
+		Clock::Override override(clock);
+		EXPECT_EQ(&Clock::Current(), &clock);
+		EXPECT_TRUE(Time::Now().Equals(clock.Now()));
+		VirtualClock other;
+		{
+			Clock::Override nested(other);
+			EXPECT_TRUE(Time::Now().Equals(other.Now()));
+		}
+		EXPECT_TRUE(Time::Now().Equals(clock.Now()));
+		// the system clock stays reachable
+		EXPECT_GT(SystemClock::Instance().Now().ToTimeT(), 1000000000);
+	}
+	EXPECT_EQ(Clock::Installed(), nullptr);
+	EXPECT_GT(Time::Now().ToTimeT(), 1000000000);
+}
+
+TEST_F(ClockUTest, SimulatesTickersFasterThanRealTime) {
+	VirtualClock    clock;
+	Clock::Override override(clock);
+	auto            realStart = SystemClock::Instance().Now();
+
+	Ticker ticker(Duration::Hour);
+	for (uint64_t i = 0; i < 24; ++i) {
+		auto tick = ticker.Wait();
+		EXPECT_EQ(tick.Index, i);
+		EXPECT_EQ(tick.Missed, 0);
+		EXPECT_EQ(tick.Lateness, 0);
+	}
+	EXPECT_EQ(clock.Elapsed(), 23 * Duration::Hour);
+
+	SleepUntil(clock.Now().Add(Duration::Hour));
+	EXPECT_EQ(clock.Elapsed(), 24 * Duration::Hour);
+	EXPECT_LT(
+	    SystemClock::Instance().Now().Sub(realStart),
+	    Duration::Second
+	);
+}
+
+TEST_F(ClockUTest, DrivesTimerWheels) {
+	VirtualClock    clock;
+	Clock::Override override(clock);
+	TimerWheel      wheel(Duration::Second);
+	int             fired = 0;
+	wheel.ScheduleIn(Duration::Hour, [&]() { ++fired; });
+	wheel.ScheduleIn(2 * Duration::Hour, [&]() { ++fired; });
+	clock.Advance(90 * Duration::Minute);
+	EXPECT_EQ(wheel.Advance(Time::Now()), 1);
+	clock.Advance(Duration::Hour);
+	EXPECT_EQ(wheel.Advance(Time::Now()), 1);
+	EXPECT_EQ(fired, 2);
+}
+
+TEST_F(ClockUTest, SteadyClockIsAStandardClock) {
+	static_assert(std::is_same<
+	              SteadyClock::duration,
+	              SteadyClock::time_point::duration>::value);
+	static_assert(
+	    std::is_same<SteadyClock::rep, SteadyClock::duration::rep>::value
+	);
+	static_assert(std::is_same<
+	              SteadyClock::period,
+	              SteadyClock::duration::period>::value);
+	static_assert(SteadyClock::is_steady);
+	static_assert(noexcept(SteadyClock::now()));
+
+	auto start = Time::Now();
+	std::this_thread::sleep_until(
+	    SteadyClock::now() + (2 * Duration::Millisecond).ToChrono()
+	);
+	EXPECT_GE(Time::Now().Sub(start), 2 * Duration::Millisecond);
+
+	std::mutex                   mutex;
+	std::condition_variable      cv;
+	std::unique_lock<std::mutex> lock(mutex);
+	auto deadline = Time::Now().Add(Duration::Millisecond);
+	EXPECT_EQ(
+	    cv.wait_until(lock, deadline.ToSteadyTimePoint()),
+	    std::cv_status::timeout
+	);
+	EXPECT_FALSE(Time::Now().Before(deadline));
+}
+
+} // namespace fort
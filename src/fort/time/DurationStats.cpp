@@ -0,0 +1,457 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <type_traits>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define FORT_TIME_STATS_AVX2 1
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define FORT_TIME_STATS_NEON 1
+#include <arm_neon.h>
+#endif
+
+#include "DurationStats.hpp"
+
+namespace fort {
+
+static_assert(
+    sizeof(Duration) == sizeof(int64_t) &&
+        std::is_standard_layout<Duration>::value,
+    "Duration arrays are reduced as int64_t arrays"
+);
+
+namespace {
+
+typedef __int128 int128_t;
+
+// The SIMD kernels convert deviations to double exactly, which needs
+// them to be smaller than 2^51.
+const int64_t EXACT_DEVIATION_LIMIT = int64_t(1) << 51;
+
+// Each kernel block accumulates 32-bit halves in 64-bit lanes, which
+// cannot wrap within 2^32 values.
+const size_t SUM_BLOCK = size_t(1) << 31;
+
+// Inputs are split across threads in chunks of at least this size.
+const size_t MIN_CHUNK = size_t(1) << 16;
+
+struct Kernels {
+	int128_t (*Sum)(const int64_t *v, size_t n);
+	void (*MinMax)(const int64_t *v, size_t n, int64_t &min, int64_t &max);
+	size_t (*CountAbove)(const int64_t *v, size_t n, int64_t threshold);
+	// requires |v[i] - mean| < EXACT_DEVIATION_LIMIT.
+	double (*SquaredDeviations)(const int64_t *v, size_t n, int64_t mean);
+};
+
+int128_t SumScalar(const int64_t *v, size_t n) {
+	int128_t res = 0;
+	for (size_t i = 0; i < n; ++i) {
+		res += v[i];
+	}
+	return res;
+}
+
+void MinMaxScalar(const int64_t *v, size_t n, int64_t &min, int64_t &max) {
+	for (size_t i = 0; i < n; ++i) {
+		min = std::min(min, v[i]);
+		max = std::max(max, v[i]);
+	}
+}
+
+size_t CountAboveScalar(const int64_t *v, size_t n, int64_t threshold) {
+	size_t res = 0;
+	for (size_t i = 0; i < n; ++i) {
+		res += v[i] > threshold ? 1 : 0;
+	}
+	return res;
+}
+
+double SquaredDeviationsScalar(const int64_t *v, size_t n, int64_t mean) {
+	double res = 0.0;
+	for (size_t i = 0; i < n; ++i) {
+		double d = double(int128_t(v[i]) - mean);
+		res += d * d;
+	}
+	return res;
+}
+
+const Kernels SCALAR_KERNELS = {
+    &SumScalar,
+    &MinMaxScalar,
+    &CountAboveScalar,
+    &SquaredDeviationsScalar,
+};
+
+#ifdef FORT_TIME_STATS_AVX2
+
+#define FORT_AVX2 __attribute__((target("avx2")))
+
+FORT_AVX2 inline void Store(__m256i x, int64_t (&lanes)[4]) {
+	_mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), x);
+}
+
+FORT_AVX2 int128_t SumAVX2(const int64_t *v, size_t n) {
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i low  = _mm256_set1_epi64x(0xffffffffLL);
+	int128_t      res  = 0;
+	size_t        i    = 0;
+	while (n - i >= 4) {
+		size_t end = i + std::min((n - i) & ~size_t(3), SUM_BLOCK);
+		// AVX2 has no 64-bit arithmetic shift: sums the unsigned
+		// halves and counts the negative values instead.
+		__m256i lo = zero, hi = zero, neg = zero;
+		for (; i < end; i += 4) {
+			__m256i x =
+			    _mm256_loadu_si256(reinterpret_cast<const __m256i *>(v + i));
+			lo  = _mm256_add_epi64(lo, _mm256_and_si256(x, low));
+			hi  = _mm256_add_epi64(hi, _mm256_srli_epi64(x, 32));
+			neg = _mm256_add_epi64(neg, _mm256_cmpgt_epi64(zero, x));
+		}
+		int64_t los[4], his[4], negs[4];
+		Store(lo, los);
+		Store(hi, his);
+		Store(neg, negs);
+		for (size_t l = 0; l < 4; ++l) {
+			res += int128_t(uint64_t(los[l])) +
+			       int128_t(uint64_t(his[l])) * (int128_t(1) << 32) +
+			       int128_t(negs[l]) * (int128_t(1) << 64);
+		}
+	}
+	return res + SumScalar(v + i, n - i);
+}
+
+FORT_AVX2 void
+MinMaxAVX2(const int64_t *v, size_t n, int64_t &min, int64_t &max) {
+	size_t i = 0;
+	if (n >= 4) {
+		__m256i mn = _mm256_set1_epi64x(min), mx = _mm256_set1_epi64x(max);
+		for (; i + 4 <= n; i += 4) {
+			__m256i x =
+			    _mm256_loadu_si256(reinterpret_cast<const __m256i *>(v + i));
+			mn = _mm256_blendv_epi8(mn, x, _mm256_cmpgt_epi64(mn, x));
+			mx = _mm256_blendv_epi8(mx, x, _mm256_cmpgt_epi64(x, mx));
+		}
+		int64_t mns[4], mxs[4];
+		Store(mn, mns);
+		Store(mx, mxs);
+		MinMaxScalar(mns, 4, min, max);
+		MinMaxScalar(mxs, 4, min, max);
+	}
+	MinMaxScalar(v + i, n - i, min, max);
+}
+
+FORT_AVX2 size_t
+CountAboveAVX2(const int64_t *v, size_t n, int64_t threshold) {
+	const __m256i t     = _mm256_set1_epi64x(threshold);
+	__m256i       count = _mm256_setzero_si256();
+	size_t        i     = 0;
+	for (; i + 4 <= n; i += 4) {
+		__m256i x =
+		    _mm256_loadu_si256(reinterpret_cast<const __m256i *>(v + i));
+		count = _mm256_sub_epi64(count, _mm256_cmpgt_epi64(x, t));
+	}
+	int64_t counts[4];
+	Store(count, counts);
+	return counts[0] + counts[1] + counts[2] + counts[3] +
+	       CountAboveScalar(v + i, n - i, threshold);
+}
+
+FORT_AVX2 double
+SquaredDeviationsAVX2(const int64_t *v, size_t n, int64_t mean) {
+	// int64 to double conversion by the 2^52 + 2^51 magic number,
+	// exact for values within (-2^51,2^51).
+	const __m256i magicI = _mm256_set1_epi64x(0x4338000000000000LL);
+	const __m256d magicD = _mm256_set1_pd(6755399441055744.0);
+	const __m256i m      = _mm256_set1_epi64x(mean);
+	__m256d       acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+	size_t        i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256i x0 =
+		    _mm256_loadu_si256(reinterpret_cast<const __m256i *>(v + i));
+		__m256i x1 =
+		    _mm256_loadu_si256(reinterpret_cast<const __m256i *>(v + i + 4));
+		__m256d d0 = _mm256_sub_pd(
+		    _mm256_castsi256_pd(
+		        _mm256_add_epi64(_mm256_sub_epi64(x0, m), magicI)
+		    ),
+		    magicD
+		);
+		__m256d d1 = _mm256_sub_pd(
+		    _mm256_castsi256_pd(
+		        _mm256_add_epi64(_mm256_sub_epi64(x1, m), magicI)
+		    ),
+		    magicD
+		);
+		acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(d0, d0));
+		acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(d1, d1));
+	}
+	double lanes[4];
+	_mm256_storeu_pd(lanes, _mm256_add_pd(acc0, acc1));
+	return lanes[0] + lanes[1] + lanes[2] + lanes[3] +
+	       SquaredDeviationsScalar(v + i, n - i, mean);
+}
+
+#undef FORT_AVX2
+
+const Kernels AVX2_KERNELS = {
+    &SumAVX2,
+    &MinMaxAVX2,
+    &CountAboveAVX2,
+    &SquaredDeviationsAVX2,
+};
+
+#endif // FORT_TIME_STATS_AVX2
+
+#ifdef FORT_TIME_STATS_NEON
+
+int128_t SumNEON(const int64_t *v, size_t n) {
+	const uint64x2_t low = vdupq_n_u64(0xffffffffULL);
+	int128_t         res = 0;
+	size_t           i   = 0;
+	while (n - i >= 2) {
+		size_t     end = i + std::min((n - i) & ~size_t(1), SUM_BLOCK);
+		uint64x2_t lo  = vdupq_n_u64(0);
+		int64x2_t  hi  = vdupq_n_s64(0);
+		for (; i < end; i += 2) {
+			int64x2_t x = vld1q_s64(v + i);
+			lo = vaddq_u64(lo, vandq_u64(vreinterpretq_u64_s64(x), low));
+			hi = vaddq_s64(hi, vshrq_n_s64(x, 32));
+		}
+		res += int128_t(vgetq_lane_u64(lo, 0)) +
+		       int128_t(vgetq_lane_u64(lo, 1)) +
+		       (int128_t(vgetq_lane_s64(hi, 0)) + vgetq_lane_s64(hi, 1)) *
+		           (int128_t(1) << 32);
+	}
+	return res + SumScalar(v + i, n - i);
+}
+
+void MinMaxNEON(const int64_t *v, size_t n, int64_t &min, int64_t &max) {
+	size_t i = 0;
+	if (n >= 2) {
+		int64x2_t mn = vdupq_n_s64(min), mx = vdupq_n_s64(max);
+		for (; i + 2 <= n; i += 2) {
+			int64x2_t x = vld1q_s64(v + i);
+			mn          = vbslq_s64(vcgtq_s64(mn, x), x, mn);
+			mx          = vbslq_s64(vcgtq_s64(x, mx), x, mx);
+		}
+		int64_t lanes[4] = {
+		    vgetq_lane_s64(mn, 0),
+		    vgetq_lane_s64(mn, 1),
+		    vgetq_lane_s64(mx, 0),
+		    vgetq_lane_s64(mx, 1),
+		};
+		MinMaxScalar(lanes, 4, min, max);
+	}
+	MinMaxScalar(v + i, n - i, min, max);
+}
+
+size_t CountAboveNEON(const int64_t *v, size_t n, int64_t threshold) {
+	const int64x2_t t     = vdupq_n_s64(threshold);
+	int64x2_t       count = vdupq_n_s64(0);
+	size_t          i     = 0;
+	for (; i + 2 <= n; i += 2) {
+		uint64x2_t above = vcgtq_s64(vld1q_s64(v + i), t);
+		count            = vsubq_s64(count, vreinterpretq_s64_u64(above));
+	}
+	return vgetq_lane_s64(count, 0) + vgetq_lane_s64(count, 1) +
+	       CountAboveScalar(v + i, n - i, threshold);
+}
+
+double SquaredDeviationsNEON(const int64_t *v, size_t n, int64_t mean) {
+	const int64x2_t m    = vdupq_n_s64(mean);
+	float64x2_t     acc0 = vdupq_n_f64(0.0), acc1 = vdupq_n_f64(0.0);
+	size_t          i    = 0;
+	for (; i + 4 <= n; i += 4) {
+		float64x2_t d0 = vcvtq_f64_s64(vsubq_s64(vld1q_s64(v + i), m));
+		float64x2_t d1 = vcvtq_f64_s64(vsubq_s64(vld1q_s64(v + i + 2), m));
+		acc0           = vfmaq_f64(acc0, d0, d0);
+		acc1           = vfmaq_f64(acc1, d1, d1);
+	}
+	return vaddvq_f64(vaddq_f64(acc0, acc1)) +
+	       SquaredDeviationsScalar(v + i, n - i, mean);
+}
+
+const Kernels NEON_KERNELS = {
+    &SumNEON,
+    &MinMaxNEON,
+    &CountAboveNEON,
+    &SquaredDeviationsNEON,
+};
+
+#endif // FORT_TIME_STATS_NEON
+
+const Kernels &SelectKernels() {
+#if defined(FORT_TIME_STATS_AVX2)
+	if (__builtin_cpu_supports("avx2")) {
+		return AVX2_KERNELS;
+	}
+#elif defined(FORT_TIME_STATS_NEON)
+	return NEON_KERNELS;
+#endif
+	return SCALAR_KERNELS;
+}
+
+const Kernels &Best() {
+	static const Kernels &kernels = SelectKernels();
+	return kernels;
+}
+
+inline const int64_t *Values(const DurationSpan &span) {
+	return reinterpret_cast<const int64_t *>(span.Data());
+}
+
+// Applies fn to contiguous chunks of [0,n), spread over at most threads
+// threads, the calling thread processing the first chunk.
+template <typename Result, typename Function>
+std::vector<Result> Chunked(size_t n, size_t threads, Function fn) {
+	size_t chunks = std::max(std::min(threads, n / MIN_CHUNK), size_t(1));
+	std::vector<Result>      results(chunks);
+	std::vector<std::thread> workers;
+	workers.reserve(chunks - 1);
+	size_t chunkSize = (n + chunks - 1) / chunks;
+	for (size_t c = 1; c < chunks; ++c) {
+		size_t begin = c * chunkSize;
+		size_t size  = std::min(chunkSize, n - begin);
+		workers.emplace_back([&results, &fn, c, begin, size]() {
+			results[c] = fn(begin, size);
+		});
+	}
+	results[0] = fn(0, std::min(chunkSize, n));
+	for (auto &w : workers) {
+		w.join();
+	}
+	return results;
+}
+
+int128_t Sum(const int64_t *v, size_t n, size_t threads) {
+	int128_t res = 0;
+	for (auto s : Chunked<int128_t>(n, threads, [v](size_t begin, size_t size) {
+		     return Best().Sum(v + begin, size);
+	     })) {
+		res += s;
+	}
+	return res;
+}
+
+std::pair<int64_t, int64_t>
+MinMax(const int64_t *v, size_t n, size_t threads) {
+	if (n == 0) {
+		return {0, 0};
+	}
+	std::pair<int64_t, int64_t> res = {v[0], v[0]};
+	for (const auto &mm : Chunked<std::pair<int64_t, int64_t>>(
+	         n,
+	         threads,
+	         [v](size_t begin, size_t size) {
+		         std::pair<int64_t, int64_t> res = {v[begin], v[begin]};
+		         Best().MinMax(v + begin, size, res.first, res.second);
+		         return res;
+	         }
+	     )) {
+		res.first  = std::min(res.first, mm.first);
+		res.second = std::max(res.second, mm.second);
+	}
+	return res;
+}
+
+Duration CheckedDuration(int128_t ns) {
+	if (ns > std::numeric_limits<int64_t>::max() ||
+	    ns < std::numeric_limits<int64_t>::min()) {
+		throw Time::Overflow("Duration");
+	}
+	return int64_t(ns);
+}
+
+} // namespace
+
+Duration DurationStats::StandardDeviation() const {
+	return int64_t(std::round(std::sqrt(Variance)));
+}
+
+Duration SumDurations(DurationSpan durations, size_t threads) {
+	return CheckedDuration(Sum(Values(durations), durations.Size(), threads));
+}
+
+std::pair<Duration, Duration>
+MinMaxDurations(DurationSpan durations, size_t threads) {
+	auto res = MinMax(Values(durations), durations.Size(), threads);
+	return {res.first, res.second};
+}
+
+size_t CountDurationsAbove(
+    DurationSpan durations, const Duration &threshold, size_t threads
+) {
+	const int64_t *v  = Values(durations);
+	int64_t        th = threshold.Nanoseconds();
+	size_t         res = 0;
+	for (auto c : Chunked<size_t>(
+	         durations.Size(),
+	         threads,
+	         [v, th](size_t begin, size_t size) {
+		         return Best().CountAbove(v + begin, size, th);
+	         }
+	     )) {
+		res += c;
+	}
+	return res;
+}
+
+DurationStats ComputeDurationStats(DurationSpan durations, size_t threads) {
+	DurationStats res;
+	res.Count = durations.Size();
+	if (res.Count == 0) {
+		return res;
+	}
+	const int64_t *v   = Values(durations);
+	int128_t       sum = Sum(v, res.Count, threads);
+	auto           mm  = MinMax(v, res.Count, threads);
+	res.Sum            = CheckedDuration(sum);
+	res.Min            = mm.first;
+	res.Max            = mm.second;
+	int64_t mean       = int64_t(sum / int128_t(res.Count));
+	res.Mean           = mean;
+
+	// the deviations to the truncated mean do not sum to zero, the
+	// remainder of the division corrects it exactly.
+	const Kernels &kernels =
+	    int128_t(mm.second) - mm.first < EXACT_DEVIATION_LIMIT
+	        ? Best()
+	        : SCALAR_KERNELS;
+	double squares = 0.0;
+	for (auto s : Chunked<double>(
+	         res.Count,
+	         threads,
+	         [v, mean, &kernels](size_t begin, size_t size) {
+		         return kernels.SquaredDeviations(v + begin, size, mean);
+	         }
+	     )) {
+		squares += s;
+	}
+	double n         = double(res.Count);
+	double remainder = double(sum - int128_t(mean) * int128_t(res.Count));
+	res.Variance     =
+	    std::max(squares / n - (remainder / n) * (remainder / n), 0.0);
+	return res;
+}
+
+} // namespace fort
@@ -0,0 +1,182 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "Time.hpp"
+
+namespace fort {
+
+/**
+ * A read-only view over contiguous Duration
+ *
+ * The input of the Duration reductions. It is implicitly built from a
+ * `std::vector<Duration>`, and does not own its data.
+ */
+class DurationSpan {
+public:
+	/**
+	 * Constructor
+	 *
+	 * @param data the first Duration
+	 * @param size the number of Duration
+	 */
+	inline DurationSpan(const Duration *data, size_t size)
+	    : d_data(data)
+	    , d_size(size) {}
+
+	/**
+	 * Constructor from a vector
+	 *
+	 * @param durations the Duration to view
+	 */
+	inline DurationSpan(const std::vector<Duration> &durations)
+	    : d_data(durations.data())
+	    , d_size(durations.size()) {}
+
+	/**
+	 * Gets the viewed data
+	 *
+	 * @return a pointer to the first Duration
+	 */
+	inline const Duration *Data() const {
+		return d_data;
+	}
+
+	/**
+	 * Gets the number of viewed Duration
+	 *
+	 * @return the size of the span
+	 */
+	inline size_t Size() const {
+		return d_size;
+	}
+
+private:
+	const Duration *d_data;
+	size_t          d_size;
+};
+
+/**
+ * Summary statistics of a set of Duration
+ */
+struct DurationStats {
+	/**
+	 * The number of Duration.
+	 */
+	size_t Count = 0;
+	/**
+	 * The exact sum of the Duration.
+	 */
+	Duration Sum;
+	/**
+	 * The smallest Duration, or zero if empty.
+	 */
+	Duration Min;
+	/**
+	 * The largest Duration, or zero if empty.
+	 */
+	Duration Max;
+	/**
+	 * The mean Duration, rounded toward zero, or zero if empty.
+	 */
+	Duration Mean;
+	/**
+	 * The population variance, in square nanoseconds.
+	 */
+	double Variance = 0.0;
+
+	/**
+	 * Gets the standard deviation
+	 *
+	 * @return the square root of Variance, rounded to the nanosecond.
+	 */
+	Duration StandardDeviation() const;
+};
+
+/**
+ * Sums Duration
+ *
+ * The sum is computed exactly: intermediate results may exceed the
+ * Duration range as long as the final sum does not.
+ *
+ * Like all Duration reductions, it uses AVX2 on x86_64 processors
+ * supporting it and NEON on aarch64, with a scalar fallback
+ * otherwise. Large inputs can be split across threads.
+ *
+ * ```c++
+ * using namespace fort;
+ * std::vector<Duration> latencies = Load();
+ * auto stats = ComputeDurationStats(latencies, 4);
+ * auto late = CountDurationsAbove(latencies, 10 * Duration::Millisecond);
+ * ```
+ *
+ * @param durations the Duration to sum
+ * @param threads the maximal number of threads to use. Small inputs
+ *        always use the calling thread only.
+ *
+ * @return the sum of durations, zero if empty.
+ *
+ * @throws Time::Overflow if the sum is out of the Duration range.
+ */
+Duration SumDurations(DurationSpan durations, size_t threads = 1);
+
+/**
+ * Finds the smallest and largest Duration
+ *
+ * @param durations the Duration to search
+ * @param threads the maximal number of threads to use.
+ *
+ * @return the smallest and largest Duration, both zero if empty.
+ */
+std::pair<Duration, Duration>
+MinMaxDurations(DurationSpan durations, size_t threads = 1);
+
+/**
+ * Counts the Duration above a threshold
+ *
+ * @param durations the Duration to count
+ * @param threshold the Duration to compare with
+ * @param threads the maximal number of threads to use.
+ *
+ * @return the number of Duration strictly greater than threshold.
+ */
+size_t CountDurationsAbove(
+    DurationSpan durations, const Duration &threshold, size_t threads = 1
+);
+
+/**
+ * Computes the summary statistics of Duration
+ *
+ * The variance is computed in a second pass, from the deviations to
+ * the exact mean.
+ *
+ * @param durations the Duration to summarize
+ * @param threads the maximal number of threads to use.
+ *
+ * @return the DurationStats of durations
+ *
+ * @throws Time::Overflow if their sum is out of the Duration range.
+ */
+DurationStats ComputeDurationStats(DurationSpan durations, size_t threads = 1);
+
+} // namespace fort
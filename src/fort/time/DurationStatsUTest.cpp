@@ -0,0 +1,105 @@
+#include "DurationStats.hpp"
+
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include "DurationStatsUTest.hpp"
+
+namespace fort {
+
+static std::vector<Duration> RandomDurations(size_t n, uint32_t seed) {
+	std::mt19937_64                        rng(seed);
+	std::uniform_int_distribution<int64_t> dist(
+	    -Duration::Second.Nanoseconds(),
+	    Duration::Hour.Nanoseconds()
+	);
+	std::vector<Duration> res;
+	for (size_t i = 0; i < n; ++i) {
+		res.push_back(dist(rng));
+	}
+	return res;
+}
+
+TEST_F(DurationStatsUTest, MatchesNaiveComputation) {
+	// sizes exercise the vector tails and the thread chunking
+	for (size_t n : {1, 2, 3, 7, 8, 9, 37, 1000, 300000}) {
+		auto values = RandomDurations(n, n);
+
+		Duration sum = 0, min = values[0], max = values[0];
+		size_t   above = 0;
+		for (const auto &d : values) {
+			sum = sum + d;
+			min = std::min(min, d);
+			max = std::max(max, d);
+			above += d > 30 * Duration::Minute ? 1 : 0;
+		}
+		Duration mean     = sum.Nanoseconds() / int64_t(n);
+		double   variance = 0.0;
+		for (const auto &d : values) {
+			double dev = double(d.Nanoseconds()) - double(sum.Nanoseconds()) / n;
+			variance += dev * dev / n;
+		}
+
+		for (size_t threads : {1, 4}) {
+			SCOPED_TRACE(std::to_string(n) + " values on " +
+			             std::to_string(threads) + " threads");
+			EXPECT_EQ(SumDurations(values, threads), sum);
+			auto mm = MinMaxDurations(values, threads);
+			EXPECT_EQ(mm.first, min);
+			EXPECT_EQ(mm.second, max);
+			EXPECT_EQ(
+			    CountDurationsAbove(values, 30 * Duration::Minute, threads),
+			    above
+			);
+			auto stats = ComputeDurationStats(values, threads);
+			EXPECT_EQ(stats.Count, n);
+			EXPECT_EQ(stats.Sum, sum);
+			EXPECT_EQ(stats.Min, min);
+			EXPECT_EQ(stats.Max, max);
+			EXPECT_EQ(stats.Mean, mean);
+			EXPECT_NEAR(stats.Variance, variance, variance * 1e-9);
+		}
+	}
+}
+
+TEST_F(DurationStatsUTest, SumsExactly) {
+	const int64_t         max    = std::numeric_limits<int64_t>::max();
+	std::vector<Duration> values = {max, max, 1, -max, -max, -1, 42};
+	values.insert(values.end(), values.begin(), values.end());
+	EXPECT_EQ(SumDurations(values), 84);
+
+	values.push_back(max);
+	EXPECT_THROW(SumDurations(values), Time::Overflow);
+	EXPECT_THROW(ComputeDurationStats(values), Time::Overflow);
+}
+
+TEST_F(DurationStatsUTest, HandlesWideRanges) {
+	const int64_t         max    = std::numeric_limits<int64_t>::max() / 2;
+	std::vector<Duration> values = {max, -max, max, -max, max, -max, max, -max};
+	auto                  stats  = ComputeDurationStats(values);
+	EXPECT_EQ(stats.Mean, 0);
+	EXPECT_DOUBLE_EQ(stats.Variance, double(max) * double(max));
+	EXPECT_EQ(stats.StandardDeviation(), Duration(int64_t(std::round(double(max)))));
+}
+
+TEST_F(DurationStatsUTest, HandlesEmptyInputs) {
+	std::vector<Duration> none;
+	EXPECT_EQ(SumDurations(none), 0);
+	EXPECT_EQ(MinMaxDurations(none).first, 0);
+	EXPECT_EQ(MinMaxDurations(none).second, 0);
+	EXPECT_EQ(CountDurationsAbove(none, 0), 0);
+	auto stats = ComputeDurationStats(none, 8);
+	EXPECT_EQ(stats.Count, 0);
+	EXPECT_EQ(stats.Mean, 0);
+	EXPECT_EQ(stats.Variance, 0.0);
+
+	std::vector<Duration> constant(17, Duration::Second);
+	stats = ComputeDurationStats(DurationSpan(constant.data(), 16));
+	EXPECT_EQ(stats.Count, 16);
+	EXPECT_EQ(stats.Sum, 16 * Duration::Second);
+	EXPECT_EQ(stats.Variance, 0.0);
+	EXPECT_EQ(stats.StandardDeviation(), 0);
+}
+
+} // namespace fort
@@ -0,0 +1,153 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#include <stdexcept>
+
+#include "FrameIndex.hpp"
+
+namespace fort {
+
+typedef unsigned __int128 uint128_t;
+typedef __int128          int128_t;
+
+const int64_t FrameIndexer::BEFORE_ALL;
+const int64_t FrameIndexer::AFTER_ALL;
+
+FrameIndexer::FrameIndexer(const Time &start, const Duration &period)
+    : d_start(start)
+    , d_period(period.Nanoseconds())
+    , d_divider({0, 0, 0}) {
+	if (start.IsInfinite() || period <= 0) {
+		throw std::invalid_argument(
+		    "FrameIndexer start must be finite and period positive"
+		);
+	}
+	// with l = ceil(log2(period)), n / period is
+	// (t + ((n - t) >> min(l,1))) >> max(l-1,0) where
+	// t = mulhi(n, magic), for any 64-bit n (Granlund & Montgomery,
+	// 1994).
+	int       l = d_period == 1 ? 0 : 64 - __builtin_clzll(d_period - 1);
+	uint128_t m = (uint128_t(1) << 64) * ((uint128_t(1) << l) - d_period);
+	d_divider.Magic  = uint64_t(m / d_period + 1);
+	d_divider.Shift1 = l > 0 ? 1 : 0;
+	d_divider.Shift2 = l > 0 ? l - 1 : 0;
+}
+
+static inline int64_t
+FloorDivide(int64_t offset, const FrameIndexer::Divider &d) {
+	auto divide = [&d](uint64_t n) {
+		uint64_t t = uint64_t((uint128_t(n) * d.Magic) >> 64);
+		return (t + ((n - t) >> d.Shift1)) >> d.Shift2;
+	};
+	if (offset >= 0) {
+		return divide(offset);
+	}
+	// floor(offset / period) = -((-offset - 1) / period) - 1, without
+	// overflow for INT64_MIN.
+	return -int64_t(divide(uint64_t(-(offset + 1)))) - 1;
+}
+
+int64_t FrameIndexer::IndexFromWall(const Time &t) const {
+	if (t.IsForever()) {
+		return AFTER_ALL;
+	}
+	if (t.IsSinceEver()) {
+		return BEFORE_ALL;
+	}
+	auto     raw    = details::ToRawTime(t);
+	auto     start  = details::ToRawTime(d_start);
+	int128_t offset = (int128_t(raw.WallSec) - start.WallSec) * 1000000000 +
+	                  (raw.WallNsec - start.WallNsec);
+	if (offset >= std::numeric_limits<int64_t>::min() &&
+	    offset <= std::numeric_limits<int64_t>::max()) {
+		return FloorDivide(int64_t(offset), d_divider);
+	}
+	// the offset overflows a Duration, the index may not.
+	int128_t index = offset / int128_t(d_period);
+	if (index * int128_t(d_period) > offset) {
+		--index;
+	}
+	if (index >= AFTER_ALL) {
+		return AFTER_ALL;
+	}
+	if (index <= BEFORE_ALL) {
+		return BEFORE_ALL;
+	}
+	return int64_t(index);
+}
+
+int64_t FrameIndexer::ToIndex(const Time &t) const {
+	auto raw   = details::ToRawTime(t);
+	auto start = details::ToRawTime(d_start);
+	if (start.MonoID != 0 && raw.MonoID == start.MonoID) {
+		return FloorDivide(int64_t(raw.Mono - start.Mono), d_divider);
+	}
+	return IndexFromWall(t);
+}
+
+size_t
+FrameIndexer::ToIndices(const Time *times, size_t n, int64_t *indices) const {
+	// local copies, as indices may alias the members.
+	size_t         saturated = 0;
+	const uint32_t monoID    = details::ToRawTime(d_start).MonoID;
+	const uint64_t mono      = details::ToRawTime(d_start).Mono;
+	const Divider  divider   = d_divider;
+	for (size_t i = 0; i < n; ++i) {
+		auto raw = details::ToRawTime(times[i]);
+		if (monoID != 0 && raw.MonoID == monoID) {
+			indices[i] = FloorDivide(int64_t(raw.Mono - mono), divider);
+			continue;
+		}
+		indices[i] = IndexFromWall(times[i]);
+		saturated += indices[i] == AFTER_ALL || indices[i] == BEFORE_ALL;
+	}
+	return saturated;
+}
+
+size_t FrameIndexer::ToIndices(
+    const std::vector<Time> &times, std::vector<int64_t> &indices
+) const {
+	indices.resize(times.size());
+	return ToIndices(times.data(), times.size(), indices.data());
+}
+
+Time FrameIndexer::FromIndex(int64_t index) const {
+	if (index == AFTER_ALL) {
+		return Time::Forever();
+	}
+	if (index == BEFORE_ALL) {
+		return Time::SinceEver();
+	}
+	int128_t offset = int128_t(index) * d_period;
+	if (offset > std::numeric_limits<int64_t>::max() ||
+	    offset < std::numeric_limits<int64_t>::min()) {
+		throw Time::Overflow("Wall");
+	}
+	return d_start.Add(int64_t(offset));
+}
+
+void FrameIndexer::FromIndices(
+    const std::vector<int64_t> &indices, std::vector<Time> &times
+) const {
+	times.resize(indices.size());
+	for (size_t i = 0; i < indices.size(); ++i) {
+		times[i] = FromIndex(indices[i]);
+	}
+}
+
+} // namespace fort
@@ -0,0 +1,159 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "Time.hpp"
+
+namespace fort {
+
+/**
+ * Maps Time to frame indices of a regular frame stream
+ *
+ * The frame index of a Time `t` is `floor(t.Sub(start) / period)`:
+ * as for Time::Sub(), the monotonic values are used if `t` shares
+ * the MonoclockID of start, and the wall values otherwise.
+ *
+ * The division by the period is replaced by a multiplication with a
+ * precomputed inverse, and Time sharing the clock of start are
+ * converted without any call to Time methods. Conversions never throw:
+ * Time::Forever(), Time::SinceEver() and Time whose index is not
+ * representable map to #AFTER_ALL or #BEFORE_ALL.
+ *
+ * ```c++
+ * using namespace fort;
+ * FrameIndexer indexer(firstFrame, Duration::Second.Nanoseconds() / 30);
+ * std::vector<int64_t> frames;
+ * indexer.ToIndices(events, frames);
+ * ```
+ */
+class FrameIndexer {
+public:
+	/**
+	 * The index of Time::SinceEver(), and of Time too far before start.
+	 */
+	const static int64_t BEFORE_ALL = std::numeric_limits<int64_t>::min();
+	/**
+	 * The index of Time::Forever(), and of Time too far after start.
+	 */
+	const static int64_t AFTER_ALL = std::numeric_limits<int64_t>::max();
+
+	/**
+	 * Constructor
+	 *
+	 * @param start the Time of frame 0
+	 * @param period the Duration of a frame
+	 *
+	 * @throws std::invalid_argument if start is infinite or period is
+	 *         not strictly positive.
+	 */
+	FrameIndexer(const Time &start, const Duration &period);
+
+	/**
+	 * Gets the Time of frame 0
+	 *
+	 * @return the start Time
+	 */
+	inline const Time &Start() const {
+		return d_start;
+	}
+
+	/**
+	 * Gets the frame period
+	 *
+	 * @return the Duration of a frame
+	 */
+	inline Duration Period() const {
+		return int64_t(d_period);
+	}
+
+	/**
+	 * Gets the frame of a Time
+	 *
+	 * @param t the Time to convert
+	 *
+	 * @return the index of the frame containing t, possibly negative,
+	 *         or #BEFORE_ALL / #AFTER_ALL if it is not representable.
+	 */
+	int64_t ToIndex(const Time &t) const;
+
+	/**
+	 * Gets the frames of Time
+	 *
+	 * @param times the Time to convert
+	 * @param n the number of Time
+	 * @param indices the n resulting frame indices
+	 *
+	 * @return the number of indices set to #BEFORE_ALL or #AFTER_ALL.
+	 */
+	size_t ToIndices(const Time *times, size_t n, int64_t *indices) const;
+
+	/**
+	 * Gets the frames of Time
+	 *
+	 * @param times the Time to convert
+	 * @param indices resized to the frame indices of times
+	 *
+	 * @return the number of indices set to #BEFORE_ALL or #AFTER_ALL.
+	 */
+	size_t
+	ToIndices(const std::vector<Time> &times, std::vector<int64_t> &indices) const;
+
+	/**
+	 * Gets the Time of a frame
+	 *
+	 * @param index the index of the frame
+	 *
+	 * @return the start Time of the frame, with a monotonic value if
+	 *         start has one. #BEFORE_ALL and #AFTER_ALL map to
+	 *         Time::SinceEver() and Time::Forever().
+	 *
+	 * @throws Time::Overflow if the Time is not representable.
+	 */
+	Time FromIndex(int64_t index) const;
+
+	/**
+	 * Gets the Time of frames
+	 *
+	 * @param indices the indices of the frames
+	 * @param times resized to the start Time of the frames
+	 *
+	 * @throws Time::Overflow if a Time is not representable.
+	 */
+	void
+	FromIndices(const std::vector<int64_t> &indices, std::vector<Time> &times) const;
+
+	// Granlund-Montgomery inverse of the period.
+	struct Divider {
+		uint64_t Magic;
+		int      Shift1, Shift2;
+	};
+
+private:
+	int64_t IndexFromWall(const Time &t) const;
+
+	Time     d_start;
+	uint64_t d_period;
+	Divider  d_divider;
+};
+
+} // namespace fort
@@ -0,0 +1,131 @@
+#include "FrameIndex.hpp"
+
+#include <random>
+
+#include "FrameIndexUTest.hpp"
+
+namespace fort {
+
+static int64_t FloorDivide(int64_t a, int64_t b) {
+	int64_t q = a / b;
+	return (a % b != 0 && a < 0) ? q - 1 : q;
+}
+
+TEST_F(FrameIndexUTest, MatchesDivision) {
+	std::mt19937_64 rng(42);
+	auto            start = Time::FromTimestampAndMonotonic(
+        Time::FromUnix(1700000000, 0).ToTimestamp(),
+        uint64_t(1) << 62,
+        7
+    );
+	for (int64_t period :
+	     {int64_t(1),
+	      int64_t(2),
+	      int64_t(3),
+	      int64_t(1) << 20,
+	      int64_t(33333333),
+	      int64_t(1000000007),
+	      int64_t(7) << 58,
+	      std::numeric_limits<int64_t>::max()}) {
+		FrameIndexer indexer(start, period);
+		EXPECT_EQ(indexer.Period(), period);
+		std::vector<int64_t> offsets = {
+		    0,
+		    1,
+		    -1,
+		    period - 1,
+		    period,
+		    -period,
+		    -period - 1,
+		    std::numeric_limits<int64_t>::max(),
+		    std::numeric_limits<int64_t>::min(),
+		};
+		for (int i = 0; i < 1000; ++i) {
+			offsets.push_back(int64_t(rng()));
+			offsets.push_back(int64_t(rng() % 1000) * period + int64_t(rng() % 3) - 1);
+		}
+		std::vector<Time> times;
+		for (auto o : offsets) {
+			times.push_back(Time::FromTimestampAndMonotonic(
+			    Time::FromUnix(0, 0).ToTimestamp(),
+			    start.MonotonicValue() + uint64_t(o),
+			    7
+			));
+		}
+		std::vector<int64_t> indices;
+		EXPECT_EQ(indexer.ToIndices(times, indices), 0);
+		for (size_t i = 0; i < offsets.size(); ++i) {
+			ASSERT_EQ(indices[i], FloorDivide(offsets[i], period))
+			    << "offset: " << offsets[i] << " period: " << period;
+			EXPECT_EQ(indexer.ToIndex(times[i]), indices[i]);
+		}
+	}
+}
+
+TEST_F(FrameIndexUTest, UsesWallTimeAcrossClocks) {
+	auto         start = Time::Now();
+	FrameIndexer indexer(start, 10 * Duration::Millisecond);
+	auto         wall  = start.Round(Duration::Nanosecond);
+	EXPECT_EQ(indexer.ToIndex(wall.Add(25 * Duration::Millisecond)), 2);
+	EXPECT_EQ(indexer.ToIndex(wall.Add(-1)), -1);
+	EXPECT_EQ(indexer.ToIndex(start.Add(-Duration::Hour)), -360000);
+
+	// far Time overflow a Duration, but not their index
+	FrameIndexer daily(Time::FromUnix(0, 0), 24 * Duration::Hour);
+	EXPECT_EQ(daily.ToIndex(Time::FromUnix(-1000 * 365LL * 86400, 0)), -365000);
+	EXPECT_EQ(daily.ToIndex(Time::FromUnix(1000 * 365LL * 86400 + 1, 0)), 365000);
+
+	FrameIndexer fine(Time::FromUnix(0, 0), 1);
+	std::vector<Time> times = {
+	    Time::Forever(),
+	    Time::SinceEver(),
+	    Time::FromUnix(1000 * 365LL * 86400, 0),
+	    Time::FromUnix(-1000 * 365LL * 86400, 0),
+	    Time::FromUnix(0, 42),
+	};
+	std::vector<int64_t> indices;
+	EXPECT_EQ(fine.ToIndices(times, indices), 4);
+	EXPECT_EQ(
+	    indices,
+	    std::vector<int64_t>({
+	        FrameIndexer::AFTER_ALL,
+	        FrameIndexer::BEFORE_ALL,
+	        FrameIndexer::AFTER_ALL,
+	        FrameIndexer::BEFORE_ALL,
+	        42,
+	    })
+	);
+}
+
+TEST_F(FrameIndexUTest, ConvertsBackToTime) {
+	auto         start = Time::Now();
+	FrameIndexer indexer(start, 33333333);
+	std::vector<int64_t> indices = {
+	    -3,
+	    0,
+	    108000,
+	    FrameIndexer::AFTER_ALL,
+	    FrameIndexer::BEFORE_ALL,
+	};
+	std::vector<Time> times;
+	indexer.FromIndices(indices, times);
+	ASSERT_EQ(times.size(), indices.size());
+	EXPECT_TRUE(times[0].Equals(start.Add(-99999999)));
+	EXPECT_TRUE(times[1].Equals(start));
+	EXPECT_EQ(times[2].Sub(start), 3599999964000);
+	EXPECT_TRUE(times[3].IsForever());
+	EXPECT_TRUE(times[4].IsSinceEver());
+
+	std::vector<int64_t> back;
+	EXPECT_EQ(indexer.ToIndices(times, back), 2);
+	EXPECT_EQ(back, indices);
+
+	EXPECT_THROW(indexer.FromIndex(int64_t(1) << 40), Time::Overflow);
+}
+
+TEST_F(FrameIndexUTest, RejectsInvalidConfiguration) {
+	EXPECT_THROW(FrameIndexer(Time::Now(), 0), std::invalid_argument);
+	EXPECT_THROW(FrameIndexer(Time::Forever(), 1), std::invalid_argument);
+}
+
+} // namespace fort
@@ -0,0 +1,175 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <stdexcept>
+
+#include "GapDetector.hpp"
+
+namespace fort {
+
+// Number of frames whose differences are checked at once.
+const static size_t SCAN_BLOCK = 256;
+
+GapDetector::GapDetector(const Duration &period, const Duration &tolerance)
+    : d_period(period.Nanoseconds())
+    , d_maxInterval(period.Nanoseconds() + tolerance.Nanoseconds())
+    , d_last(0) {
+	if (period <= 0 || tolerance < 0) {
+		throw std::invalid_argument(
+		    "GapDetector period must be positive and tolerance not negative"
+		);
+	}
+}
+
+GapDetector::Stream &GapDetector::FindStream(const Time &frame) {
+	if (frame.HasMono() == false) {
+		throw std::invalid_argument(
+		    "frame has no monotonic value: " + frame.DebugString()
+		);
+	}
+	uint32_t rawID = details::ToRawTime(frame).MonoID;
+	if (d_last < d_streams.size() && d_streams[d_last].RawID == rawID) {
+		return d_streams[d_last];
+	}
+	auto fi = std::find_if(
+	    d_streams.begin(),
+	    d_streams.end(),
+	    [rawID](const Stream &s) { return s.RawID == rawID; }
+	);
+	if (fi == d_streams.end()) {
+		d_streams.push_back({rawID, frame, FrameStats()});
+		fi = d_streams.end() - 1;
+	}
+	d_last = fi - d_streams.begin();
+	return *fi;
+}
+
+bool GapDetector::Check(Stream &stream, const Time &frame, FrameGap &gap) {
+	if (stream.Stats.Frames++ == 0) {
+		stream.Last = frame;
+		return false;
+	}
+	uint64_t mono     = frame.MonotonicValue();
+	uint64_t last     = stream.Last.MonotonicValue();
+	uint64_t interval = mono - last;
+	bool     res      = false;
+	if (mono < last) {
+		++stream.Stats.Resets;
+	} else if (interval > d_maxInterval) {
+		uint64_t periods = (interval + d_period / 2) / d_period;
+		gap.MonoID       = frame.MonoID();
+		gap.Before       = stream.Last;
+		gap.After        = frame;
+		gap.Missing      = std::max(periods, uint64_t(2)) - 1;
+		++stream.Stats.Gaps;
+		stream.Stats.Missing += gap.Missing;
+		res = true;
+	}
+	stream.Last = frame;
+	return res;
+}
+
+bool GapDetector::Add(const Time &frame, FrameGap &gap) {
+	return Check(FindStream(frame), frame, gap);
+}
+
+size_t GapDetector::AddRun(
+    Stream &stream, const Time *frames, size_t n, std::vector<FrameGap> &gaps
+) {
+	size_t   i = 0;
+	FrameGap gap;
+	if (stream.Stats.Frames == 0) {
+		Check(stream, frames[0], gap);
+		i = 1;
+	}
+	uint64_t mono[SCAN_BLOCK + 1];
+	while (i < n) {
+		size_t   size  = std::min(SCAN_BLOCK, n - i);
+		uint32_t other = 0;
+		mono[0]        = details::ToRawTime(stream.Last).Mono;
+		for (size_t j = 0; j < size; ++j) {
+			auto raw    = details::ToRawTime(frames[i + j]);
+			mono[j + 1] = raw.Mono;
+			other |= raw.MonoID ^ stream.RawID;
+		}
+		if (other != 0) {
+			// the run of this stream ends within the block.
+			size = 0;
+			while (details::ToRawTime(frames[i + size]).MonoID ==
+			       stream.RawID) {
+				++size;
+			}
+		}
+		// a single unsigned comparison catches both gaps and resets,
+		// and vectorizes.
+		uint64_t irregular = 0;
+		for (size_t j = 0; j < size; ++j) {
+			irregular |= (mono[j + 1] - mono[j]) > d_maxInterval;
+		}
+		if (irregular == 0 && size > 0) {
+			stream.Stats.Frames += size;
+			stream.Last = frames[i + size - 1];
+		} else {
+			for (size_t j = 0; j < size; ++j) {
+				if (Check(stream, frames[i + j], gap)) {
+					gaps.push_back(gap);
+				}
+			}
+		}
+		i += size;
+		if (other != 0) {
+			break;
+		}
+	}
+	return i;
+}
+
+size_t
+GapDetector::Add(const std::vector<Time> &frames, std::vector<FrameGap> &gaps) {
+	size_t found = gaps.size();
+	for (size_t i = 0; i < frames.size();) {
+		auto &stream = FindStream(frames[i]);
+		i += AddRun(stream, frames.data() + i, frames.size() - i, gaps);
+	}
+	return gaps.size() - found;
+}
+
+FrameStats GapDetector::Stats(Time::MonoclockID monoID) const {
+	for (const auto &s : d_streams) {
+		if ((s.RawID & ~details::RawTime::HAS_MONO_BIT) == monoID) {
+			return s.Stats;
+		}
+	}
+	throw std::out_of_range(
+	    "no frame for MonoclockID " + std::to_string(monoID)
+	);
+}
+
+std::vector<FrameGap> GapDetector::Detect(
+    const std::vector<Time> &frames,
+    const Duration          &period,
+    const Duration          &tolerance
+) {
+	GapDetector           detector(period, tolerance);
+	std::vector<FrameGap> res;
+	detector.Add(frames, res);
+	return res;
+}
+
+} // namespace fort
@@ -0,0 +1,187 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Time.hpp"
+
+namespace fort {
+
+/**
+ * A gap between two consecutive frames of a stream
+ */
+struct FrameGap {
+	/**
+	 * The MonoclockID of the stream.
+	 */
+	Time::MonoclockID MonoID;
+	/**
+	 * The last frame before the gap.
+	 */
+	Time Before;
+	/**
+	 * The first frame after the gap.
+	 */
+	Time After;
+	/**
+	 * The estimated number of dropped frames, at least one.
+	 */
+	uint64_t Missing;
+};
+
+/**
+ * Counters of a frame stream
+ */
+struct FrameStats {
+	/**
+	 * The number of frames received.
+	 */
+	uint64_t Frames = 0;
+	/**
+	 * The number of FrameGap detected.
+	 */
+	uint64_t Gaps = 0;
+	/**
+	 * The total estimated number of dropped frames.
+	 */
+	uint64_t Missing = 0;
+	/**
+	 * The number of times the monotonic value went backward, e.g.
+	 * when the framegrabber restarted. They are not counted as gaps.
+	 */
+	uint64_t Resets = 0;
+};
+
+/**
+ * Detects dropped frames from their monotonic timestamps
+ *
+ * Frames are Time with a monotonic value, as built by
+ * Time::FromTimestampAndMonotonic(), and each MonoclockID is a
+ * separate stream. A gap is reported when two consecutive frames of a
+ * stream are further apart than the nominal period plus the
+ * tolerance. The number of missing frames is the gap rounded to a
+ * whole number of periods, minus one.
+ *
+ * Frames can be fed one by one, or by batch with Add(const
+ * std::vector<Time>&,std::vector<FrameGap>&), which scans the
+ * adjacent differences of each stream with vectorized comparisons and
+ * only inspects the blocks containing a gap. Both can be mixed, the
+ * state of each stream is kept between calls.
+ *
+ * ```c++
+ * using namespace fort;
+ * GapDetector detector(Duration::Second.Nanoseconds() / 30, 5 * Duration::Millisecond);
+ * std::vector<FrameGap> gaps;
+ * detector.Add(frames, gaps);
+ * for (const auto & gap : gaps) {
+ *     std::cerr << gap.Missing << " frames dropped after " << gap.Before << std::endl;
+ * }
+ * ```
+ */
+class GapDetector {
+public:
+	/**
+	 * Constructor
+	 *
+	 * @param period the nominal frame period
+	 * @param tolerance the jitter allowed on the period
+	 *
+	 * @throws std::invalid_argument if period is not strictly positive
+	 *         or tolerance is negative.
+	 */
+	GapDetector(const Duration &period, const Duration &tolerance = 0);
+
+	/**
+	 * Adds a single frame
+	 *
+	 * @param frame the Time of the frame
+	 * @param gap set to the gap before frame, if any
+	 *
+	 * @return `true` if gap was set.
+	 *
+	 * @throws std::invalid_argument if frame has no monotonic value.
+	 */
+	bool Add(const Time &frame, FrameGap &gap);
+
+	/**
+	 * Adds a batch of frames
+	 *
+	 * @param frames the frames, in order for each stream. Streams may
+	 *        be interleaved, but long runs of a single stream are
+	 *        processed faster.
+	 * @param gaps the vector the detected FrameGap are appended to
+	 *
+	 * @return the number of FrameGap appended.
+	 *
+	 * @throws std::invalid_argument if a frame has no monotonic
+	 *         value. The preceding frames are accounted for.
+	 */
+	size_t Add(const std::vector<Time> &frames, std::vector<FrameGap> &gaps);
+
+	/**
+	 * Gets the counters of a stream
+	 *
+	 * @param monoID the MonoclockID of the stream
+	 *
+	 * @return the FrameStats of the stream
+	 *
+	 * @throws std::out_of_range if no frame of the stream was added.
+	 */
+	FrameStats Stats(Time::MonoclockID monoID) const;
+
+	/**
+	 * Detects the gaps of a batch of frames
+	 *
+	 * @param frames the frames, in order for each stream
+	 * @param period the nominal frame period
+	 * @param tolerance the jitter allowed on the period
+	 *
+	 * @return the FrameGap of frames
+	 */
+	static std::vector<FrameGap> Detect(
+	    const std::vector<Time> &frames,
+	    const Duration          &period,
+	    const Duration          &tolerance = 0
+	);
+
+private:
+	struct Stream {
+		uint32_t   RawID;
+		Time       Last;
+		FrameStats Stats;
+	};
+
+	Stream &FindStream(const Time &frame);
+
+	bool Check(Stream &stream, const Time &frame, FrameGap &gap);
+
+	// Adds the frames of stream at the start of [frames,frames+n),
+	// returns how many were added.
+	size_t AddRun(
+	    Stream &stream, const Time *frames, size_t n, std::vector<FrameGap> &gaps
+	);
+
+	uint64_t            d_period, d_maxInterval;
+	std::vector<Stream> d_streams;
+	size_t              d_last;
+};
+
+} // namespace fort
@@ -0,0 +1,138 @@
+#include "GapDetector.hpp"
+
+#include <set>
+
+#include "GapDetectorUTest.hpp"
+
+namespace fort {
+
+static const Duration PERIOD = 33333333;
+
+// Frames at 30 fps with jitter, skipping the dropped indexes.
+static std::vector<Time> Frames(
+    Time::MonoclockID id, size_t n, const std::set<size_t> &dropped
+) {
+	std::vector<Time> res;
+	auto              start = Time::FromUnix(1700000000, 0);
+	for (size_t i = 0; i < n; ++i) {
+		if (dropped.count(i) != 0) {
+			continue;
+		}
+		int64_t t = i * PERIOD.Nanoseconds() + (i % 3) * 100000;
+		res.push_back(Time::FromTimestampAndMonotonic(
+		    start.Add(t).ToTimestamp(),
+		    1000000000 + t,
+		    id
+		));
+	}
+	return res;
+}
+
+TEST_F(GapDetectorUTest, FindsDroppedFrames) {
+	// drops around the scan blocks boundaries
+	auto frames = Frames(3, 1000, {5, 254, 255, 256, 511, 700, 701});
+	auto gaps   = GapDetector::Detect(frames, PERIOD, Duration::Millisecond);
+	ASSERT_EQ(gaps.size(), 4);
+	std::vector<uint64_t> missing = {1, 3, 1, 2};
+	std::vector<int64_t>  before  = {4, 253, 510, 699};
+	for (size_t i = 0; i < gaps.size(); ++i) {
+		EXPECT_EQ(gaps[i].MonoID, 3);
+		EXPECT_EQ(gaps[i].Missing, missing[i]);
+		EXPECT_EQ(
+		    gaps[i].Before.MonotonicValue(),
+		    1000000000 + before[i] * PERIOD.Nanoseconds() + (before[i] % 3) * 100000
+		);
+		EXPECT_EQ(
+		    (gaps[i].After.Sub(gaps[i].Before).Nanoseconds() + PERIOD.Nanoseconds() / 2) /
+		        PERIOD.Nanoseconds(),
+		    missing[i] + 1
+		);
+	}
+
+	// a too small tolerance reports the jitter as gaps
+	EXPECT_GT(GapDetector::Detect(frames, PERIOD).size(), gaps.size());
+}
+
+TEST_F(GapDetectorUTest, StreamingMatchesBatch) {
+	auto a = Frames(1, 600, {10, 400, 401});
+	auto b = Frames(2, 600, {0, 300});
+
+	std::vector<Time> interleaved;
+	for (size_t i = 0; i < std::max(a.size(), b.size()); ++i) {
+		// long runs of each stream, then one by one
+		if (i < a.size()) {
+			interleaved.push_back(a[i]);
+		}
+		if (i >= 350 && i < b.size()) {
+			interleaved.push_back(b[i]);
+		}
+		if (i == 349) {
+			interleaved.insert(interleaved.end(), b.begin(), b.begin() + 350);
+		}
+	}
+	ASSERT_EQ(interleaved.size(), a.size() + b.size());
+
+	GapDetector           batch(PERIOD, Duration::Millisecond);
+	std::vector<FrameGap> batchGaps;
+	EXPECT_EQ(batch.Add(interleaved, batchGaps), 3);
+
+	GapDetector           streaming(PERIOD, Duration::Millisecond);
+	std::vector<FrameGap> streamingGaps;
+	for (const auto &f : interleaved) {
+		FrameGap gap;
+		if (streaming.Add(f, gap)) {
+			streamingGaps.push_back(gap);
+		}
+	}
+	ASSERT_EQ(streamingGaps.size(), batchGaps.size());
+	for (size_t i = 0; i < batchGaps.size(); ++i) {
+		EXPECT_EQ(streamingGaps[i].MonoID, batchGaps[i].MonoID);
+		EXPECT_EQ(streamingGaps[i].Missing, batchGaps[i].Missing);
+		EXPECT_TRUE(streamingGaps[i].After.Equals(batchGaps[i].After));
+	}
+
+	for (const auto &d : {&batch, &streaming}) {
+		auto stats = d->Stats(1);
+		EXPECT_EQ(stats.Frames, a.size());
+		EXPECT_EQ(stats.Gaps, 2);
+		EXPECT_EQ(stats.Missing, 3);
+		stats = d->Stats(2);
+		EXPECT_EQ(stats.Frames, b.size());
+		EXPECT_EQ(stats.Gaps, 1);
+		EXPECT_EQ(stats.Missing, 1);
+		EXPECT_THROW(d->Stats(3), std::out_of_range);
+	}
+}
+
+TEST_F(GapDetectorUTest, KeepsStateBetweenBatches) {
+	auto                  frames = Frames(1, 100, {50});
+	GapDetector           detector(PERIOD, Duration::Millisecond);
+	std::vector<FrameGap> gaps;
+	detector.Add({frames.begin(), frames.begin() + 50}, gaps);
+	EXPECT_TRUE(gaps.empty());
+	detector.Add({frames.begin() + 50, frames.end()}, gaps);
+	ASSERT_EQ(gaps.size(), 1);
+	EXPECT_EQ(gaps[0].Missing, 1);
+
+	// the framegrabber restarted
+	detector.Add(Frames(1, 10, {}), gaps);
+	EXPECT_EQ(gaps.size(), 1);
+	EXPECT_EQ(detector.Stats(1).Resets, 1);
+	EXPECT_EQ(detector.Stats(1).Frames, 109);
+}
+
+TEST_F(GapDetectorUTest, RejectsInvalidInputs) {
+	EXPECT_THROW(GapDetector(0), std::invalid_argument);
+	EXPECT_THROW(GapDetector(PERIOD, -1), std::invalid_argument);
+
+	GapDetector detector(PERIOD);
+	FrameGap    gap;
+	EXPECT_THROW(detector.Add(Time::FromUnix(0, 0), gap), std::invalid_argument);
+	std::vector<FrameGap> gaps;
+	auto                  frames = Frames(1, 10, {});
+	frames.push_back(Time::FromUnix(0, 0));
+	EXPECT_THROW(detector.Add(frames, gaps), std::invalid_argument);
+	EXPECT_EQ(detector.Stats(1).Frames, 10);
+}
+
+} // namespace fort
@@ -0,0 +1,114 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "Histogram.hpp"
+
+namespace fort {
+
+DurationHistogram::DurationHistogram()
+    : d_counts(BUCKETS, 0)
+    , d_count(0)
+    , d_sum(0)
+    , d_min(std::numeric_limits<int64_t>::max())
+    , d_max(0) {}
+
+void DurationHistogram::Merge(const DurationHistogram &other) {
+	if (other.d_count == 0) {
+		return;
+	}
+	for (size_t i = 0; i < BUCKETS; ++i) {
+		d_counts[i] += other.d_counts[i];
+	}
+	d_count += other.d_count;
+	d_sum += other.d_sum;
+	d_min = std::min(d_min, other.d_min);
+	d_max = std::max(d_max, other.d_max);
+}
+
+void DurationHistogram::Reset() {
+	std::fill(d_counts.begin(), d_counts.end(), 0);
+	d_count = 0;
+	d_sum   = 0;
+	d_min   = std::numeric_limits<int64_t>::max();
+	d_max   = 0;
+}
+
+Duration DurationHistogram::Min() const {
+	return d_count == 0 ? 0 : d_min;
+}
+
+Duration DurationHistogram::Max() const {
+	return d_max;
+}
+
+Duration DurationHistogram::Mean() const {
+	if (d_count == 0) {
+		return 0;
+	}
+	return int64_t(d_sum / d_count);
+}
+
+Duration DurationHistogram::Percentile(double percentile) const {
+	if (percentile < 0.0 || percentile > 100.0 || std::isnan(percentile)) {
+		throw std::invalid_argument(
+		    "Percentile must be in [0,100], got " + std::to_string(percentile)
+		);
+	}
+	if (d_count == 0) {
+		return 0;
+	}
+	uint64_t rank = std::ceil(percentile / 100.0 * double(d_count));
+	rank          = std::max(rank, uint64_t(1));
+
+	uint64_t seen = 0;
+	for (size_t i = 0; i < BUCKETS; ++i) {
+		seen += d_counts[i];
+		if (seen >= rank) {
+			auto res = BucketUpperBound(i);
+			return std::max(std::min(res, Max()), Min());
+		}
+	}
+	return Max();
+}
+
+static inline void DecomposeBucket(size_t index, uint64_t &m, int &e) {
+	const size_t S = DurationHistogram::SUB_BUCKETS;
+	e              = index < 2 * S ? 0 : int(index / S) - 1;
+	m              = index - size_t(e) * S;
+}
+
+Duration DurationHistogram::BucketLowerBound(size_t index) {
+	uint64_t m;
+	int      e;
+	DecomposeBucket(index, m, e);
+	return int64_t(m << e);
+}
+
+Duration DurationHistogram::BucketUpperBound(size_t index) {
+	uint64_t m;
+	int      e;
+	DecomposeBucket(index, m, e);
+	return int64_t(((m + 1) << e) - 1);
+}
+
+} // namespace fort
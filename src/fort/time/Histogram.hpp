@@ -0,0 +1,251 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Time.hpp"
+
+namespace fort {
+
+/**
+ * A fixed memory log-linear histogram of Duration
+ *
+ * DurationHistogram records Duration in buckets whose width grows
+ * with the recorded value, in the spirit of
+ * [HdrHistogram](http://hdrhistogram.org). Every power of two is
+ * split in #SUB_BUCKETS linear buckets, therefore any recorded value
+ * is known with a relative error smaller than `1/SUB_BUCKETS`, and
+ * values smaller than `2*SUB_BUCKETS` nanoseconds are exact.
+ *
+ * All memory is allocated at construction, Record() is O(1) and never
+ * allocates. Histograms can be merged with Merge(), and a copy of a
+ * histogram is a snapshot of its state.
+ *
+ * ```c++
+ * using namespace fort;
+ * DurationHistogram latencies;
+ * for ( const auto & frame : frames ) {
+ *     ScopedTimer timer(latencies);
+ *     Process(frame);
+ * }
+ * std::cout << "p99: " << latencies.Percentile(99.0) << std::endl;
+ * ```
+ *
+ * Negative Duration are recorded as zero.
+ */
+class DurationHistogram {
+public:
+	/**
+	 * Number of bits of precision of each bucket.
+	 */
+	const static int PRECISION_BITS = 7;
+
+	/**
+	 * Number of linear sub-buckets for each power of two.
+	 */
+	const static uint64_t SUB_BUCKETS = uint64_t(1) << PRECISION_BITS;
+
+	/**
+	 * Total number of buckets, enough to cover any positive Duration.
+	 */
+	const static size_t BUCKETS = (64 - PRECISION_BITS) * SUB_BUCKETS;
+
+	/**
+	 * Default constructor, an empty histogram.
+	 */
+	DurationHistogram();
+
+	/**
+	 * Records a Duration
+	 *
+	 * @param d the Duration to record
+	 */
+	inline void Record(const Duration &d) {
+		RecordN(d, 1);
+	}
+
+	/**
+	 * Records a Duration several times
+	 *
+	 * @param d the Duration to record
+	 * @param count the number of times d was observed
+	 */
+	inline void RecordN(const Duration &d, uint64_t count) {
+		int64_t ns = d.Nanoseconds() < 0 ? 0 : d.Nanoseconds();
+		d_counts[BucketIndex(ns)] += count;
+		d_count += count;
+		d_sum += uint64_t(ns) * count;
+		d_min = ns < d_min ? ns : d_min;
+		d_max = ns > d_max ? ns : d_max;
+	}
+
+	/**
+	 * Merges another histogram in this one
+	 *
+	 * @param other the histogram to add to this one.
+	 */
+	void Merge(const DurationHistogram &other);
+
+	/**
+	 * Empties the histogram.
+	 */
+	void Reset();
+
+	/**
+	 * Gets the number of recorded values.
+	 *
+	 * @return the number of values recorded.
+	 */
+	inline uint64_t Count() const {
+		return d_count;
+	}
+
+	/**
+	 * Gets the smallest recorded value.
+	 *
+	 * @return the exact smallest recorded Duration, or zero if empty.
+	 */
+	Duration Min() const;
+
+	/**
+	 * Gets the largest recorded value.
+	 *
+	 * @return the exact largest recorded Duration, or zero if empty.
+	 */
+	Duration Max() const;
+
+	/**
+	 * Gets the mean recorded value.
+	 *
+	 * @return the exact mean of the recorded Duration, or zero if empty.
+	 */
+	Duration Mean() const;
+
+	/**
+	 * Gets a percentile of the recorded values.
+	 *
+	 * @param percentile the wanted percentile in [0,100].
+	 *
+	 * @return a Duration such that at least percentile % of the
+	 *         recorded values are smaller or equal, within the
+	 *         precision of the histogram. Returns zero if empty.
+	 *
+	 * @throws std::invalid_argument if percentile is not in [0,100]
+	 */
+	Duration Percentile(double percentile) const;
+
+	/**
+	 * Gets the number of values recorded in a bucket.
+	 *
+	 * @param index the bucket index, smaller than #BUCKETS
+	 *
+	 * @return the number of values in the bucket.
+	 */
+	inline uint64_t BucketCount(size_t index) const {
+		return d_counts[index];
+	}
+
+	/**
+	 * Computes the bucket a value belongs to
+	 *
+	 * @param ns a positive amount of nanoseconds
+	 *
+	 * @return the index of the bucket for ns.
+	 */
+	static inline size_t BucketIndex(int64_t ns) {
+		uint64_t v   = ns;
+		int      msb = 63 - __builtin_clzll(v | 1);
+		int      e   = msb > PRECISION_BITS ? msb - PRECISION_BITS : 0;
+		return size_t(e) * SUB_BUCKETS + (v >> e);
+	}
+
+	/**
+	 * Gets the smallest value a bucket can hold.
+	 *
+	 * @param index the bucket index, smaller than #BUCKETS
+	 *
+	 * @return the lowest Duration recorded in this bucket.
+	 */
+	static Duration BucketLowerBound(size_t index);
+
+	/**
+	 * Gets the largest value a bucket can hold.
+	 *
+	 * @param index the bucket index, smaller than #BUCKETS
+	 *
+	 * @return the highest Duration recorded in this bucket.
+	 */
+	static Duration BucketUpperBound(size_t index);
+
+private:
+	friend class LatencyRegistry;
+
+	std::vector<uint64_t> d_counts;
+	uint64_t              d_count;
+	uint64_t              d_sum;
+	int64_t               d_min;
+	int64_t               d_max;
+};
+
+/**
+ * Records the lifetime of a scope in a DurationHistogram.
+ *
+ * A ScopedTimer reads Time::Now() on construction, and records the
+ * monotonic time elapsed until its destruction in a
+ * DurationHistogram.
+ */
+class ScopedTimer {
+public:
+	/**
+	 * Starts a timer
+	 *
+	 * @param histogram the DurationHistogram to record to. It must
+	 *        outlive the ScopedTimer.
+	 */
+	inline ScopedTimer(DurationHistogram &histogram)
+	    : d_histogram(histogram)
+	    , d_start(Time::Now()) {}
+
+	/**
+	 * Records the elapsed time since construction.
+	 */
+	inline ~ScopedTimer() {
+		d_histogram.Record(Elapsed());
+	}
+
+	/**
+	 * Gets the elapsed time since construction.
+	 *
+	 * @return the monotonic Duration since this timer was started.
+	 */
+	inline Duration Elapsed() const {
+		return Time::Now().Sub(d_start);
+	}
+
+	ScopedTimer(const ScopedTimer &)            = delete;
+	ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+private:
+	DurationHistogram &d_histogram;
+	Time               d_start;
+};
+
+} // namespace fort
@@ -0,0 +1,121 @@
+#include "Histogram.hpp"
+
+#include <algorithm>
+#include <random>
+#include <thread>
+
+#include "HistogramUTest.hpp"
+
+namespace fort {
+
+TEST_F(HistogramUTest, BucketsCoverAllValues) {
+	EXPECT_EQ(DurationHistogram::BucketIndex(0), 0);
+	EXPECT_EQ(
+	    DurationHistogram::BucketIndex(std::numeric_limits<int64_t>::max()),
+	    DurationHistogram::BUCKETS - 1
+	);
+	EXPECT_EQ(
+	    DurationHistogram::BucketUpperBound(DurationHistogram::BUCKETS - 1),
+	    std::numeric_limits<int64_t>::max()
+	);
+
+	for (size_t i = 0; i < DurationHistogram::BUCKETS; ++i) {
+		auto low  = DurationHistogram::BucketLowerBound(i).Nanoseconds();
+		auto high = DurationHistogram::BucketUpperBound(i).Nanoseconds();
+		ASSERT_LE(low, high);
+		EXPECT_EQ(DurationHistogram::BucketIndex(low), i);
+		EXPECT_EQ(DurationHistogram::BucketIndex(high), i);
+		if (i > 0) {
+			EXPECT_EQ(
+			    DurationHistogram::BucketUpperBound(i - 1).Nanoseconds() + 1,
+			    low
+			);
+		}
+		// relative precision
+		EXPECT_LE(
+		    double(high - low),
+		    double(low) / double(DurationHistogram::SUB_BUCKETS)
+		) << "bucket " << i;
+	}
+}
+
+TEST_F(HistogramUTest, EmptyHistogram) {
+	DurationHistogram h;
+	EXPECT_EQ(h.Count(), 0);
+	EXPECT_EQ(h.Min(), 0);
+	EXPECT_EQ(h.Max(), 0);
+	EXPECT_EQ(h.Mean(), 0);
+	EXPECT_EQ(h.Percentile(50), 0);
+	EXPECT_THROW(h.Percentile(-1), std::invalid_argument);
+	EXPECT_THROW(h.Percentile(101), std::invalid_argument);
+}
+
+TEST_F(HistogramUTest, Percentiles) {
+	std::mt19937_64                     rng(42);
+	std::lognormal_distribution<double> dist(12.0, 2.0);
+	std::vector<int64_t>                values;
+	DurationHistogram                   h;
+	for (size_t i = 0; i < 100000; ++i) {
+		int64_t v = dist(rng);
+		values.push_back(v);
+		h.Record(v);
+	}
+	h.Record(-10);
+	values.push_back(0);
+	std::sort(values.begin(), values.end());
+
+	EXPECT_EQ(h.Count(), values.size());
+	EXPECT_EQ(h.Min(), values.front());
+	EXPECT_EQ(h.Max(), values.back());
+
+	for (double p : {0.0, 1.0, 10.0, 50.0, 90.0, 99.0, 99.9, 100.0}) {
+		size_t rank = std::max(
+		    size_t(std::ceil(p / 100.0 * values.size())),
+		    size_t(1)
+		);
+		double expected = values[rank - 1];
+		double res      = h.Percentile(p).Nanoseconds();
+		EXPECT_GE(res, expected) << "p" << p;
+		EXPECT_LE(res, expected * (1.0 + 1.0 / DurationHistogram::SUB_BUCKETS))
+		    << "p" << p;
+	}
+}
+
+TEST_F(HistogramUTest, Merge) {
+	DurationHistogram a, b, all;
+	for (int64_t i = 1; i <= 1000; ++i) {
+		auto &h = i % 2 == 0 ? a : b;
+		h.Record(i * Duration::Microsecond);
+		all.Record(i * Duration::Microsecond);
+	}
+	auto snapshot = a;
+	snapshot.Merge(b);
+	EXPECT_EQ(snapshot.Count(), all.Count());
+	EXPECT_EQ(snapshot.Min(), 1 * Duration::Microsecond);
+	EXPECT_EQ(snapshot.Max(), 1000 * Duration::Microsecond);
+	EXPECT_EQ(snapshot.Mean(), all.Mean());
+	for (size_t i = 0; i < DurationHistogram::BUCKETS; ++i) {
+		EXPECT_EQ(snapshot.BucketCount(i), all.BucketCount(i));
+	}
+	// a itself is left untouched
+	EXPECT_EQ(a.Count(), 500);
+
+	snapshot.Reset();
+	EXPECT_EQ(snapshot.Count(), 0);
+	EXPECT_EQ(snapshot.Percentile(100), 0);
+}
+
+TEST_F(HistogramUTest, ScopedTimer) {
+	DurationHistogram h;
+	Duration          elapsed;
+	{
+		ScopedTimer timer(h);
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		elapsed = timer.Elapsed();
+	}
+	ASSERT_EQ(h.Count(), 1);
+	EXPECT_GE(h.Min(), elapsed);
+	EXPECT_GE(elapsed, 1 * Duration::Millisecond);
+}
+
+} // namespace fort
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+namespace fort {
+
+class HistogramUTest : public ::testing::Test {};
+
+} // namespace fort
@@ -0,0 +1,343 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Merge.hpp"
+#include "Time.hpp"
+
+namespace fort {
+
+/**
+ * The direction an AsOfJoin looks for a match
+ */
+enum class JoinDirection {
+	/**
+	 * The last right item at or before the left item.
+	 */
+	BACKWARD = 0,
+	/**
+	 * The first right item at or after the left item.
+	 */
+	FORWARD,
+	/**
+	 * The closest of the BACKWARD and FORWARD matches, BACKWARD on
+	 * ties.
+	 */
+	NEAREST,
+};
+
+/**
+ * Options of an AsOfJoin
+ */
+struct AsOfJoinOptions {
+	/**
+	 * The direction to look for a match.
+	 */
+	JoinDirection Direction = JoinDirection::BACKWARD;
+	/**
+	 * The largest Duration between matched items. A negative value
+	 * means no limit.
+	 */
+	Duration Tolerance = -1;
+	/**
+	 * The maximal number of threads to use. Only used with random
+	 * access iterators, and for large inputs.
+	 */
+	size_t Threads = 1;
+};
+
+namespace details {
+
+// Distance between two ordered Time, saturated if not representable.
+inline Duration JoinDistance(const Time &from, const Time &to) {
+	try {
+		return to.Sub(from);
+	} catch (const Time::Overflow &) {
+		return std::numeric_limits<int64_t>::max();
+	}
+}
+
+// Minimal number of left items per thread.
+const static size_t JOIN_MIN_CHUNK = 1 << 14;
+
+template <
+    typename LeftIterator,
+    typename RightIterator,
+    typename LeftKey,
+    typename RightKey>
+void AsOfJoinRange(
+    LeftIterator                          left,
+    LeftIterator                          leftEnd,
+    size_t                                leftIndex,
+    RightIterator                         right,
+    RightIterator                         rightEnd,
+    size_t                                rightIndex,
+    const AsOfJoinOptions                &options,
+    const LeftKey                        &leftKey,
+    const RightKey                       &rightKey,
+    std::vector<std::pair<size_t, size_t>> &matches
+) {
+	// right is the first item not before the current left item,
+	// last the item preceding it.
+	bool   hasLast = false;
+	Time   last;
+	size_t lastIndex = 0;
+	bool   hasNext   = right != rightEnd;
+	Time   next      = hasNext ? Time(rightKey(*right)) : Time();
+	// the last of the right items equal to the one at runStart.
+	size_t runStart = std::numeric_limits<size_t>::max();
+	size_t runLast  = 0;
+	for (; left != leftEnd; ++left, ++leftIndex) {
+		Time l = leftKey(*left);
+		while (hasNext && next.Before(l)) {
+			hasLast   = true;
+			last      = next;
+			lastIndex = rightIndex;
+			++right;
+			++rightIndex;
+			hasNext = right != rightEnd;
+			if (hasNext) {
+				next = rightKey(*right);
+			}
+		}
+		// an exact match is both a BACKWARD and a FORWARD match.
+		bool   exact  = hasNext && l.Before(next) == false;
+		size_t bIndex = lastIndex;
+		if (exact && options.Direction != JoinDirection::FORWARD) {
+			// BACKWARD matches the last of the equal right items. The
+			// run only depends on right, so equal left items reuse it.
+			if (runStart != rightIndex) {
+				runStart = rightIndex;
+				runLast  = rightIndex;
+				for (auto it = std::next(right);
+				     it != rightEnd && l.Before(rightKey(*it)) == false;
+				     ++it) {
+					++runLast;
+				}
+			}
+			bIndex = runLast;
+		}
+
+		bool     backward = hasLast || exact;
+		Duration bDist    = 0;
+		bool     forward  = hasNext;
+		Duration fDist    = 0;
+
+		bool checkTolerance = options.Tolerance >= 0;
+		bool nearest        = options.Direction == JoinDirection::NEAREST;
+		if (backward && exact == false && (checkTolerance || nearest)) {
+			bDist = JoinDistance(last, l);
+		}
+		if (forward && exact == false && (checkTolerance || nearest)) {
+			fDist = JoinDistance(l, next);
+		}
+		if (checkTolerance) {
+			backward = backward && bDist <= options.Tolerance;
+			forward  = forward && fDist <= options.Tolerance;
+		}
+
+		switch (options.Direction) {
+		case JoinDirection::BACKWARD:
+			forward = false;
+			break;
+		case JoinDirection::FORWARD:
+			backward = false;
+			break;
+		case JoinDirection::NEAREST:
+			if (backward && forward) {
+				backward = bDist <= fDist;
+				forward  = !backward;
+			}
+			break;
+		}
+		if (backward) {
+			matches.push_back({leftIndex, bIndex});
+		} else if (forward) {
+			matches.push_back({leftIndex, rightIndex});
+		}
+	}
+}
+
+} // namespace details
+
+/**
+ * As-of join of two Time sorted sequences
+ *
+ * For each item of the left sequence, finds the matching item of the
+ * right sequence in AsOfJoinOptions::Direction, within
+ * AsOfJoinOptions::Tolerance. Both sequences are walked once, in
+ * `O(n + m)` comparisons, instead of a binary search per left item.
+ *
+ * Items are compared with Time::Before(), as in TimeMerge. With
+ * random access iterators and AsOfJoinOptions::Threads greater than
+ * one, the left sequence is split in chunks processed in parallel,
+ * each starting with a binary search in the right sequence. Iterators
+ * must be at least forward iterators.
+ *
+ * ```c++
+ * using namespace fort;
+ * AsOfJoinOptions options;
+ * options.Direction = JoinDirection::NEAREST;
+ * options.Tolerance = 5 * Duration::Millisecond;
+ * auto matches = AsOfJoin(
+ *     detections.begin(), detections.end(),
+ *     frames.begin(), frames.end(),
+ *     options,
+ *     [](const Detection & d) { return d.Time; },
+ *     [](const Frame & f) { return f.Time; });
+ * for (const auto & [d, f] : matches) {
+ *     Annotate(detections[d], frames[f]);
+ * }
+ * ```
+ *
+ * @param left the beginning of the left sequence, sorted by Time
+ * @param leftEnd the end of the left sequence
+ * @param right the beginning of the right sequence, sorted by Time
+ * @param rightEnd the end of the right sequence
+ * @param options the AsOfJoinOptions of the join
+ * @param leftKey the key function extracting the Time of a left item
+ * @param rightKey the key function extracting the Time of a right item
+ *
+ * @return the `(left,right)` index pairs of the matches, in left
+ *         order. Left items without match are omitted.
+ */
+template <
+    typename LeftIterator,
+    typename RightIterator,
+    typename LeftKey  = TimeIdentity,
+    typename RightKey = TimeIdentity>
+std::vector<std::pair<size_t, size_t>> AsOfJoin(
+    LeftIterator           left,
+    LeftIterator           leftEnd,
+    RightIterator          right,
+    RightIterator          rightEnd,
+    const AsOfJoinOptions &options  = AsOfJoinOptions(),
+    LeftKey                leftKey  = LeftKey(),
+    RightKey               rightKey = RightKey()
+) {
+	typedef std::vector<std::pair<size_t, size_t>> Matches;
+	constexpr bool randomAccess =
+	    std::is_base_of<
+	        std::random_access_iterator_tag,
+	        typename std::iterator_traits<LeftIterator>::iterator_category>::
+	        value &&
+	    std::is_base_of<
+	        std::random_access_iterator_tag,
+	        typename std::iterator_traits<RightIterator>::iterator_category>::
+	        value;
+
+	Matches res;
+	if constexpr (randomAccess) {
+		size_t n      = leftEnd - left;
+		size_t chunks = std::max(
+		    std::min(options.Threads, n / details::JOIN_MIN_CHUNK),
+		    size_t(1)
+		);
+		if (chunks > 1) {
+			size_t                   chunkSize = (n + chunks - 1) / chunks;
+			std::vector<Matches>     results(chunks);
+			std::vector<std::thread> workers;
+			for (size_t c = 0; c < chunks; ++c) {
+				workers.emplace_back([&, c]() {
+					size_t begin = c * chunkSize;
+					size_t end   = std::min(n, begin + chunkSize);
+					Time   first = leftKey(*(left + begin));
+					// the first right item not before the chunk, and
+					// the one preceding it.
+					auto start = std::partition_point(
+					    right,
+					    rightEnd,
+					    [&](const auto &r) {
+						    return Time(rightKey(r)).Before(first);
+					    }
+					);
+					if (start != right) {
+						--start;
+					}
+					details::AsOfJoinRange(
+					    left + begin,
+					    left + end,
+					    begin,
+					    start,
+					    rightEnd,
+					    start - right,
+					    options,
+					    leftKey,
+					    rightKey,
+					    results[c]
+					);
+				});
+			}
+			for (auto &w : workers) {
+				w.join();
+			}
+			for (const auto &r : results) {
+				res.insert(res.end(), r.begin(), r.end());
+			}
+			return res;
+		}
+	}
+	details::AsOfJoinRange(
+	    left,
+	    leftEnd,
+	    0,
+	    right,
+	    rightEnd,
+	    0,
+	    options,
+	    leftKey,
+	    rightKey,
+	    res
+	);
+	return res;
+}
+
+/**
+ * As-of join of two sorted vectors of Time
+ *
+ * @param left the left Time, sorted
+ * @param right the right Time, sorted
+ * @param options the AsOfJoinOptions of the join
+ *
+ * @return the `(left,right)` index pairs of the matches, in left
+ *         order. Left Time without match are omitted.
+ */
+inline std::vector<std::pair<size_t, size_t>> AsOfJoin(
+    const std::vector<Time> &left,
+    const std::vector<Time> &right,
+    const AsOfJoinOptions   &options = AsOfJoinOptions()
+) {
+	return AsOfJoin(
+	    left.begin(),
+	    left.end(),
+	    right.begin(),
+	    right.end(),
+	    options
+	);
+}
+
+} // namespace fort
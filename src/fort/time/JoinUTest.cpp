@@ -0,0 +1,198 @@
+#include "Join.hpp"
+
+#include <list>
+#include <random>
+
+#include "JoinUTest.hpp"
+
+namespace fort {
+
+static std::vector<Time>
+SortedTimes(size_t n, int64_t maxStep, std::mt19937 &rng) {
+	std::vector<Time> res;
+	auto              t = Time::FromUnix(1700000000, 0);
+	for (size_t i = 0; i < n; ++i) {
+		// steps of zero produce duplicates
+		t = t.Add(int64_t(rng() % maxStep));
+		res.push_back(t);
+	}
+	return res;
+}
+
+// Reference implementation with binary searches.
+static std::vector<std::pair<size_t, size_t>> NaiveJoin(
+    const std::vector<Time> &left,
+    const std::vector<Time> &right,
+    const AsOfJoinOptions   &options
+) {
+	auto before = [](const Time &a, const Time &b) { return a.Before(b); };
+	std::vector<std::pair<size_t, size_t>> res;
+	for (size_t i = 0; i < left.size(); ++i) {
+		const auto &l = left[i];
+		auto upper = std::upper_bound(right.begin(), right.end(), l, before);
+		auto lower = std::lower_bound(right.begin(), right.end(), l, before);
+		bool     backward = upper != right.begin();
+		bool     forward  = lower != right.end();
+		Duration bDist    = backward ? l.Sub(*(upper - 1)) : 0;
+		Duration fDist    = forward ? lower->Sub(l) : 0;
+		if (options.Tolerance >= 0) {
+			backward = backward && bDist <= options.Tolerance;
+			forward  = forward && fDist <= options.Tolerance;
+		}
+		if (options.Direction == JoinDirection::FORWARD) {
+			backward = false;
+		} else if (options.Direction == JoinDirection::BACKWARD) {
+			forward = false;
+		} else if (backward && forward) {
+			forward  = fDist < bDist;
+			backward = !forward;
+		}
+		if (backward) {
+			res.push_back({i, upper - 1 - right.begin()});
+		} else if (forward) {
+			res.push_back({i, lower - right.begin()});
+		}
+	}
+	return res;
+}
+
+TEST_F(JoinUTest, MatchesBinarySearches) {
+	std::mt19937 rng(42);
+	for (size_t n : {0, 1, 10, 1000, 100000}) {
+		auto left  = SortedTimes(n, 1000, rng);
+		auto right = SortedTimes(n / 2 + 1, 2000, rng);
+		for (auto direction :
+		     {JoinDirection::BACKWARD,
+		      JoinDirection::FORWARD,
+		      JoinDirection::NEAREST}) {
+			for (Duration tolerance :
+			     {Duration(-1), Duration(0), Duration(500)}) {
+				for (size_t threads : {1, 4}) {
+					AsOfJoinOptions options;
+					options.Direction = direction;
+					options.Tolerance = tolerance;
+					options.Threads   = threads;
+					SCOPED_TRACE(
+					    "n: " + std::to_string(n) +
+					    " direction: " + std::to_string(int(direction)) +
+					    " tolerance: " +
+					    std::to_string(tolerance.Nanoseconds()) +
+					    " threads: " + std::to_string(threads)
+					);
+					EXPECT_EQ(
+					    AsOfJoin(left, right, options),
+					    NaiveJoin(left, right, options)
+					);
+				}
+			}
+		}
+	}
+}
+
+TEST_F(JoinUTest, SupportsKeyFunctionsAndForwardIterators) {
+	struct Detection {
+		Time   DetectionTime;
+		size_t ID;
+	};
+
+	auto                 start = Time::FromUnix(0, 0);
+	std::list<Detection> detections;
+	for (size_t i = 0; i < 5; ++i) {
+		detections.push_back(
+		    {start.Add(
+		         i * 10 * Duration::Millisecond + 4 * Duration::Millisecond
+		     ),
+		     i}
+		);
+	}
+	std::vector<Time> frames;
+	for (int64_t i = 0; i < 3; ++i) {
+		frames.push_back(start.Add(i * 15 * Duration::Millisecond));
+	}
+
+	AsOfJoinOptions options;
+	options.Direction = JoinDirection::NEAREST;
+	options.Tolerance = 5 * Duration::Millisecond;
+	options.Threads   = 8;
+	auto matches      = AsOfJoin(
+        detections.begin(),
+        detections.end(),
+        frames.begin(),
+        frames.end(),
+        options,
+        [](const Detection &d) { return d.DetectionTime; }
+    );
+	// detections at 4, 14, 24, 34, 44ms, frames at 0, 15, 30ms
+	EXPECT_EQ(
+	    matches,
+	    (std::vector<std::pair<size_t, size_t>>{{0, 0}, {1, 1}, {3, 2}})
+	);
+}
+
+TEST_F(JoinUTest, HandlesDuplicateKeys) {
+	auto a = Time::FromUnix(0, 0), b = Time::FromUnix(1, 0),
+	     c = Time::FromUnix(2, 0);
+	std::vector<Time> left  = {a, a, a, b, b, c};
+	std::vector<Time> right = {a, a, a, a, c, c};
+	AsOfJoinOptions   options;
+	EXPECT_EQ(
+	    AsOfJoin(left, right, options),
+	    (std::vector<std::pair<size_t, size_t>>{
+	        {0, 3},
+	        {1, 3},
+	        {2, 3},
+	        {3, 3},
+	        {4, 3},
+	        {5, 5}}
+	    )
+	);
+	options.Direction = JoinDirection::FORWARD;
+	EXPECT_EQ(
+	    AsOfJoin(left, right, options),
+	    (std::vector<std::pair<size_t, size_t>>{
+	        {0, 0},
+	        {1, 0},
+	        {2, 0},
+	        {3, 4},
+	        {4, 4},
+	        {5, 4}}
+	    )
+	);
+
+	// long runs on both sides, which must not be rescanned.
+	left.assign(100000, a);
+	right.assign(100000, a);
+	right.push_back(b);
+	for (auto direction :
+	     {JoinDirection::BACKWARD,
+	      JoinDirection::FORWARD,
+	      JoinDirection::NEAREST}) {
+		options.Direction = direction;
+		EXPECT_EQ(
+		    AsOfJoin(left, right, options),
+		    NaiveJoin(left, right, options)
+		);
+	}
+}
+
+TEST_F(JoinUTest, HandlesInfiniteTime) {
+	std::vector<Time> left = {
+	    Time::SinceEver(),
+	    Time::FromUnix(0, 0),
+	    Time::Forever(),
+	};
+	std::vector<Time> right = {Time::FromUnix(-10, 0), Time::FromUnix(10, 0)};
+	AsOfJoinOptions   options;
+	options.Direction = JoinDirection::NEAREST;
+	EXPECT_EQ(
+	    AsOfJoin(left, right, options),
+	    (std::vector<std::pair<size_t, size_t>>{{0, 0}, {1, 0}, {2, 1}})
+	);
+	options.Tolerance = Duration::Hour;
+	EXPECT_EQ(
+	    AsOfJoin(left, right, options),
+	    (std::vector<std::pair<size_t, size_t>>{{1, 0}})
+	);
+}
+
+} // namespace fort
@@ -0,0 +1,340 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#include <stdexcept>
+
+#include "LatencyRegistry.hpp"
+
+namespace fort {
+
+// Buckets of a metric owned by a single recording thread. Only the
+// owning thread writes to it, the collector only reads.
+struct alignas(64) LatencyRegistry::Slot {
+	Slot() {
+		Sum.store(0, std::memory_order_relaxed);
+		for (auto &c : Counts) {
+			c.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	std::atomic<uint64_t> Sum;
+	std::atomic<uint64_t> Counts[DurationHistogram::BUCKETS];
+	Slot                 *Next = nullptr;
+};
+
+struct LatencyRegistry::MetricData {
+	MetricData(const std::string &name, size_t index)
+	    : Name(name)
+	    , Index(index)
+	    , Slots(nullptr)
+	    , Previous(DurationHistogram::BUCKETS, 0)
+	    , PreviousSum(0)
+	    , Exited(DurationHistogram::BUCKETS, 0)
+	    , ExitedSum(0) {}
+
+	~MetricData() {
+		auto slot = Slots.load();
+		while (slot != nullptr) {
+			auto next = slot->Next;
+			delete slot;
+			slot = next;
+		}
+	}
+
+	const std::string   Name;
+	const size_t        Index;
+	std::atomic<Slot *> Slots;
+
+	// protected by d_collectMutex
+	std::vector<uint64_t> Previous;
+	uint64_t              PreviousSum;
+	// counts of the exited threads, whose zeroed slots are in Free.
+	std::vector<uint64_t> Exited;
+	uint64_t              ExitedSum;
+	std::vector<Slot *>   Free;
+};
+
+// Returns the slots of the current thread to their registry on exit.
+struct LatencyRegistry::ThreadExit {
+	~ThreadExit();
+};
+
+std::atomic<uint64_t> LatencyRegistry::s_nextSerial(0);
+
+namespace {
+// Slots of the current thread, for each registry serial, indexed by
+// metric index.
+thread_local std::map<uint64_t, std::vector<void *>> t_slots;
+thread_local uint64_t                                t_lastSerial = 0;
+thread_local std::vector<void *>                    *t_last       = nullptr;
+
+// Registries alive, by serial, so exiting threads can return their
+// slots.
+struct RegistryList {
+	std::mutex                            Mutex;
+	std::map<uint64_t, LatencyRegistry *> Registries;
+};
+
+RegistryList &Registries() {
+	// never destroyed, as threads may exit after static destructors.
+	static auto list = new RegistryList();
+	return *list;
+}
+
+// Erases the slots of the destroyed registries, whose serials are
+// never reused, so t_slots only grows with the live registries.
+void EraseDeadSlots() {
+	auto                       &list = Registries();
+	std::lock_guard<std::mutex> lock(list.Mutex);
+	for (auto it = t_slots.begin(); it != t_slots.end();) {
+		if (list.Registries.count(it->first) == 0) {
+			it = t_slots.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+} // namespace
+
+LatencyRegistry::ThreadExit::~ThreadExit() {
+	{
+		auto                       &list = Registries();
+		std::lock_guard<std::mutex> lock(list.Mutex);
+		for (auto &[serial, slots] : t_slots) {
+			auto fi = list.Registries.find(serial);
+			if (fi != list.Registries.end()) {
+				fi->second->ReleaseSlots(slots);
+			}
+		}
+	}
+	t_slots.clear();
+	t_lastSerial = 0;
+	t_last       = nullptr;
+}
+
+LatencyRegistry::Metric::Metric(LatencyRegistry *registry, MetricData *data)
+    : d_registry(registry)
+    , d_data(data) {}
+
+void LatencyRegistry::Metric::Record(const Duration &d) const {
+	auto    slot = d_registry->LocalSlot(*d_data);
+	int64_t ns   = d.Nanoseconds() < 0 ? 0 : d.Nanoseconds();
+	auto   &c    = slot->Counts[DurationHistogram::BucketIndex(ns)];
+	// single writer: no need for an atomic read-modify-write.
+	c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	slot->Sum.store(
+	    slot->Sum.load(std::memory_order_relaxed) + ns,
+	    std::memory_order_relaxed
+	);
+}
+
+const std::string &LatencyRegistry::Metric::Name() const {
+	return d_data->Name;
+}
+
+LatencyRegistry::LatencyRegistry()
+    : d_serial(++s_nextSerial)
+    , d_collectorStop(false) {
+	auto                       &list = Registries();
+	std::lock_guard<std::mutex> lock(list.Mutex);
+	list.Registries[d_serial] = this;
+}
+
+LatencyRegistry::~LatencyRegistry() {
+	Stop();
+	// waits for any exiting thread still returning its slots.
+	auto                       &list = Registries();
+	std::lock_guard<std::mutex> lock(list.Mutex);
+	list.Registries.erase(d_serial);
+}
+
+LatencyRegistry::Metric LatencyRegistry::Register(const std::string &name) {
+	std::lock_guard<std::mutex> lock(d_registerMutex);
+	for (const auto &m : d_metrics) {
+		if (m->Name == name) {
+			return Metric(this, m.get());
+		}
+	}
+	d_metrics.push_back(std::make_unique<MetricData>(name, d_metrics.size()));
+	return Metric(this, d_metrics.back().get());
+}
+
+LatencyRegistry::Slot *LatencyRegistry::LocalSlot(MetricData &metric) {
+	if (t_lastSerial != d_serial || t_last == nullptr) {
+		auto fi = t_slots.find(d_serial);
+		if (fi == t_slots.end()) {
+			EraseDeadSlots();
+			fi = t_slots.emplace(d_serial, std::vector<void *>()).first;
+		}
+		t_last       = &fi->second;
+		t_lastSerial = d_serial;
+	}
+	if (metric.Index < t_last->size() && (*t_last)[metric.Index] != nullptr) {
+		return static_cast<Slot *>((*t_last)[metric.Index]);
+	}
+
+	static thread_local ThreadExit exit;
+	(void)exit;
+
+	Slot *slot = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(d_collectMutex);
+		if (metric.Free.empty() == false) {
+			slot = metric.Free.back();
+			metric.Free.pop_back();
+		}
+	}
+	if (slot == nullptr) {
+		slot       = new Slot();
+		slot->Next = metric.Slots.load(std::memory_order_relaxed);
+		while (!metric.Slots.compare_exchange_weak(
+		    slot->Next,
+		    slot,
+		    std::memory_order_release,
+		    std::memory_order_relaxed
+		)) {
+		}
+	}
+	if (metric.Index >= t_last->size()) {
+		t_last->resize(metric.Index + 1, nullptr);
+	}
+	(*t_last)[metric.Index] = slot;
+	return slot;
+}
+
+void LatencyRegistry::ReleaseSlots(const std::vector<void *> &slots) {
+	std::vector<MetricData *> metrics;
+	{
+		std::lock_guard<std::mutex> lock(d_registerMutex);
+		for (const auto &m : d_metrics) {
+			metrics.push_back(m.get());
+		}
+	}
+
+	// under d_collectMutex, so a Collect() sees the counts either in
+	// the slot or in Exited, never in both.
+	std::lock_guard<std::mutex> lock(d_collectMutex);
+	for (size_t i = 0; i < slots.size(); ++i) {
+		if (slots[i] == nullptr) {
+			continue;
+		}
+		auto  slot   = static_cast<Slot *>(slots[i]);
+		auto &metric = *metrics[i];
+		metric.ExitedSum += slot->Sum.exchange(0, std::memory_order_relaxed);
+		for (size_t j = 0; j < DurationHistogram::BUCKETS; ++j) {
+			metric.Exited[j] +=
+			    slot->Counts[j].exchange(0, std::memory_order_relaxed);
+		}
+		metric.Free.push_back(slot);
+	}
+}
+
+LatencySnapshot LatencyRegistry::Collect() {
+	std::vector<MetricData *> metrics;
+	{
+		std::lock_guard<std::mutex> lock(d_registerMutex);
+		for (const auto &m : d_metrics) {
+			metrics.push_back(m.get());
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(d_collectMutex);
+
+	LatencySnapshot res;
+	res.Time = Time::Now();
+
+	std::vector<uint64_t> counts(DurationHistogram::BUCKETS);
+	for (auto m : metrics) {
+		std::copy(m->Exited.begin(), m->Exited.end(), counts.begin());
+		uint64_t sum = m->ExitedSum;
+		for (auto slot = m->Slots.load(std::memory_order_acquire);
+		     slot != nullptr;
+		     slot = slot->Next) {
+			sum += slot->Sum.load(std::memory_order_relaxed);
+			for (size_t i = 0; i < DurationHistogram::BUCKETS; ++i) {
+				counts[i] += slot->Counts[i].load(std::memory_order_relaxed);
+			}
+		}
+
+		auto &h = res.Metrics[m->Name];
+		for (size_t i = 0; i < DurationHistogram::BUCKETS; ++i) {
+			uint64_t delta = counts[i] - m->Previous[i];
+			if (delta == 0) {
+				continue;
+			}
+			if (h.d_count == 0) {
+				h.d_min = DurationHistogram::BucketLowerBound(i).Nanoseconds();
+			}
+			h.d_max = DurationHistogram::BucketUpperBound(i).Nanoseconds();
+			h.d_counts[i] = delta;
+			h.d_count += delta;
+		}
+		h.d_sum = sum - m->PreviousSum;
+
+		m->Previous.swap(counts);
+		m->PreviousSum = sum;
+	}
+
+	return res;
+}
+
+void LatencyRegistry::Start(
+    const Duration                              &interval,
+    std::function<void(const LatencySnapshot &)> onSnapshot
+) {
+	if (interval <= 0) {
+		throw std::invalid_argument("Collection interval must be positive");
+	}
+	std::lock_guard<std::mutex> lock(d_collectorMutex);
+	if (d_collector.joinable()) {
+		throw std::runtime_error("Collector is already running");
+	}
+	d_collectorStop = false;
+
+	d_collector = std::thread([this, interval, onSnapshot]() {
+		const std::chrono::nanoseconds period(interval.Nanoseconds());
+		auto next = std::chrono::steady_clock::now();
+
+		std::unique_lock<std::mutex> lock(d_collectorMutex);
+		for (;;) {
+			next += period;
+			if (d_collectorSignal.wait_until(lock, next, [this]() {
+				    return d_collectorStop;
+			    })) {
+				return;
+			}
+			lock.unlock();
+			onSnapshot(Collect());
+			lock.lock();
+		}
+	});
+}
+
+void LatencyRegistry::Stop() {
+	{
+		std::lock_guard<std::mutex> lock(d_collectorMutex);
+		if (d_collector.joinable() == false) {
+			return;
+		}
+		d_collectorStop = true;
+	}
+	d_collectorSignal.notify_all();
+	d_collector.join();
+}
+
+} // namespace fort
@@ -0,0 +1,201 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Histogram.hpp"
+
+namespace fort {
+
+/**
+ * An aggregated view of all metrics of a LatencyRegistry
+ */
+struct LatencySnapshot {
+	/**
+	 * The Time the snapshot was taken.
+	 */
+	fort::Time Time;
+	/**
+	 * The Duration recorded for each metric since the previous
+	 * snapshot, keyed by metric name.
+	 *
+	 * The registry only keeps bucket counts, so unlike a recorded
+	 * DurationHistogram, the DurationHistogram::Min() and
+	 * DurationHistogram::Max() of these histograms are the lower
+	 * bound of the first and the upper bound of the last non-empty
+	 * bucket, not the exact extreme values.
+	 */
+	std::map<std::string, DurationHistogram> Metrics;
+};
+
+/**
+ * A registry of named latency metrics recorded from many threads
+ *
+ * Each thread records its Duration samples in its own
+ * cache-line-aligned set of buckets, that no other thread ever
+ * writes. Recording therefore does not need any lock or atomic
+ * read-modify-write operation. A collector merges the buckets of all
+ * threads in a LatencySnapshot, either on demand with Collect() or
+ * periodically from a background thread started with Start(). The
+ * collector never blocks the recording threads.
+ *
+ * ```c++
+ * using namespace fort;
+ * LatencyRegistry registry;
+ * auto detection = registry.Register("detection");
+ * registry.Start(10 * Duration::Second, [](const LatencySnapshot & s) {
+ *     for ( const auto & [name,h] : s.Metrics ) {
+ *         std::cout << s.Time << " " << name << " p99: "
+ *                   << h.Percentile(99) << std::endl;
+ *     }
+ * });
+ *
+ * // from any thread
+ * detection.Record(Time::Now().Sub(start));
+ * ```
+ *
+ * Each recording thread allocates, once per metric it records to,
+ * about 58 KiB of buckets. When the thread exits, its counts are
+ * kept by the metric and its buckets are reused by the next thread
+ * recording to it. Values recorded concurrently to a Collect() may
+ * only appear in the next snapshot.
+ */
+class LatencyRegistry {
+	struct MetricData;
+
+public:
+	/**
+	 * A handle to record samples of a registered metric.
+	 *
+	 * A Metric is cheap to copy and can be shared among threads. It
+	 * must not outlive its LatencyRegistry.
+	 */
+	class Metric {
+	public:
+		/**
+		 * Records a sample for the calling thread
+		 *
+		 * @param d the Duration to record. Negative values are
+		 *        recorded as zero.
+		 */
+		void Record(const Duration &d) const;
+
+		/**
+		 * Gets the metric name
+		 *
+		 * @return the name used to register this metric.
+		 */
+		const std::string &Name() const;
+
+	private:
+		friend class LatencyRegistry;
+
+		Metric(LatencyRegistry *registry, MetricData *data);
+
+		LatencyRegistry *d_registry;
+		MetricData      *d_data;
+	};
+
+	/**
+	 * Default constructor, an empty registry.
+	 */
+	LatencyRegistry();
+
+	/**
+	 * Destructor, stops any running collector.
+	 */
+	~LatencyRegistry();
+
+	LatencyRegistry(const LatencyRegistry &)            = delete;
+	LatencyRegistry &operator=(const LatencyRegistry &) = delete;
+
+	/**
+	 * Registers or finds a metric
+	 *
+	 * @param name the name of the metric.
+	 *
+	 * @return a Metric to record samples. Calling it twice with the
+	 *         same name returns the same metric.
+	 */
+	Metric Register(const std::string &name);
+
+	/**
+	 * Merges all threads samples since the last call
+	 *
+	 * @return a LatencySnapshot with all samples recorded since the
+	 *         last call to Collect(), or since the registry creation.
+	 */
+	LatencySnapshot Collect();
+
+	/**
+	 * Starts a background collector
+	 *
+	 * @param interval the time between two collections
+	 * @param onSnapshot a callback called from the collector thread
+	 *        with every LatencySnapshot.
+	 *
+	 * @throws std::runtime_error if a collector is already running
+	 * @throws std::invalid_argument if interval is not positive.
+	 */
+	void Start(
+	    const Duration                               &interval,
+	    std::function<void(const LatencySnapshot &)> onSnapshot
+	);
+
+	/**
+	 * Stops the background collector, if any.
+	 *
+	 * No final LatencySnapshot is produced, Collect() can be used
+	 * for that purpose.
+	 */
+	void Stop();
+
+private:
+	struct Slot;
+	struct ThreadExit;
+
+	Slot *LocalSlot(MetricData &metric);
+
+	void ReleaseSlots(const std::vector<void *> &slots);
+
+	static std::atomic<uint64_t> s_nextSerial;
+
+	const uint64_t d_serial;
+
+	std::mutex                               d_registerMutex;
+	std::vector<std::unique_ptr<MetricData>> d_metrics;
+
+	std::mutex d_collectMutex;
+
+	std::mutex              d_collectorMutex;
+	std::condition_variable d_collectorSignal;
+	bool                    d_collectorStop;
+	std::thread             d_collector;
+};
+
+} // namespace fort
@@ -0,0 +1,168 @@
+#include "LatencyRegistry.hpp"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "LatencyRegistryUTest.hpp"
+
+namespace fort {
+
+TEST_F(LatencyRegistryUTest, RegisterIsIdempotent) {
+	LatencyRegistry registry;
+	auto            a = registry.Register("a");
+	auto            b = registry.Register("b");
+	EXPECT_EQ(a.Name(), "a");
+	EXPECT_EQ(b.Name(), "b");
+	a.Record(1 * Duration::Microsecond);
+	registry.Register("a").Record(2 * Duration::Microsecond);
+	auto snapshot = registry.Collect();
+	ASSERT_EQ(snapshot.Metrics.size(), 2);
+	EXPECT_EQ(snapshot.Metrics["a"].Count(), 2);
+	EXPECT_EQ(snapshot.Metrics["b"].Count(), 0);
+}
+
+TEST_F(LatencyRegistryUTest, MergesThreadsAndReportsIntervals) {
+	LatencyRegistry registry;
+	auto            camera    = registry.Register("camera");
+	auto            detection = registry.Register("detection");
+
+	const size_t             N = 10000;
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < 4; ++t) {
+		threads.push_back(std::thread([&, t]() {
+			for (size_t i = 0; i < N; ++i) {
+				camera.Record((t + 1) * Duration::Millisecond);
+				detection.Record(int64_t(i));
+			}
+		}));
+	}
+	for (auto &t : threads) {
+		t.join();
+	}
+
+	auto before   = Time::Now();
+	auto snapshot = registry.Collect();
+	EXPECT_FALSE(snapshot.Time.Before(before));
+
+	const auto &c = snapshot.Metrics["camera"];
+	EXPECT_EQ(c.Count(), 4 * N);
+	EXPECT_EQ(c.Mean(), 2500 * Duration::Microsecond);
+	EXPECT_LE(c.Min(), 1 * Duration::Millisecond);
+	EXPECT_GE(c.Max(), 4 * Duration::Millisecond);
+	EXPECT_LE(
+	    c.Percentile(50).Nanoseconds(),
+	    2 * Duration::Millisecond.Nanoseconds() * 1.01
+	);
+	EXPECT_EQ(snapshot.Metrics["detection"].Count(), 4 * N);
+
+	// next snapshot only reports new samples
+	camera.Record(10 * Duration::Millisecond);
+	snapshot = registry.Collect();
+	EXPECT_EQ(snapshot.Metrics["camera"].Count(), 1);
+	EXPECT_EQ(snapshot.Metrics["camera"].Mean(), 10 * Duration::Millisecond);
+	EXPECT_EQ(snapshot.Metrics["detection"].Count(), 0);
+}
+
+TEST_F(LatencyRegistryUTest, PeriodicCollection) {
+	LatencyRegistry registry;
+	auto            metric = registry.Register("writer");
+
+	EXPECT_THROW(
+	    registry.Start(0, [](const LatencySnapshot &) {}),
+	    std::invalid_argument
+	);
+
+	std::mutex                   mutex;
+	std::condition_variable      cond;
+	std::vector<LatencySnapshot> snapshots;
+	registry.Start(Duration::Millisecond, [&](const LatencySnapshot &s) {
+		std::lock_guard<std::mutex> lock(mutex);
+		snapshots.push_back(s);
+		cond.notify_all();
+	});
+	EXPECT_THROW(
+	    registry.Start(Duration::Millisecond, [](const LatencySnapshot &) {}),
+	    std::runtime_error
+	);
+
+	metric.Record(Duration::Microsecond);
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		cond.wait(lock, [&]() { return snapshots.size() >= 3; });
+	}
+	registry.Stop();
+
+	uint64_t total = 0;
+	for (size_t i = 0; i < snapshots.size(); ++i) {
+		total += snapshots[i].Metrics["writer"].Count();
+		if (i > 0) {
+			EXPECT_TRUE(snapshots[i - 1].Time.Before(snapshots[i].Time));
+		}
+	}
+	total += registry.Collect().Metrics["writer"].Count();
+	EXPECT_EQ(total, 1);
+}
+
+TEST_F(LatencyRegistryUTest, KeepsCountsOfExitedThreads) {
+	LatencyRegistry registry;
+	auto            metric = registry.Register("worker");
+
+	std::thread([&]() { metric.Record(Duration::Millisecond); }).join();
+	auto snapshot = registry.Collect();
+	EXPECT_EQ(snapshot.Metrics["worker"].Count(), 1);
+	EXPECT_EQ(snapshot.Metrics["worker"].Mean(), Duration::Millisecond);
+
+	// the reused buckets of the first thread do not count twice
+	std::thread([&]() {
+		metric.Record(2 * Duration::Millisecond);
+		metric.Record(2 * Duration::Millisecond);
+	}).join();
+	std::thread([&]() { metric.Record(2 * Duration::Millisecond); }).join();
+	snapshot = registry.Collect();
+	EXPECT_EQ(snapshot.Metrics["worker"].Count(), 3);
+	EXPECT_EQ(snapshot.Metrics["worker"].Mean(), 2 * Duration::Millisecond);
+	EXPECT_EQ(registry.Collect().Metrics["worker"].Count(), 0);
+
+	// a thread may exit after the registries it recorded to
+	std::mutex              mutex;
+	std::condition_variable cond;
+	bool                    recorded = false, destroyed = false;
+	std::thread             outliving;
+	{
+		LatencyRegistry shortLived;
+		auto            m = shortLived.Register("short");
+		outliving = std::thread([&, m]() {
+			m.Record(Duration::Millisecond);
+			std::unique_lock<std::mutex> lock(mutex);
+			recorded = true;
+			cond.notify_all();
+			cond.wait(lock, [&]() { return destroyed; });
+		});
+		std::unique_lock<std::mutex> lock(mutex);
+		cond.wait(lock, [&]() { return recorded; });
+		EXPECT_EQ(shortLived.Collect().Metrics["short"].Count(), 1);
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		destroyed = true;
+		cond.notify_all();
+	}
+	outliving.join();
+}
+
+TEST_F(LatencyRegistryUTest, RecordsToSuccessiveRegistries) {
+	LatencyRegistry registry;
+	auto            metric = registry.Register("long");
+	// the slots of the destroyed registries are dropped, and do not
+	// mix with the ones of the next registries.
+	for (size_t i = 0; i < 1000; ++i) {
+		LatencyRegistry shortLived;
+		shortLived.Register("short").Record(Duration::Millisecond);
+		metric.Record(Duration::Microsecond);
+		EXPECT_EQ(shortLived.Collect().Metrics["short"].Count(), 1);
+	}
+	EXPECT_EQ(registry.Collect().Metrics["long"].Count(), 1000);
+}
+
+} // namespace fort
@@ -0,0 +1,271 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#include "LeapSeconds.hpp"
+
+namespace fort {
+
+namespace {
+
+// Seconds from the NTP epoch, 1900-01-01, to the Unix epoch.
+const int64_t NTP_TO_UNIX = 2208988800LL;
+
+const int64_t MIN_SECOND = std::numeric_limits<int64_t>::min();
+const int64_t MAX_SECOND = std::numeric_limits<int64_t>::max();
+
+} // namespace
+
+LeapSecondTable::LeapSecondTable(
+    const std::vector<LeapSecond> &entries, const Time &expires
+)
+    : d_entries(entries)
+    , d_expires(expires)
+    , d_lastUTC(0)
+    , d_lastTAI(0) {
+	if (entries.empty()) {
+		throw std::invalid_argument("LeapSecondTable needs at least one entry");
+	}
+	// SinceEver() is outside of the first interval, and Forever() of
+	// the last one.
+	d_utcStarts.push_back(MIN_SECOND + 1);
+	d_taiStarts.push_back(MIN_SECOND + 1);
+	d_offsets.push_back(entries.front().Offset);
+	for (size_t i = 1; i < entries.size(); ++i) {
+		const auto &e = entries[i];
+		if (e.Start <= entries[i - 1].Start) {
+			throw std::invalid_argument(
+			    "LeapSecondTable entries must be sorted by Start"
+			);
+		}
+		d_utcStarts.push_back(e.Start);
+		// an inserted leap second belongs to the new interval, a
+		// removed one to none.
+		d_taiStarts.push_back(e.Start + std::min(d_offsets.back(), e.Offset));
+		d_offsets.push_back(e.Offset);
+	}
+	d_utcStarts.push_back(MAX_SECOND);
+	d_taiStarts.push_back(MAX_SECOND);
+}
+
+LeapSecondTable::LeapSecondTable(const LeapSecondTable &other)
+    : d_entries(other.d_entries)
+    , d_utcStarts(other.d_utcStarts)
+    , d_taiStarts(other.d_taiStarts)
+    , d_offsets(other.d_offsets)
+    , d_expires(other.d_expires)
+    , d_lastUTC(0)
+    , d_lastTAI(0) {}
+
+const LeapSecondTable &LeapSecondTable::Embedded() {
+	// from /usr/share/zoneinfo/leap-seconds.list, in NTP seconds.
+	static LeapSecondTable table = []() {
+		const static int64_t ntpStarts[] = {
+		    2272060800, 2287785600, 2303683200, 2335219200, 2366755200,
+		    2398291200, 2429913600, 2461449600, 2492985600, 2524521600,
+		    2571782400, 2603318400, 2634854400, 2698012800, 2776982400,
+		    2840140800, 2871676800, 2918937600, 2950473600, 2982009600,
+		    3029443200, 3076704000, 3124137600, 3345062400, 3439756800,
+		    3550089600, 3644697600, 3692217600,
+		};
+		std::vector<LeapSecond> entries;
+		int32_t                 offset = 10;
+		for (auto s : ntpStarts) {
+			entries.push_back({s - NTP_TO_UNIX, offset++});
+		}
+		return LeapSecondTable(
+		    entries,
+		    Time::FromUnix(3991593600LL - NTP_TO_UNIX, 0)
+		);
+	}();
+	return table;
+}
+
+LeapSecondTable LeapSecondTable::Parse(std::istream &in) {
+	std::vector<LeapSecond> entries;
+	Time                    expires = Time::Forever();
+	std::string             line;
+	for (size_t lineNumber = 1; std::getline(in, line); ++lineNumber) {
+		std::istringstream iss(line);
+		if (line.rfind("#@", 0) == 0) {
+			int64_t ntp;
+			iss.ignore(2);
+			if (!(iss >> ntp)) {
+				throw std::runtime_error(
+				    "invalid expiration on line " + std::to_string(lineNumber)
+				);
+			}
+			expires = Time::FromUnix(ntp - NTP_TO_UNIX, 0);
+			continue;
+		}
+		if (line.empty() || line[0] == '#') {
+			continue;
+		}
+		int64_t ntp;
+		int32_t offset;
+		if (!(iss >> ntp >> offset)) {
+			throw std::runtime_error(
+			    "invalid leap second on line " + std::to_string(lineNumber) +
+			    ": '" + line + "'"
+			);
+		}
+		entries.push_back({ntp - NTP_TO_UNIX, offset});
+	}
+	try {
+		return LeapSecondTable(entries, expires);
+	} catch (const std::invalid_argument &e) {
+		throw std::runtime_error(e.what());
+	}
+}
+
+LeapSecondTable LeapSecondTable::Load(const std::string &path) {
+	std::ifstream file(path);
+	if (file.is_open() == false) {
+		throw std::runtime_error("could not open '" + path + "'");
+	}
+	return Parse(file);
+}
+
+size_t LeapSecondTable::Find(
+    const std::vector<int64_t> &starts, int64_t second, size_t hint
+) {
+	if (starts[hint] <= second && second < starts[hint + 1]) {
+		return hint;
+	}
+	// only the inner bounds are searched, so the first and last
+	// intervals are unbounded.
+	return std::upper_bound(starts.begin() + 1, starts.end() - 1, second) -
+	       starts.begin() - 1;
+}
+
+Time LeapSecondTable::Shift(const Time &t, int64_t seconds) {
+	auto raw = details::ToRawTime(t);
+	raw.WallSec += seconds;
+	return details::FromRawTime(raw);
+}
+
+int32_t LeapSecondTable::Offset(const Time &utc) const {
+	size_t i = Find(
+	    d_utcStarts,
+	    details::ToRawTime(utc).WallSec,
+	    d_lastUTC.load(std::memory_order_relaxed)
+	);
+	d_lastUTC.store(i, std::memory_order_relaxed);
+	return d_offsets[i];
+}
+
+Time LeapSecondTable::ToTAI(const Time &utc) const {
+	if (utc.IsInfinite()) {
+		return utc;
+	}
+	return Shift(utc, Offset(utc));
+}
+
+Time LeapSecondTable::ToUTC(const Time &tai) const {
+	if (tai.IsInfinite()) {
+		return tai;
+	}
+	size_t i = Find(
+	    d_taiStarts,
+	    details::ToRawTime(tai).WallSec,
+	    d_lastTAI.load(std::memory_order_relaxed)
+	);
+	d_lastTAI.store(i, std::memory_order_relaxed);
+	return Shift(tai, -d_offsets[i]);
+}
+
+template <bool toTAI> void LeapSecondTable::Convert(Time *times, size_t n) const {
+	const auto &starts = toTAI ? d_utcStarts : d_taiStarts;
+	auto       &last   = toTAI ? d_lastUTC : d_lastTAI;
+	size_t      i      = last.load(std::memory_order_relaxed);
+	// bounds of the current interval, the infinite Time are outside
+	// of all of them.
+	int64_t low = starts[i], high = starts[i + 1];
+	int64_t offset = toTAI ? d_offsets[i] : -d_offsets[i];
+	for (size_t j = 0; j < n; ++j) {
+		auto     raw = details::ToRawTime(times[j]);
+		int64_t &sec = raw.WallSec;
+		if (__builtin_expect(sec < low || sec >= high, 0)) {
+			if (sec == MIN_SECOND || sec == MAX_SECOND) {
+				continue;
+			}
+			i      = Find(starts, sec, i);
+			low    = starts[i];
+			high   = starts[i + 1];
+			offset = toTAI ? d_offsets[i] : -d_offsets[i];
+		}
+		sec += offset;
+		times[j] = details::FromRawTime(raw);
+	}
+	last.store(i, std::memory_order_relaxed);
+}
+
+void LeapSecondTable::ToTAI(Time *times, size_t n) const {
+	Convert<true>(times, n);
+}
+
+void LeapSecondTable::ToTAI(std::vector<Time> &times) const {
+	Convert<true>(times.data(), times.size());
+}
+
+void LeapSecondTable::ToUTC(Time *times, size_t n) const {
+	Convert<false>(times, n);
+}
+
+void LeapSecondTable::ToUTC(std::vector<Time> &times) const {
+	Convert<false>(times.data(), times.size());
+}
+
+Duration LeapSecondTable::Sub(const Time &a, const Time &b) const {
+	Duration res = a.Sub(b);
+	if (a.HasMono() && b.HasMono() && a.MonoID() == b.MonoID()) {
+		return res;
+	}
+	int64_t aSec = details::ToRawTime(a).WallSec;
+	int64_t bSec = details::ToRawTime(b).WallSec;
+	// most differences do not span a leap second.
+	size_t i = d_lastUTC.load(std::memory_order_relaxed);
+	size_t j = i;
+	if (aSec < d_utcStarts[i] || aSec >= d_utcStarts[i + 1]) {
+		i = Find(d_utcStarts, aSec, i);
+		d_lastUTC.store(i, std::memory_order_relaxed);
+	}
+	if (bSec < d_utcStarts[j] || bSec >= d_utcStarts[j + 1]) {
+		j = Find(d_utcStarts, bSec, i);
+	}
+	if (i == j) {
+		return res;
+	}
+	int64_t leap = int64_t(d_offsets[i] - d_offsets[j]) * 1000000000LL;
+	int64_t ns;
+	if (__builtin_add_overflow(res.Nanoseconds(), leap, &ns)) {
+		throw Time::Overflow("duration");
+	}
+	return ns;
+}
+
+Time LeapSecondTable::Add(const Time &t, const Duration &d) const {
+	return ToUTC(ToTAI(t).Add(d));
+}
+
+} // namespace fort
@@ -0,0 +1,252 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "Time.hpp"
+
+namespace fort {
+
+/**
+ * A change of the TAI - UTC offset
+ */
+struct LeapSecond {
+	/**
+	 * The UTC Unix time, in seconds, the offset applies from. It is
+	 * midnight right after the leap second.
+	 */
+	int64_t Start;
+	/**
+	 * TAI - UTC in seconds from Start.
+	 */
+	int32_t Offset;
+};
+
+/**
+ * A leap second table converting between UTC and TAI
+ *
+ * Time wall values are UTC, as read by Time::Now(), in which leap
+ * seconds are not counted: a wall difference across a leap second is
+ * one second short. A LeapSecondTable converts them to TAI, which has
+ * no leap second, and computes exact elapsed times with Sub().
+ *
+ * The Embedded() table is compiled in. As leap seconds are announced
+ * six months in advance, an up to date table can be loaded from the
+ * IERS `leap-seconds.list`, shipped by most systems in
+ * `/usr/share/zoneinfo`:
+ *
+ * ```c++
+ * using namespace fort;
+ * auto table = LeapSecondTable::Load("/usr/share/zoneinfo/leap-seconds.list");
+ * Duration elapsed = table.Sub(end, start);
+ * table.ToTAI(frames);
+ * ```
+ *
+ * Lookups first check the interval of the previous lookup, so
+ * converting sorted Time costs two comparisons per Time. Before the
+ * first entry, its offset is used.
+ *
+ * During an inserted leap second, Unix time repeats the last second of
+ * the day. Therefore ToUTC() maps the TAI leap second on that second,
+ * and converting it back with ToTAI() is one second early.
+ *
+ * Infinite Time are left unchanged. Monotonic values are kept as is.
+ */
+class LeapSecondTable {
+public:
+	/**
+	 * Constructor
+	 *
+	 * @param entries the LeapSecond of the table
+	 * @param expires the Time until which the table is known to be
+	 *        valid
+	 *
+	 * @throws std::invalid_argument if entries is empty or not sorted
+	 *         by LeapSecond::Start.
+	 */
+	LeapSecondTable(
+	    const std::vector<LeapSecond> &entries,
+	    const Time                    &expires = Time::Forever()
+	);
+
+	/**
+	 * Copy constructor
+	 *
+	 * @param other the LeapSecondTable to copy
+	 */
+	LeapSecondTable(const LeapSecondTable &other);
+
+	/**
+	 * Gets the compiled in table
+	 *
+	 * @return the leap seconds up to 2017-01-01, with the IERS
+	 *         Bulletin C expiration of 2026-06-28.
+	 */
+	static const LeapSecondTable &Embedded();
+
+	/**
+	 * Parses a leap-seconds.list file
+	 *
+	 * @param in the stream to read the file from
+	 *
+	 * @return the LeapSecondTable of the file
+	 *
+	 * @throws std::runtime_error if the file is malformed.
+	 */
+	static LeapSecondTable Parse(std::istream &in);
+
+	/**
+	 * Loads a leap-seconds.list file
+	 *
+	 * @param path the path to the file
+	 *
+	 * @return the LeapSecondTable of the file
+	 *
+	 * @throws std::runtime_error if the file cannot be read or is
+	 *         malformed.
+	 */
+	static LeapSecondTable Load(const std::string &path);
+
+	/**
+	 * Gets the entries of the table
+	 *
+	 * @return the LeapSecond of the table, sorted.
+	 */
+	inline const std::vector<LeapSecond> &Entries() const {
+		return d_entries;
+	}
+
+	/**
+	 * Gets the expiration of the table
+	 *
+	 * @return the Time until which the table is known to be valid
+	 */
+	inline const Time &Expires() const {
+		return d_expires;
+	}
+
+	/**
+	 * Gets TAI - UTC at a Time
+	 *
+	 * @param utc a UTC Time
+	 *
+	 * @return the number of seconds TAI is ahead of UTC at utc.
+	 */
+	int32_t Offset(const Time &utc) const;
+
+	/**
+	 * Converts a UTC Time to TAI
+	 *
+	 * @param utc the UTC Time to convert
+	 *
+	 * @return utc, with its wall value in TAI.
+	 */
+	Time ToTAI(const Time &utc) const;
+
+	/**
+	 * Converts a TAI Time to UTC
+	 *
+	 * @param tai the TAI Time to convert
+	 *
+	 * @return tai, with its wall value in UTC.
+	 */
+	Time ToUTC(const Time &tai) const;
+
+	/**
+	 * Converts UTC Time to TAI in place
+	 *
+	 * @param times the first Time to convert
+	 * @param n the number of Time to convert
+	 */
+	void ToTAI(Time *times, size_t n) const;
+
+	/**
+	 * Converts UTC Time to TAI in place
+	 *
+	 * @param times the Time to convert
+	 */
+	void ToTAI(std::vector<Time> &times) const;
+
+	/**
+	 * Converts TAI Time to UTC in place
+	 *
+	 * @param times the first Time to convert
+	 * @param n the number of Time to convert
+	 */
+	void ToUTC(Time *times, size_t n) const;
+
+	/**
+	 * Converts TAI Time to UTC in place
+	 *
+	 * @param times the Time to convert
+	 */
+	void ToUTC(std::vector<Time> &times) const;
+
+	/**
+	 * Computes the exact time elapsed between two UTC Time
+	 *
+	 * @param a a UTC Time
+	 * @param b the UTC Time to subtract to a
+	 *
+	 * @return `a - b`, counting the leap seconds in between. As
+	 *         Time::Sub(), the monotonic values are used if both Time
+	 *         share a monotonic clock.
+	 *
+	 * @throws Time::Overflow if the difference is not representable.
+	 */
+	Duration Sub(const Time &a, const Time &b) const;
+
+	/**
+	 * Adds an exact Duration to a UTC Time
+	 *
+	 * @param t a UTC Time
+	 * @param d the Duration to add
+	 *
+	 * @return the UTC Time d after t, counting the leap seconds in
+	 *         between.
+	 *
+	 * @throws Time::Overflow if the result is not representable.
+	 */
+	Time Add(const Time &t, const Duration &d) const;
+
+private:
+	// Finds the interval of a second in starts, from a hint.
+	static size_t
+	Find(const std::vector<int64_t> &starts, int64_t second, size_t hint);
+
+	static Time Shift(const Time &t, int64_t seconds);
+
+	template <bool toTAI> void Convert(Time *times, size_t n) const;
+
+	std::vector<LeapSecond> d_entries;
+	// Interval i spans [starts[i],starts[i+1]).
+	std::vector<int64_t> d_utcStarts, d_taiStarts;
+	std::vector<int32_t> d_offsets;
+	Time                 d_expires;
+
+	// Interval of the last lookups.
+	mutable std::atomic<size_t> d_lastUTC, d_lastTAI;
+};
+
+} // namespace fort
@@ -0,0 +1,133 @@
+#include "LeapSeconds.hpp"
+
+#include <fstream>
+#include <random>
+#include <sstream>
+
+#include "LeapSecondsUTest.hpp"
+
+namespace fort {
+
+TEST_F(LeapSecondsUTest, EmbeddedTable) {
+	const auto &table = LeapSecondTable::Embedded();
+	ASSERT_EQ(table.Entries().size(), 28);
+	EXPECT_EQ(table.Entries().front().Start, 63072000);
+	EXPECT_EQ(table.Entries().back().Offset, 37);
+	EXPECT_TRUE(table.Expires().Equals(Time::Parse("2026-06-28T00:00:00Z")));
+
+	EXPECT_EQ(table.Offset(Time::Parse("1960-01-01T00:00:00Z")), 10);
+	EXPECT_EQ(table.Offset(Time::Parse("1972-06-30T23:59:59Z")), 10);
+	EXPECT_EQ(table.Offset(Time::Parse("1972-07-01T00:00:00Z")), 11);
+	EXPECT_EQ(table.Offset(Time::Parse("2000-01-01T00:00:00Z")), 32);
+	EXPECT_EQ(table.Offset(Time::Parse("2016-12-31T23:59:59.999Z")), 36);
+	EXPECT_EQ(table.Offset(Time::Parse("2017-01-01T00:00:00Z")), 37);
+	EXPECT_EQ(table.Offset(Time::Parse("2100-01-01T00:00:00Z")), 37);
+	EXPECT_EQ(table.Offset(Time::SinceEver()), 10);
+	EXPECT_EQ(table.Offset(Time::Forever()), 37);
+
+	auto path = "/usr/share/zoneinfo/leap-seconds.list";
+	if (std::ifstream(path).is_open() == false) {
+		return;
+	}
+	auto system = LeapSecondTable::Load(path);
+	// the system table may be more recent
+	ASSERT_GE(system.Entries().size(), table.Entries().size());
+	for (size_t i = 0; i < table.Entries().size(); ++i) {
+		EXPECT_EQ(system.Entries()[i].Start, table.Entries()[i].Start);
+		EXPECT_EQ(system.Entries()[i].Offset, table.Entries()[i].Offset);
+	}
+}
+
+TEST_F(LeapSecondsUTest, CountsLeapSeconds) {
+	const auto &table  = LeapSecondTable::Embedded();
+	auto        before = Time::Parse("2016-12-31T23:59:59Z");
+	auto        after  = Time::Parse("2017-01-01T00:00:00Z");
+	EXPECT_EQ(after.Sub(before), Duration::Second);
+	EXPECT_EQ(table.Sub(after, before), 2 * Duration::Second);
+	EXPECT_EQ(table.Sub(before, after), -2 * Duration::Second);
+	EXPECT_TRUE(table.Add(before, 2 * Duration::Second).Equals(after));
+	EXPECT_TRUE(table.Add(after, -2 * Duration::Second).Equals(before));
+
+	auto start = Time::Parse("1972-01-01T00:00:00Z");
+	auto end   = Time::Parse("2020-01-01T00:00:00Z");
+	EXPECT_EQ(table.Sub(end, start), end.Sub(start) + 27 * Duration::Second);
+
+	// a shared monotonic clock is already exact
+	auto monoBefore =
+	    Time::FromTimestampAndMonotonic(before.ToTimestamp(), 1000, 1);
+	auto monoAfter =
+	    Time::FromTimestampAndMonotonic(after.ToTimestamp(), 1500, 1);
+	EXPECT_EQ(table.Sub(monoAfter, monoBefore), Duration(500));
+}
+
+TEST_F(LeapSecondsUTest, ConvertsToTAI) {
+	const auto &table = LeapSecondTable::Embedded();
+	auto        utc   = Time::Parse("2016-12-31T23:59:59.5Z");
+	auto        tai   = table.ToTAI(utc);
+	EXPECT_TRUE(tai.Equals(Time::Parse("2017-01-01T00:00:35.5Z")));
+	EXPECT_TRUE(table.ToUTC(tai).Equals(utc));
+	// the TAI leap second is the repeated last UTC second
+	EXPECT_TRUE(table.ToUTC(Time::Parse("2017-01-01T00:00:36.5Z")).Equals(utc));
+	EXPECT_TRUE(table.ToUTC(Time::Parse("2017-01-01T00:00:37Z"))
+	                .Equals(Time::Parse("2017-01-01T00:00:00Z")));
+
+	auto frame = Time::FromTimestampAndMonotonic(utc.ToTimestamp(), 42, 3);
+	auto converted = table.ToTAI(frame);
+	EXPECT_EQ(converted.MonoID(), 3);
+	EXPECT_EQ(converted.MonotonicValue(), 42);
+	EXPECT_TRUE(table.ToTAI(Time::Forever()).IsForever());
+	EXPECT_TRUE(table.ToUTC(Time::SinceEver()).IsSinceEver());
+}
+
+TEST_F(LeapSecondsUTest, ConvertsSpans) {
+	LeapSecondTable table(LeapSecondTable::Embedded());
+	std::mt19937    rng(42);
+	std::vector<Time> times;
+	for (size_t i = 0; i < 10000; ++i) {
+		times.push_back(Time::FromUnix(int64_t(rng() % 2000000000ULL), rng() % 1000000000));
+	}
+	times.push_back(Time::Forever());
+	times.push_back(Time::SinceEver());
+	std::sort(times.begin(), times.begin() + 5000, [](const Time &a, const Time &b) {
+		return a.Before(b);
+	});
+
+	auto tai = times;
+	table.ToTAI(tai);
+	for (size_t i = 0; i < times.size(); ++i) {
+		ASSERT_TRUE(tai[i].Equals(table.ToTAI(times[i]))) << i;
+	}
+	auto utc = tai;
+	table.ToUTC(utc);
+	for (size_t i = 0; i < times.size(); ++i) {
+		ASSERT_TRUE(utc[i].Equals(table.ToUTC(tai[i]))) << i;
+	}
+}
+
+TEST_F(LeapSecondsUTest, ParsesLeapSecondsList) {
+	std::istringstream in(
+	    "#\tsome comment\n"
+	    "#$\t 3676924800\n"
+	    "#@\t3786480000\n"
+	    "2272060800\t10\t# 1 Jan 1972\n"
+	    "\n"
+	    "2287785600\t11\t# 1 Jul 1972\n"
+	    "#h\t16edd0f0 3666784f 37db6bdd e74ced87 59af48f1\n"
+	);
+	auto table = LeapSecondTable::Parse(in);
+	ASSERT_EQ(table.Entries().size(), 2);
+	EXPECT_EQ(table.Entries()[1].Start, 78796800);
+	EXPECT_EQ(table.Entries()[1].Offset, 11);
+	EXPECT_TRUE(table.Expires().Equals(Time::Parse("2019-12-28T00:00:00Z")));
+
+	std::istringstream unsorted("2287785600 11\n2272060800 10\n");
+	EXPECT_THROW(LeapSecondTable::Parse(unsorted), std::runtime_error);
+	std::istringstream malformed("2272060800 ten\n");
+	EXPECT_THROW(LeapSecondTable::Parse(malformed), std::runtime_error);
+	std::istringstream empty("# nothing\n");
+	EXPECT_THROW(LeapSecondTable::Parse(empty), std::runtime_error);
+	EXPECT_THROW(LeapSecondTable::Load("/does/not/exist"), std::runtime_error);
+	EXPECT_THROW(LeapSecondTable({}), std::invalid_argument);
+}
+
+} // namespace fort
@@ -0,0 +1,263 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "Time.hpp"
+
+namespace fort {
+
+/**
+ * The default key function of a TimeMerge, for sources of Time.
+ */
+struct TimeIdentity {
+	inline const Time &operator()(const Time &t) const {
+		return t;
+	}
+};
+
+/**
+ * Streaming k-way merge of sorted Time sources
+ *
+ * Interleaves k sources, each sorted by Time, into a single sequence
+ * sorted by Time. Items are compared with Time::Before(), so Time of
+ * sources sharing a MonoclockID are ordered by their monotonic value,
+ * and otherwise by their wall value.
+ *
+ * Only the head of each source is held: sources can be input
+ * iterators streaming from files. The key of each head is extracted
+ * once and cached, and a loser tree finds the next item in
+ * `log2(k)` comparisons. Items with equal Time are yielded in the
+ * order of their source.
+ *
+ * ```c++
+ * using namespace fort;
+ * std::vector<std::vector<Frame>> cameras = LoadFrames();
+ * std::vector<std::pair<Iter, Iter>> sources;
+ * for (const auto & c : cameras) {
+ *     sources.push_back({c.begin(), c.end()});
+ * }
+ * TimeMerge merge(sources, [](const Frame & f) { return f.Time; });
+ * for (; merge.Done() == false; merge.Next()) {
+ *     Process(merge.Top(), merge.Source());
+ * }
+ * ```
+ *
+ * @tparam Iterator the input iterator type of the sources
+ * @tparam KeyFunction a callable returning the Time of an item.
+ */
+template <typename Iterator, typename KeyFunction = TimeIdentity>
+class TimeMerge {
+public:
+	/**
+	 * The type of the merged items.
+	 */
+	typedef typename std::iterator_traits<Iterator>::value_type value_type;
+
+	/**
+	 * Constructor
+	 *
+	 * @param sources the `[begin,end)` ranges to merge. Each of them
+	 *        must be sorted by Time.
+	 * @param key the key function extracting the Time of an item
+	 */
+	TimeMerge(
+	    const std::vector<std::pair<Iterator, Iterator>> &sources,
+	    KeyFunction                                       key = KeyFunction()
+	)
+	    : d_sources(sources)
+	    , d_key(std::move(key))
+	    , d_heads(sources.size())
+	    , d_tree(sources.size() == 0 ? 1 : sources.size(), 0)
+	    , d_remaining(0) {
+		for (size_t i = 0; i < d_sources.size(); ++i) {
+			Load(i);
+		}
+		Build();
+	}
+
+	/**
+	 * Tests if all sources are exhausted.
+	 *
+	 * @return `true` if there is no more item.
+	 */
+	inline bool Done() const {
+		return d_remaining == 0;
+	}
+
+	/**
+	 * Gets the current item
+	 *
+	 * @return the item with the smallest Time among all source heads.
+	 *
+	 * @throws std::out_of_range if Done().
+	 */
+	inline const value_type &Top() const {
+		CheckNotDone();
+		return *d_sources[d_tree[0]].first;
+	}
+
+	/**
+	 * Gets the Time of the current item
+	 *
+	 * @return the Time of Top().
+	 *
+	 * @throws std::out_of_range if Done().
+	 */
+	inline const Time &TopTime() const {
+		CheckNotDone();
+		return d_heads[d_tree[0]].Key;
+	}
+
+	/**
+	 * Gets the source of the current item
+	 *
+	 * @return the index of the source of Top().
+	 *
+	 * @throws std::out_of_range if Done().
+	 */
+	inline size_t Source() const {
+		CheckNotDone();
+		return d_tree[0];
+	}
+
+	/**
+	 * Moves to the next item
+	 *
+	 * @throws std::out_of_range if Done().
+	 */
+	void Next() {
+		CheckNotDone();
+		size_t winner = d_tree[0];
+		++d_sources[winner].first;
+		Load(winner);
+		Replay(winner);
+	}
+
+	/**
+	 * Merges all remaining items
+	 *
+	 * @param output the output iterator receiving the items.
+	 *
+	 * @return output after the last written item.
+	 */
+	template <typename OutputIterator>
+	OutputIterator Drain(OutputIterator output) {
+		for (; Done() == false; Next()) {
+			*output++ = Top();
+		}
+		return output;
+	}
+
+private:
+	inline void CheckNotDone() const {
+		if (Done()) {
+			throw std::out_of_range("TimeMerge: all sources are exhausted");
+		}
+	}
+
+	inline bool Exhausted(size_t i) const {
+		return d_heads[i].Exhausted;
+	}
+
+	void Load(size_t i) {
+		auto &head     = d_heads[i];
+		head.Exhausted = d_sources[i].first == d_sources[i].second;
+		if (head.Exhausted == false) {
+			head.Key = d_key(*d_sources[i].first);
+		}
+	}
+
+	// Strict ordering of the source heads, exhausted sources last and
+	// ties broken by source index.
+	inline bool Less(size_t a, size_t b) const {
+		if (Exhausted(a)) {
+			return false;
+		}
+		if (Exhausted(b)) {
+			return true;
+		}
+		// a single Time comparison is needed, as ties go to the
+		// smallest index.
+		if (a < b) {
+			return d_heads[b].Key.Before(d_heads[a].Key) == false;
+		}
+		return d_heads[a].Key.Before(d_heads[b].Key);
+	}
+
+	void Build() {
+		size_t k    = d_sources.size();
+		d_remaining = 0;
+		for (size_t i = 0; i < k; ++i) {
+			d_remaining += Exhausted(i) ? 0 : 1;
+		}
+		if (k <= 1) {
+			d_tree[0] = 0;
+			return;
+		}
+		// winners[n] of the sub-tree of node n, leaves are at [k,2k).
+		std::vector<size_t> winners(2 * k);
+		for (size_t i = 0; i < k; ++i) {
+			winners[k + i] = i;
+		}
+		for (size_t n = k - 1; n > 0; --n) {
+			size_t a = winners[2 * n], b = winners[2 * n + 1];
+			if (Less(a, b)) {
+				winners[n] = a;
+				d_tree[n]  = b;
+			} else {
+				winners[n] = b;
+				d_tree[n]  = a;
+			}
+		}
+		d_tree[0] = winners[1];
+	}
+
+	void Replay(size_t source) {
+		if (Exhausted(source)) {
+			--d_remaining;
+		}
+		size_t winner = source;
+		for (size_t n = (source + d_sources.size()) / 2; n > 0; n /= 2) {
+			if (Less(d_tree[n], winner)) {
+				std::swap(d_tree[n], winner);
+			}
+		}
+		d_tree[0] = winner;
+	}
+
+	// the cached key of each source head, packed for locality.
+	struct Head {
+		Time Key;
+		bool Exhausted = true;
+	};
+
+	std::vector<std::pair<Iterator, Iterator>> d_sources;
+	KeyFunction                                d_key;
+	std::vector<Head>                          d_heads;
+	// d_tree[0] is the winner, d_tree[n] the loser of node n.
+	std::vector<size_t> d_tree;
+	size_t              d_remaining;
+};
+
+} // namespace fort
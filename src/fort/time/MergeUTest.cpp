@@ -0,0 +1,118 @@
+#include "Merge.hpp"
+
+#include <algorithm>
+#include <random>
+
+#include "MergeUTest.hpp"
+
+namespace fort {
+
+typedef std::vector<Time>::const_iterator TimeIterator;
+
+static std::vector<std::pair<TimeIterator, TimeIterator>>
+Ranges(const std::vector<std::vector<Time>> &sources) {
+	std::vector<std::pair<TimeIterator, TimeIterator>> res;
+	for (const auto &s : sources) {
+		res.push_back({s.begin(), s.end()});
+	}
+	return res;
+}
+
+TEST_F(MergeUTest, MergesSortedSources) {
+	std::mt19937                   rng(42);
+	auto                           start = Time::Now();
+	std::vector<std::vector<Time>> sources(7);
+	size_t                         total = 0;
+	for (size_t i = 0; i < sources.size(); ++i) {
+		// each source has its own MonoclockID, and an empty one
+		int64_t t = 0;
+		for (size_t j = 0; j < (i == 3 ? 0 : 50 + i); ++j) {
+			t += rng() % 1000000;
+			sources[i].push_back(Time::FromTimestampAndMonotonic(
+			    start.Add(t).ToTimestamp(),
+			    t,
+			    i + 1
+			));
+		}
+		total += sources[i].size();
+	}
+
+	TimeMerge         merge(Ranges(sources));
+	std::vector<Time> merged;
+	merge.Drain(std::back_inserter(merged));
+	ASSERT_EQ(merged.size(), total);
+	EXPECT_TRUE(merge.Done());
+	EXPECT_THROW(merge.Top(), std::out_of_range);
+	EXPECT_THROW(merge.Next(), std::out_of_range);
+	for (size_t i = 1; i < merged.size(); ++i) {
+		EXPECT_FALSE(merged[i].Before(merged[i - 1])) << "at " << i;
+	}
+}
+
+TEST_F(MergeUTest, UsesMonotonicValuesWithinAClock) {
+	// the wall clock was reset backward in source 0, but its
+	// monotonic values are still ordered.
+	auto              t0 = Time::Now();
+	auto              t1 = Time::Now().Add(Duration::Millisecond);
+	auto              t2 = Time::Now().Add(2 * Duration::Millisecond);
+	std::vector<Time> first;
+	first.push_back(t0);
+	first.push_back(Time::FromTimestampAndMonotonic(
+	    t0.Round(Duration::Nanosecond).Add(-Duration::Hour).ToTimestamp(),
+	    t1.MonotonicValue() + 1,
+	    Time::SYSTEM_MONOTONIC_CLOCK
+	));
+	std::vector<Time> second = {t1, t2};
+
+	TimeMerge<TimeIterator> merge({
+	    {first.begin(), first.end()},
+	    {second.begin(), second.end()},
+	});
+	std::vector<size_t> order;
+	for (; merge.Done() == false; merge.Next()) {
+		order.push_back(merge.Source());
+	}
+	EXPECT_EQ(order, std::vector<size_t>({0, 1, 0, 1}));
+}
+
+TEST_F(MergeUTest, IsStableAndSupportsKeyFunctions) {
+	struct Frame {
+		Time   FrameTime;
+		size_t ID;
+	};
+
+	auto               start = Time::FromUnix(0, 0);
+	std::vector<Frame> a, b;
+	for (size_t i = 0; i < 4; ++i) {
+		a.push_back({start.Add(int64_t(i / 2)), i});
+		b.push_back({start.Add(int64_t(i / 2)), 10 + i});
+	}
+	typedef std::vector<Frame>::const_iterator Iterator;
+	auto key = [](const Frame &f) { return f.FrameTime; };
+	TimeMerge<Iterator, decltype(key)> merge(
+	    {{a.begin(), a.end()}, {b.begin(), b.end()}},
+	    key
+	);
+	std::vector<size_t> IDs;
+	for (; merge.Done() == false; merge.Next()) {
+		EXPECT_TRUE(merge.TopTime().Equals(merge.Top().FrameTime));
+		IDs.push_back(merge.Top().ID);
+	}
+	EXPECT_EQ(IDs, std::vector<size_t>({0, 1, 10, 11, 2, 3, 12, 13}));
+}
+
+TEST_F(MergeUTest, HandlesDegenerateInputs) {
+	TimeMerge<TimeIterator> none({});
+	EXPECT_TRUE(none.Done());
+
+	std::vector<std::vector<Time>> single = {
+	    {Time::FromUnix(1, 0), Time::FromUnix(2, 0)},
+	};
+	TimeMerge         one(Ranges(single));
+	std::vector<Time> merged;
+	one.Drain(std::back_inserter(merged));
+	ASSERT_EQ(merged.size(), 2);
+	EXPECT_TRUE(merged[1].Equals(single[0][1]));
+}
+
+} // namespace fort
@@ -0,0 +1,153 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#include <limits>
+#include <stdexcept>
+
+#include "PackedTime.hpp"
+
+namespace fort {
+
+namespace {
+
+typedef __int128 int128_t;
+
+const int64_t NANOS_PER_SECOND = 1000000000LL;
+
+} // namespace
+
+void TimePacker::Pack(const Time *times, size_t n, pb::PackedTimes *packed) {
+	packed->Clear();
+	if (n == 0) {
+		return;
+	}
+	times[0].ToTimestamp(packed->mutable_base());
+
+	bool hasMono = times[0].HasMono();
+	for (size_t i = 1; i < n && hasMono; ++i) {
+		hasMono = times[i].HasMono() && times[i].MonoID() == times[0].MonoID();
+	}
+
+	auto wallDeltas = packed->mutable_wall_deltas();
+	wallDeltas->Resize(n, 0);
+	int64_t *wall = wallDeltas->mutable_data();
+	int64_t *mono = nullptr;
+	if (hasMono == true) {
+		auto m = packed->mutable_mono();
+		m->set_id(times[0].MonoID());
+		m->set_base(times[0].MonotonicValue());
+		m->mutable_deltas()->Resize(n, 0);
+		mono = m->mutable_deltas()->mutable_data();
+	}
+
+	for (size_t i = 0; i < n; ++i) {
+		auto t    = details::ToRawTime(times[i]);
+		auto prev = details::ToRawTime(times[i == 0 ? 0 : i - 1]);
+		// +/-∞ are the only Time with these wall seconds.
+		if (t.WallSec == std::numeric_limits<int64_t>::max() ||
+		    t.WallSec == std::numeric_limits<int64_t>::min()) {
+			throw std::invalid_argument("cannot pack an infinite Time");
+		}
+		int128_t delta =
+		    (int128_t(t.WallSec) - prev.WallSec) * NANOS_PER_SECOND +
+		    (t.WallNsec - prev.WallNsec);
+		if (delta > std::numeric_limits<int64_t>::max() ||
+		    delta < std::numeric_limits<int64_t>::min()) {
+			throw Time::Overflow("Wall");
+		}
+		wall[i] = int64_t(delta);
+		if (mono != nullptr) {
+			mono[i] = int64_t(t.Mono - prev.Mono);
+		}
+	}
+}
+
+void TimePacker::Pack(const std::vector<Time> &times, pb::PackedTimes *packed) {
+	Pack(times.data(), times.size(), packed);
+}
+
+void TimePacker::Unpack(const pb::PackedTimes &packed, std::vector<Time> &times) {
+	times.clear();
+	size_t n = packed.wall_deltas_size();
+
+	const int64_t    *mono   = nullptr;
+	uint64_t          monoValue = 0;
+	Time::MonoclockID monoID    = 0;
+	if (packed.has_mono() == true) {
+		const auto &m = packed.mono();
+		if (size_t(m.deltas_size()) != n) {
+			throw std::invalid_argument(
+			    "PackedTimes has " + std::to_string(n) + " wall deltas but " +
+			    std::to_string(m.deltas_size()) + " monotonic deltas"
+			);
+		}
+		// the last bit is a flag.
+		if (m.id() > uint32_t(std::numeric_limits<int32_t>::max())) {
+			throw Time::Overflow("MonoID");
+		}
+		mono      = m.deltas().data();
+		monoValue = m.base();
+		monoID    = details::RawTime::HAS_MONO_BIT | m.id();
+	}
+
+	times.reserve(n);
+	// the wall time is kept as seconds and normalized nanoseconds,
+	// which only need a division when crossing a second boundary.
+	const int64_t *wall = packed.wall_deltas().data();
+	int128_t       sec  = packed.base().seconds();
+	int64_t        nsec = NANOS_PER_SECOND;
+	for (size_t i = 0; i < n; ++i) {
+		int64_t delta = wall[i];
+		if (delta >= 0 && delta < NANOS_PER_SECOND - nsec) {
+			nsec += delta;
+		} else {
+			int128_t total = sec * NANOS_PER_SECOND + delta;
+			if (i == 0) {
+				// the base may not be normalized.
+				total += packed.base().nanos();
+			} else {
+				total += nsec;
+			}
+			sec            = total / NANOS_PER_SECOND;
+			nsec           = int64_t(total % NANOS_PER_SECOND);
+			if (nsec < 0) {
+				nsec += NANOS_PER_SECOND;
+				sec -= 1;
+			}
+			// +/-∞ wall seconds are reserved.
+			if (sec >= std::numeric_limits<int64_t>::max() ||
+			    sec <= std::numeric_limits<int64_t>::min()) {
+				throw Time::Overflow("Wall");
+			}
+		}
+		if (mono != nullptr) {
+			monoValue += uint64_t(mono[i]);
+		}
+		times.push_back(details::FromRawTime(
+		    {int64_t(sec), int32_t(nsec), monoValue, monoID}
+		));
+	}
+}
+
+std::vector<Time> TimePacker::Unpack(const pb::PackedTimes &packed) {
+	std::vector<Time> res;
+	Unpack(packed, res);
+	return res;
+}
+
+} // namespace fort
@@ -0,0 +1,111 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "PackedTime.pb.h"
+#include "Time.hpp"
+
+namespace fort {
+
+/**
+ * Converts Time sequences to and from `fort.pb.PackedTimes` messages
+ *
+ * A PackedTimes stores a base `google.protobuf.Timestamp` and the
+ * nanosecond difference of each Time with the preceding one as a
+ * packed repeated `sint64`. For frame timestamps this takes a few
+ * bytes per Time instead of a full Timestamp submessage, and the
+ * differences are deserialized by protobuf in a single contiguous
+ * array, without allocating per Time.
+ *
+ * Monotonic values are kept, the same way, only if all Time share the
+ * same MonoclockID, as Time from a single framegrabber do. Otherwise
+ * only the wall time is stored.
+ *
+ * ```c++
+ * using namespace fort;
+ * pb::PackedTimes packed;
+ * TimePacker::Pack(frames, &packed);
+ * packed.SerializeToOstream(&file);
+ * // ...
+ * std::vector<Time> frames;
+ * TimePacker::Unpack(packed, frames);
+ * ```
+ */
+class TimePacker {
+public:
+	/**
+	 * Packs a sequence of Time
+	 *
+	 * @param times the first Time to pack
+	 * @param n the number of Time to pack
+	 * @param packed the message to fill, any previous content is
+	 *        replaced
+	 *
+	 * @throws std::invalid_argument if a Time::IsInfinite()
+	 * @throws Time::Overflow if two consecutive wall times are more
+	 *         than ~292 years apart.
+	 */
+	static void Pack(const Time *times, size_t n, pb::PackedTimes *packed);
+
+	/**
+	 * Packs a vector of Time
+	 *
+	 * @param times the Time to pack
+	 * @param packed the message to fill, any previous content is
+	 *        replaced
+	 *
+	 * @throws std::invalid_argument if a Time::IsInfinite()
+	 * @throws Time::Overflow if two consecutive wall times are more
+	 *         than ~292 years apart.
+	 */
+	static void Pack(const std::vector<Time> &times, pb::PackedTimes *packed);
+
+	/**
+	 * Unpacks a sequence of Time
+	 *
+	 * @param packed the message to unpack
+	 * @param times the vector to fill, any previous content is
+	 *        replaced
+	 *
+	 * @throws std::invalid_argument if the numbers of wall and
+	 *         monotonic deltas differ.
+	 * @throws Time::Overflow if a wall time or the MonoclockID is not
+	 *         representable.
+	 */
+	static void Unpack(const pb::PackedTimes &packed, std::vector<Time> &times);
+
+	/**
+	 * Unpacks a sequence of Time
+	 *
+	 * @param packed the message to unpack
+	 *
+	 * @return the unpacked Time
+	 *
+	 * @throws std::invalid_argument if the numbers of wall and
+	 *         monotonic deltas differ.
+	 * @throws Time::Overflow if a wall time or the MonoclockID is not
+	 *         representable.
+	 */
+	static std::vector<Time> Unpack(const pb::PackedTimes &packed);
+};
+
+} // namespace fort
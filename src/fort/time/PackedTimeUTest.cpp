@@ -0,0 +1,141 @@
+#include "PackedTime.hpp"
+
+#include <random>
+
+#include "PackedTimeUTest.hpp"
+
+namespace fort {
+
+static ::testing::AssertionResult
+SameTimes(const std::vector<Time> &a, const std::vector<Time> &b) {
+	if (a.size() != b.size()) {
+		return ::testing::AssertionFailure()
+		       << "sizes differ: " << a.size() << " and " << b.size();
+	}
+	for (size_t i = 0; i < a.size(); ++i) {
+		if (a[i].Equals(b[i]) == false || a[i].HasMono() != b[i].HasMono() ||
+		    (a[i].HasMono() == true &&
+		     (a[i].MonoID() != b[i].MonoID() ||
+		      a[i].MonotonicValue() != b[i].MonotonicValue()))) {
+			return ::testing::AssertionFailure()
+			       << "Time " << i << " differs: " << a[i].DebugString()
+			       << " and " << b[i].DebugString();
+		}
+	}
+	return ::testing::AssertionSuccess();
+}
+
+static std::vector<Time> Frames(size_t n, Time::MonoclockID monoID) {
+	std::vector<Time> res;
+	std::mt19937      rng(42);
+	uint64_t          mono = 123456789;
+	for (size_t i = 0; i < n; ++i) {
+		mono += 33333333 + rng() % 100000;
+		auto wall = Time::FromUnix(1700000000, 0).Add(int64_t(mono + rng() % 1000));
+		res.push_back(
+		    Time::FromTimestampAndMonotonic(wall.ToTimestamp(), mono, monoID)
+		);
+	}
+	return res;
+}
+
+TEST_F(PackedTimeUTest, RoundTrips) {
+	auto            frames = Frames(1000, 42);
+	pb::PackedTimes packed;
+	TimePacker::Pack(frames, &packed);
+	EXPECT_EQ(packed.wall_deltas_size(), 1000);
+	EXPECT_TRUE(packed.has_mono());
+	EXPECT_EQ(packed.mono().id(), 42);
+	EXPECT_TRUE(SameTimes(TimePacker::Unpack(packed), frames));
+
+	std::string data;
+	ASSERT_TRUE(packed.SerializeToString(&data));
+	pb::PackedTimes parsed;
+	ASSERT_TRUE(parsed.ParseFromString(data));
+	EXPECT_TRUE(SameTimes(TimePacker::Unpack(parsed), frames));
+
+	// wall times alone take less than half of a repeated Timestamp
+	// field, which adds a tag and a length per item.
+	size_t timestampSize = 0;
+	for (auto &f : frames) {
+		timestampSize += f.ToTimestamp().ByteSizeLong() + 2;
+		f = f.Round(Duration::Nanosecond);
+	}
+	TimePacker::Pack(frames, &packed);
+	EXPECT_LT(2 * packed.ByteSizeLong(), timestampSize);
+
+	// unsorted Time, without monotonic values, crossing the epoch
+	std::vector<Time> times = {
+	    Time::FromUnix(-1, 999999999),
+	    Time::FromUnix(0, 1),
+	    Time::FromUnix(-3, 500000000),
+	    Time::FromUnix(1700000000, 0),
+	    Time::FromUnix(-1700000000, 0),
+	};
+	TimePacker::Pack(times, &packed);
+	EXPECT_FALSE(packed.has_mono());
+	EXPECT_TRUE(SameTimes(TimePacker::Unpack(packed), times));
+
+	// Time from different clocks only keep their wall time
+	times = Frames(10, 1);
+	times.push_back(Time::FromUnix(1700000001, 0));
+	TimePacker::Pack(times, &packed);
+	EXPECT_FALSE(packed.has_mono());
+	auto unpacked = TimePacker::Unpack(packed);
+	for (auto &t : times) {
+		t = t.Round(Duration::Nanosecond);
+	}
+	EXPECT_TRUE(SameTimes(unpacked, times));
+
+	// previous content is replaced
+	TimePacker::Pack(nullptr, 0, &packed);
+	EXPECT_EQ(packed.ByteSizeLong(), 0);
+	TimePacker::Unpack(packed, unpacked);
+	EXPECT_TRUE(unpacked.empty());
+}
+
+TEST_F(PackedTimeUTest, UnpacksHandWrittenMessages) {
+	pb::PackedTimes packed;
+	packed.mutable_base()->set_seconds(10);
+	packed.mutable_base()->set_nanos(-1500000000);
+	packed.add_wall_deltas(0);
+	packed.add_wall_deltas(-500000000);
+	auto times = TimePacker::Unpack(packed);
+	ASSERT_EQ(times.size(), 2);
+	EXPECT_TRUE(times[0].Equals(Time::FromUnix(8, 500000000)));
+	EXPECT_TRUE(times[1].Equals(Time::FromUnix(8, 0)));
+
+	auto mono = packed.mutable_mono();
+	mono->set_id(3);
+	mono->set_base(0);
+	mono->add_deltas(-1);
+	EXPECT_THROW(TimePacker::Unpack(packed), std::invalid_argument);
+	mono->add_deltas(2);
+	times = TimePacker::Unpack(packed);
+	ASSERT_EQ(times.size(), 2);
+	EXPECT_EQ(times[0].MonoID(), 3);
+	// deltas wrap around 2^64
+	EXPECT_EQ(times[0].MonotonicValue(), std::numeric_limits<uint64_t>::max());
+	EXPECT_EQ(times[1].MonotonicValue(), 1);
+
+	mono->set_id(uint32_t(std::numeric_limits<int32_t>::max()) + 1);
+	EXPECT_THROW(TimePacker::Unpack(packed), Time::Overflow);
+
+	packed.clear_mono();
+	packed.mutable_base()->set_seconds(std::numeric_limits<int64_t>::max() - 1);
+	packed.mutable_base()->set_nanos(0);
+	packed.set_wall_deltas(1, 1000000000);
+	EXPECT_THROW(TimePacker::Unpack(packed), Time::Overflow);
+}
+
+TEST_F(PackedTimeUTest, RejectsUnrepresentableTime) {
+	pb::PackedTimes packed;
+	std::vector<Time> times = {Time::FromUnix(0, 0), Time::Forever()};
+	EXPECT_THROW(TimePacker::Pack(times, &packed), std::invalid_argument);
+	times = {Time::SinceEver()};
+	EXPECT_THROW(TimePacker::Pack(times, &packed), std::invalid_argument);
+	times = {Time::FromUnix(0, 0), Time::FromUnix(10000000000LL, 0)};
+	EXPECT_THROW(TimePacker::Pack(times, &packed), Time::Overflow);
+}
+
+} // namespace fort
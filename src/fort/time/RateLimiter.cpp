@@ -0,0 +1,161 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <stdexcept>
+
+#include "RateLimiter.hpp"
+
+namespace fort {
+
+static uint64_t BucketTolerance(const Duration &interval, uint64_t burst) {
+	if (interval <= 0 || burst == 0) {
+		throw std::invalid_argument(
+		    "TokenBucket interval and burst must be positive"
+		);
+	}
+	uint64_t res;
+	if (__builtin_mul_overflow(uint64_t(interval.Nanoseconds()), burst, &res)) {
+		throw std::invalid_argument(
+		    "TokenBucket interval times burst must fit in 64 bits"
+		);
+	}
+	return res;
+}
+
+TokenBucket::TokenBucket(const Duration &interval, uint64_t burst)
+    : d_interval(interval.Nanoseconds())
+    , d_tolerance(BucketTolerance(interval, burst))
+    , d_TAT(0) {}
+
+bool TokenBucket::TryAcquire(const Time &now, uint64_t tokens) {
+	uint64_t mono = now.MonotonicValue();
+	uint64_t cost;
+	// more tokens than the burst are never available.
+	if (__builtin_mul_overflow(tokens, d_interval, &cost) ||
+	    cost > d_tolerance) {
+		return false;
+	}
+	uint64_t TAT = d_TAT.load(std::memory_order_relaxed);
+	for (;;) {
+		uint64_t newTAT = std::max(TAT, mono) + cost;
+		if (newTAT - mono > d_tolerance) {
+			return false;
+		}
+		if (d_TAT.compare_exchange_weak(
+		        TAT,
+		        newTAT,
+		        std::memory_order_relaxed,
+		        std::memory_order_relaxed
+		    )) {
+			return true;
+		}
+	}
+}
+
+bool TokenBucket::TryAcquire(uint64_t tokens) {
+	return TryAcquire(Time::Now(), tokens);
+}
+
+uint64_t TokenBucket::Available(const Time &now) const {
+	uint64_t mono = now.MonotonicValue();
+	uint64_t TAT  = std::max(d_TAT.load(std::memory_order_relaxed), mono);
+	// now may be older than the last acquisition of another thread.
+	if (TAT - mono >= d_tolerance) {
+		return 0;
+	}
+	return (d_tolerance - (TAT - mono)) / d_interval;
+}
+
+SlidingWindowLimiter::SlidingWindowLimiter(
+    const Duration &window, uint64_t limit
+)
+    : d_window(window.Nanoseconds())
+    , d_limit(limit) {
+	if (window <= 0 || limit == 0 || limit > 0xffffffffULL) {
+		throw std::invalid_argument(
+		    "SlidingWindowLimiter window and limit must be positive and "
+		    "limit smaller than 2^32"
+		);
+	}
+	// empty slots are always reset by the first acquisition.
+	d_slots[0].store(0xffffffff00000000ULL);
+	d_slots[1].store(0xffffffff00000000ULL);
+}
+
+static inline uint64_t SlotWindow(uint64_t slot) {
+	return slot >> 32;
+}
+
+static inline uint64_t SlotCount(uint64_t slot) {
+	return slot & 0xffffffffULL;
+}
+
+double SlidingWindowLimiter::Estimate(
+    uint64_t mono, uint64_t &window, uint64_t &raw, uint64_t &current
+) const {
+	window          = mono / d_window;
+	double   weight = 1.0 - double(mono % d_window) / double(d_window);
+	uint64_t w32    = window & 0xffffffffULL;
+	uint64_t prev   = d_slots[(window - 1) & 1].load(std::memory_order_relaxed);
+	raw             = d_slots[window & 1].load(std::memory_order_relaxed);
+	current         = raw;
+	if (SlotWindow(raw) != w32) {
+		if (SlotCount(raw) != 0 && int32_t(SlotWindow(raw) - w32) > 0) {
+			// a caller with a later now already moved this slot to a
+			// newer window, we are simply accounted in it.
+			return SlotCount(raw);
+		}
+		current = w32 << 32;
+	}
+	double res = SlotCount(current);
+	if (SlotWindow(prev) == ((window - 1) & 0xffffffffULL)) {
+		res += weight * SlotCount(prev);
+	}
+	return res;
+}
+
+bool SlidingWindowLimiter::TryAcquire(const Time &now, uint64_t events) {
+	uint64_t mono = now.MonotonicValue();
+	uint64_t window, raw, current;
+	for (;;) {
+		double estimate = Estimate(mono, window, raw, current);
+		if (estimate + double(events) > double(d_limit)) {
+			return false;
+		}
+		if (d_slots[window & 1].compare_exchange_weak(
+		        raw,
+		        current + events,
+		        std::memory_order_relaxed,
+		        std::memory_order_relaxed
+		    )) {
+			return true;
+		}
+	}
+}
+
+bool SlidingWindowLimiter::TryAcquire(uint64_t events) {
+	return TryAcquire(Time::Now(), events);
+}
+
+double SlidingWindowLimiter::Count(const Time &now) const {
+	uint64_t window, raw, current;
+	return Estimate(now.MonotonicValue(), window, raw, current);
+}
+
+} // namespace fort
@@ -0,0 +1,173 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "Time.hpp"
+
+namespace fort {
+
+/**
+ * A lock-free token bucket rate limiter
+ *
+ * A TokenBucket refills one token every interval, up to a burst
+ * capacity. It starts full. The whole state is a single atomic
+ * word (the theoretical arrival time of the
+ * [GCRA](https://en.wikipedia.org/wiki/Generic_cell_rate_algorithm)),
+ * so it can be shared among many threads without any lock.
+ *
+ * Times are compared using their monotonic value, so all Time passed
+ * to a TokenBucket must come from the same monotonic clock, like
+ * Time::Now(). A hot loop can read the clock once and reuse the same
+ * Time for many checks.
+ *
+ * ```c++
+ * using namespace fort;
+ * // at most 10 alerts per minute, with bursts of 3
+ * TokenBucket alerts(6 * Duration::Second, 3);
+ * if ( alerts.TryAcquire() ) {
+ *     SendAlert();
+ * }
+ * ```
+ */
+class TokenBucket {
+public:
+	/**
+	 * Constructor
+	 *
+	 * @param interval the Duration needed to refill one token
+	 * @param burst the capacity of the bucket.
+	 *
+	 * @throws std::invalid_argument if interval or burst is not
+	 *         positive, or if interval times burst overflows.
+	 */
+	TokenBucket(const Duration &interval, uint64_t burst);
+
+	/**
+	 * Takes tokens if available
+	 *
+	 * @param now the current Time. It must have a monotonic value.
+	 * @param tokens the number of tokens to take
+	 *
+	 * @return `true` if the tokens were taken, `false` if there was
+	 *         not enough tokens, or if tokens is larger than the
+	 *         burst. In that case, no token is taken.
+	 *
+	 * @throws std::runtime_error if now has no monotonic value.
+	 */
+	bool TryAcquire(const Time &now, uint64_t tokens = 1);
+
+	/**
+	 * Takes tokens if available at Time::Now()
+	 *
+	 * @param tokens the number of tokens to take
+	 *
+	 * @return `true` if the tokens were taken.
+	 */
+	bool TryAcquire(uint64_t tokens = 1);
+
+	/**
+	 * Gets the number of available tokens
+	 *
+	 * @param now the current Time. It must have a monotonic value.
+	 *
+	 * @return the number of tokens that could be acquired at now, or 0 if
+	 *         now is older than the acquisitions that emptied the bucket.
+	 */
+	uint64_t Available(const Time &now) const;
+
+private:
+	const uint64_t        d_interval;
+	const uint64_t        d_tolerance;
+	std::atomic<uint64_t> d_TAT;
+};
+
+/**
+ * A lock-free sliding window rate limiter
+ *
+ * A SlidingWindowLimiter allows at most a limit of events in any
+ * window of a given Duration. It approximates the sliding window count
+ * by weighting the count of the previous fixed window with its overlap
+ * with the sliding one. It only uses two atomic counters, that
+ * threads update with compare-and-swap operations.
+ *
+ * As for TokenBucket, all Time must come from the same monotonic
+ * clock, and can be reused for many checks.
+ */
+class SlidingWindowLimiter {
+public:
+	/**
+	 * Constructor
+	 *
+	 * @param window the Duration of the sliding window
+	 * @param limit the maximal number of events in a window. It
+	 *        must be smaller than 2^32.
+	 *
+	 * @throws std::invalid_argument if window or limit is not
+	 *         positive, or limit is too large.
+	 */
+	SlidingWindowLimiter(const Duration &window, uint64_t limit);
+
+	/**
+	 * Records events if within the limit
+	 *
+	 * @param now the current Time. It must have a monotonic value.
+	 * @param events the number of events to record
+	 *
+	 * @return `true` if the events are within the limit and were
+	 *         recorded, `false` otherwise.
+	 *
+	 * @throws std::runtime_error if now has no monotonic value.
+	 */
+	bool TryAcquire(const Time &now, uint64_t events = 1);
+
+	/**
+	 * Records events at Time::Now() if within the limit
+	 *
+	 * @param events the number of events to record
+	 *
+	 * @return `true` if the events are within the limit and were
+	 *         recorded.
+	 */
+	bool TryAcquire(uint64_t events = 1);
+
+	/**
+	 * Estimates the number of events in the window ending at now
+	 *
+	 * @param now the current Time. It must have a monotonic value.
+	 *
+	 * @return the estimated count of events in the sliding window.
+	 */
+	double Count(const Time &now) const;
+
+private:
+	double Estimate(
+	    uint64_t mono, uint64_t &window, uint64_t &raw, uint64_t &current
+	) const;
+
+	const uint64_t d_window;
+	const uint64_t d_limit;
+
+	// window index in the 32 high bits, count in the low bits.
+	std::atomic<uint64_t> d_slots[2];
+};
+
+} // namespace fort
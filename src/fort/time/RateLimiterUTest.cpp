@@ -0,0 +1,150 @@
+#include "RateLimiter.hpp"
+
+#include <atomic>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include "RateLimiterUTest.hpp"
+
+namespace fort {
+
+TEST_F(RateLimiterUTest, RejectsInvalidArguments) {
+	EXPECT_THROW(TokenBucket(0, 1), std::invalid_argument);
+	EXPECT_THROW(TokenBucket(Duration::Second, 0), std::invalid_argument);
+	EXPECT_THROW(SlidingWindowLimiter(0, 1), std::invalid_argument);
+	EXPECT_THROW(
+	    SlidingWindowLimiter(Duration::Second, 0),
+	    std::invalid_argument
+	);
+	EXPECT_THROW(
+	    SlidingWindowLimiter(Duration::Second, 1ULL << 32),
+	    std::invalid_argument
+	);
+	EXPECT_THROW(
+	    TokenBucket(Duration::Second, std::numeric_limits<uint64_t>::max()),
+	    std::invalid_argument
+	);
+	TokenBucket bucket(Duration::Second, 1);
+	EXPECT_THROW(bucket.TryAcquire(Time::FromUnix(0, 0)), std::runtime_error);
+}
+
+TEST_F(RateLimiterUTest, TokenBucketRejectsOversizedAcquisitions) {
+	auto        now = Time::Now();
+	TokenBucket bucket(Duration::Millisecond, 2);
+	EXPECT_FALSE(bucket.TryAcquire(now, 3));
+	// tokens * interval wraps around 2^64 to a small cost.
+	EXPECT_FALSE(bucket.TryAcquire(
+	    now,
+	    std::numeric_limits<uint64_t>::max() / 1000000 + 1
+	));
+	EXPECT_FALSE(bucket.TryAcquire(now, std::numeric_limits<uint64_t>::max()));
+	EXPECT_EQ(bucket.Available(now), 2);
+	EXPECT_TRUE(bucket.TryAcquire(now, 2));
+}
+
+TEST_F(RateLimiterUTest, TokenBucketHandlesStaleNow) {
+	auto        start = Time::Now();
+	TokenBucket bucket(Duration::Millisecond, 1);
+	// another thread acquires with a later reading
+	auto later = start.Add(100 * Duration::Millisecond);
+	EXPECT_TRUE(bucket.TryAcquire(later));
+	auto stale = start.Add(99500 * Duration::Microsecond);
+	EXPECT_EQ(bucket.Available(stale), 0);
+	EXPECT_FALSE(bucket.TryAcquire(stale));
+	EXPECT_EQ(bucket.Available(later), 0);
+	EXPECT_EQ(bucket.Available(start.Add(101 * Duration::Millisecond)), 1);
+}
+
+TEST_F(RateLimiterUTest, TokenBucketRefills) {
+	auto        start = Time::Now();
+	TokenBucket bucket(100 * Duration::Millisecond, 5);
+	EXPECT_EQ(bucket.Available(start), 5);
+	for (int i = 0; i < 5; ++i) {
+		EXPECT_TRUE(bucket.TryAcquire(start)) << "token " << i;
+	}
+	EXPECT_FALSE(bucket.TryAcquire(start));
+	EXPECT_EQ(bucket.Available(start), 0);
+
+	auto t = start.Add(150 * Duration::Millisecond);
+	EXPECT_EQ(bucket.Available(t), 1);
+	EXPECT_FALSE(bucket.TryAcquire(t, 2));
+	EXPECT_TRUE(bucket.TryAcquire(t));
+	EXPECT_FALSE(bucket.TryAcquire(t));
+
+	// capacity is capped to the burst size
+	t = start.Add(10 * Duration::Second);
+	EXPECT_EQ(bucket.Available(t), 5);
+	EXPECT_FALSE(bucket.TryAcquire(t, 6));
+	EXPECT_TRUE(bucket.TryAcquire(t, 5));
+	EXPECT_FALSE(bucket.TryAcquire(t));
+}
+
+TEST_F(RateLimiterUTest, TokenBucketIsThreadSafe) {
+	auto                     now = Time::Now();
+	TokenBucket              bucket(Duration::Second, 1000);
+	std::atomic<int>         acquired(0);
+	std::vector<std::thread> threads;
+	for (int i = 0; i < 4; ++i) {
+		threads.emplace_back([&]() {
+			for (int j = 0; j < 1000; ++j) {
+				if (bucket.TryAcquire(now)) {
+					++acquired;
+				}
+			}
+		});
+	}
+	for (auto &t : threads) {
+		t.join();
+	}
+	EXPECT_EQ(acquired.load(), 1000);
+}
+
+TEST_F(RateLimiterUTest, SlidingWindowLimits) {
+	// aligns the start on a window boundary for exact weights.
+	auto                 now   = Time::Now();
+	int64_t              mono  = now.MonotonicValue();
+	auto                 start = now.Add(Duration::Second - mono % 1000000000);
+	SlidingWindowLimiter limiter(Duration::Second, 10);
+	for (int i = 0; i < 10; ++i) {
+		EXPECT_TRUE(limiter.TryAcquire(start)) << "event " << i;
+	}
+	EXPECT_FALSE(limiter.TryAcquire(start));
+	EXPECT_DOUBLE_EQ(limiter.Count(start), 10.0);
+
+	auto t = start.Add(900 * Duration::Millisecond);
+	EXPECT_FALSE(limiter.TryAcquire(t));
+
+	// half of the previous window is still in the sliding one
+	t = start.Add(1500 * Duration::Millisecond);
+	EXPECT_DOUBLE_EQ(limiter.Count(t), 5.0);
+	EXPECT_FALSE(limiter.TryAcquire(t, 6));
+	EXPECT_TRUE(limiter.TryAcquire(t, 5));
+	EXPECT_FALSE(limiter.TryAcquire(t));
+
+	t = start.Add(3 * Duration::Second);
+	EXPECT_DOUBLE_EQ(limiter.Count(t), 0.0);
+	EXPECT_TRUE(limiter.TryAcquire(t, 10));
+}
+
+TEST_F(RateLimiterUTest, SlidingWindowIsThreadSafe) {
+	auto                     now = Time::Now();
+	SlidingWindowLimiter     limiter(Duration::Hour, 1000);
+	std::atomic<int>         acquired(0);
+	std::vector<std::thread> threads;
+	for (int i = 0; i < 4; ++i) {
+		threads.emplace_back([&]() {
+			for (int j = 0; j < 1000; ++j) {
+				if (limiter.TryAcquire(now)) {
+					++acquired;
+				}
+			}
+		});
+	}
+	for (auto &t : threads) {
+		t.join();
+	}
+	EXPECT_EQ(acquired.load(), 1000);
+}
+
+} // namespace fort
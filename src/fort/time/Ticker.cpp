@@ -0,0 +1,132 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#include <errno.h>
+#include <time.h>
+
+#include <stdexcept>
+#include <system_error>
+
+#include "Clock.hpp"
+#include "Ticker.hpp"
+
+namespace fort {
+
+static uint64_t SystemMono(const Time &t, const char *what) {
+	if (t.HasMono() == false || t.MonoID() != Time::SYSTEM_MONOTONIC_CLOCK) {
+		throw std::invalid_argument(
+		    std::string(what) +
+		    " has no system monotonic value: " + t.DebugString()
+		);
+	}
+	return t.MonotonicValue();
+}
+
+static inline bool Simulated() {
+	auto clock = Clock::Installed();
+	return clock != nullptr && clock != &SystemClock::Instance();
+}
+
+static uint64_t MonoNow() {
+	if (Simulated()) {
+		return Clock::Installed()->Now().MonotonicValue();
+	}
+	struct timespec mono;
+	clock_gettime(CLOCK_MONOTONIC, &mono);
+	return uint64_t(mono.tv_sec) * 1000000000ULL + mono.tv_nsec;
+}
+
+static void SleepUntilMono(uint64_t deadline, int64_t spin) {
+	if (spin < 0) {
+		spin = 0;
+	}
+	if (deadline > uint64_t(spin)) {
+		uint64_t        sleepUntil = deadline - spin;
+		struct timespec ts;
+		ts.tv_sec  = sleepUntil / 1000000000ULL;
+		ts.tv_nsec = sleepUntil % 1000000000ULL;
+		int res;
+		while ((res = clock_nanosleep(
+		            CLOCK_MONOTONIC,
+		            TIMER_ABSTIME,
+		            &ts,
+		            nullptr
+		        )) == EINTR) {
+		}
+		if (res != 0) {
+			throw std::system_error(
+			    res,
+			    std::system_category(),
+			    "On call of clock_nanosleep()"
+			);
+		}
+	}
+	while (spin > 0 && MonoNow() < deadline) {
+	}
+}
+
+void SleepUntil(const Time &deadline, const Duration &spin) {
+	if (Simulated()) {
+		Clock::Installed()->SleepUntil(deadline);
+		return;
+	}
+	SleepUntilMono(SystemMono(deadline, "deadline"), spin.Nanoseconds());
+}
+
+Ticker::Ticker(const Duration &period, const Time &start, const Duration &spin)
+    : d_start(start)
+    , d_period(period)
+    , d_spin(spin)
+    , d_startMono(SystemMono(start, "start"))
+    , d_next(0)
+    , d_missed(0) {
+	if (period <= 0) {
+		throw std::invalid_argument("Ticker period must be positive");
+	}
+}
+
+Time Ticker::Next() const {
+	return d_start.Add(int64_t(d_next) * d_period);
+}
+
+Ticker::Tick Ticker::Wait() {
+	uint64_t period   = d_period.Nanoseconds();
+	uint64_t deadline = d_startMono + d_next * period;
+	uint64_t now      = MonoNow();
+	uint64_t missed   = 0;
+	if (now < deadline) {
+		SleepUntil(Next(), d_spin);
+		now = MonoNow();
+	} else {
+		// skips to the latest passed deadline
+		missed = (now - deadline) / period;
+		d_next += missed;
+		deadline += missed * period;
+	}
+	d_missed += missed;
+
+	Tick res;
+	res.Time     = Next();
+	res.Index    = d_next;
+	res.Missed   = missed;
+	res.Lateness = int64_t(now - deadline);
+	++d_next;
+	return res;
+}
+
+} // namespace fort
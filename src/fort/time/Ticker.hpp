@@ -0,0 +1,146 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <cstdint>
+
+#include "Time.hpp"
+
+namespace fort {
+
+/**
+ * Sleeps until an absolute deadline
+ *
+ * @param deadline the Time to wake up at. It must have a
+ *        #Time::SYSTEM_MONOTONIC_CLOCK value, like any Time derived
+ *        from Time::Now().
+ * @param spin the Duration before deadline which is busy-waited
+ *        instead of slept, to wake up with a better precision than
+ *        the scheduler latency. Zero disables spinning.
+ *
+ * Uses `clock_nanosleep()` with `TIMER_ABSTIME` on `CLOCK_MONOTONIC`,
+ * so the wake up time does not drift with the time spent before the
+ * call. Returns immediately if deadline is already passed.
+ *
+ * If a Clock is installed with a Clock::Override, its
+ * Clock::SleepUntil() is used instead.
+ *
+ * @throws std::invalid_argument if deadline has no
+ *         #Time::SYSTEM_MONOTONIC_CLOCK value.
+ */
+void SleepUntil(const Time &deadline, const Duration &spin = 0);
+
+/**
+ * Wakes up periodically at absolute monotonic deadlines
+ *
+ * The deadline of the n-th tick is always `start + n * period`, as
+ * opposed to sleeping a relative period in a loop, where the
+ * processing time and wake-up latency of each iteration accumulate
+ * into a drift.
+ *
+ * ```c++
+ * using namespace fort;
+ * Ticker ticker(100 * Duration::Millisecond);
+ * for (;;) {
+ *     auto tick = ticker.Wait();
+ *     if ( tick.Missed > 0 ) {
+ *         std::cerr << "missed " << tick.Missed << " triggers" << std::endl;
+ *     }
+ *     Trigger(tick.Time);
+ * }
+ * ```
+ *
+ * When the caller is too late and several deadlines have passed, the
+ * missed ticks are skipped and reported in Tick::Missed.
+ */
+class Ticker {
+public:
+	/**
+	 * Describes a tick of a Ticker
+	 */
+	struct Tick {
+		/**
+		 * The scheduled Time of this tick.
+		 */
+		fort::Time Time;
+		/**
+		 * The index of this tick, the first tick being at start.
+		 */
+		uint64_t Index;
+		/**
+		 * The number of ticks skipped since the previous one.
+		 */
+		uint64_t Missed;
+		/**
+		 * How late the Ticker woke up after Time.
+		 */
+		Duration Lateness;
+	};
+
+	/**
+	 * Constructor
+	 *
+	 * @param period the Duration between two ticks
+	 * @param start the Time of the first tick. It must have a
+	 *        #Time::SYSTEM_MONOTONIC_CLOCK value.
+	 * @param spin the busy-wait Duration before each tick, see
+	 *        SleepUntil().
+	 *
+	 * @throws std::invalid_argument if period is not positive or
+	 *         start has no #Time::SYSTEM_MONOTONIC_CLOCK value.
+	 */
+	Ticker(
+	    const Duration &period,
+	    const Time     &start = Time::Now(),
+	    const Duration &spin  = 0
+	);
+
+	/**
+	 * Waits for the next tick
+	 *
+	 * @return the Tick that just happened.
+	 */
+	Tick Wait();
+
+	/**
+	 * Gets the scheduled Time of the next tick.
+	 *
+	 * @return the Time the next call to Wait() will return at.
+	 */
+	Time Next() const;
+
+	/**
+	 * Gets the total number of missed ticks.
+	 *
+	 * @return the number of ticks skipped since construction.
+	 */
+	inline uint64_t Missed() const {
+		return d_missed;
+	}
+
+private:
+	Time     d_start;
+	Duration d_period;
+	Duration d_spin;
+	uint64_t d_startMono;
+	uint64_t d_next;
+	uint64_t d_missed;
+};
+
+} // namespace fort
@@ -0,0 +1,83 @@
+#include "Ticker.hpp"
+
+#include "Clock.hpp"
+
+#include "TickerUTest.hpp"
+
+namespace fort {
+
+TEST_F(TickerUTest, RejectsInvalidArguments) {
+	EXPECT_THROW(Ticker(0), std::invalid_argument);
+	EXPECT_THROW(
+	    Ticker(Duration::Millisecond, Time::FromUnix(0, 0)),
+	    std::invalid_argument
+	);
+	EXPECT_THROW(SleepUntil(Time::FromUnix(0, 0)), std::invalid_argument);
+}
+
+TEST_F(TickerUTest, SleepUntilIsAbsolute) {
+	auto start = Time::Now();
+	// passed deadlines return immediately
+	SleepUntil(start.Add(-Duration::Second));
+	auto deadline = start.Add(2 * Duration::Millisecond);
+	SleepUntil(deadline, 200 * Duration::Microsecond);
+	auto now = Time::Now();
+	EXPECT_FALSE(now.Before(deadline));
+	// spinning makes us precise, but CI runners may be preempted.
+	EXPECT_LT(now.Sub(deadline), 5 * Duration::Millisecond);
+}
+
+TEST_F(TickerUTest, TicksAtAbsoluteDeadlines) {
+	VirtualClock    clock(Time::Now());
+	Clock::Override override(clock);
+	auto            start  = clock.Now().Add(Duration::Millisecond);
+	auto            period = 2 * Duration::Millisecond;
+	Ticker          ticker(period, start);
+	EXPECT_TRUE(ticker.Next().Equals(start));
+
+	for (uint64_t i = 0; i < 5; ++i) {
+		auto tick = ticker.Wait();
+		EXPECT_EQ(tick.Index, i);
+		EXPECT_TRUE(tick.Time.Equals(start.Add(int64_t(i) * period)));
+		EXPECT_TRUE(clock.Now().Equals(tick.Time));
+		EXPECT_EQ(tick.Missed, 0);
+		EXPECT_EQ(tick.Lateness, 0);
+		// processing time does not shift the next deadlines
+		clock.Advance(500 * Duration::Microsecond);
+	}
+}
+
+TEST_F(TickerUTest, TicksOnTheSystemClock) {
+	auto   start  = Time::Now().Add(Duration::Millisecond);
+	auto   period = 2 * Duration::Millisecond;
+	Ticker ticker(period, start);
+	// a preempted runner may miss ticks, they must then be reported.
+	for (uint64_t i = 0; i < 5; ++i) {
+		auto tick = ticker.Wait();
+		i += tick.Missed;
+		EXPECT_EQ(tick.Index, i);
+		EXPECT_TRUE(tick.Time.Equals(start.Add(int64_t(i) * period)));
+		EXPECT_FALSE(Time::Now().Before(tick.Time));
+		EXPECT_GE(tick.Lateness, 0);
+	}
+}
+
+TEST_F(TickerUTest, ReportsMissedTicks) {
+	VirtualClock    clock(Time::Now());
+	Clock::Override override(clock);
+	auto            start  = clock.Now();
+	auto            period = Duration::Millisecond;
+	Ticker          ticker(period, start);
+	auto            first = ticker.Wait();
+	EXPECT_EQ(first.Index, 0);
+
+	clock.Set(start.Add(5500 * Duration::Microsecond));
+	auto tick = ticker.Wait();
+	EXPECT_EQ(tick.Missed, 4);
+	EXPECT_EQ(tick.Index, 5);
+	EXPECT_TRUE(tick.Time.Equals(start.Add(5 * period)));
+	EXPECT_EQ(tick.Lateness, 500 * Duration::Microsecond);
+	EXPECT_EQ(ticker.Missed(), 4);
+}
+
+} // namespace fort
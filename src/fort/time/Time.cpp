@@ -25,6 +25,7 @@
 
 #include <google/protobuf/util/time_util.h>
 
+#include "Clock.hpp"
 #include "Time.hpp"
 
 #define p_call(fnct, ...)                                                      \
@@ -43,13 +44,6 @@ namespace fort {
 
 using nanos = std::chrono::duration<uint64_t, std::nano>;
 
-const Duration Duration::Hour        = 3600e9;
-const Duration Duration::Minute      = 60e9;
-const Duration Duration::Second      = 1e9;
-const Duration Duration::Millisecond = 1e6;
-const Duration Duration::Microsecond = 1e3;
-const Duration Duration::Nanosecond  = 1;
-
 double Duration::Hours() const {
 	return double(d_nanoseconds) / double(3600.0e9);
 }
@@ -70,106 +64,23 @@ double Duration::Microseconds() const {
 	return double(d_nanoseconds) / double(1.0e3);
 }
 
-Duration Duration::Parse(const std::string &i) {
-	uint64_t integer(0);
-	double   frac(0);
-	bool     neg(false);
-
-#define throws(c) throw std::runtime_error("Could not parse '" + i + "':" + c)
-	if (i.empty()) {
-		throws("empty");
-	}
-
-	auto it = i.cbegin();
-
-	if (*it == '-' || *it == '+') {
-		neg = *it == '-';
-		++it;
-	}
-
-	if (i.cend() - it == 1 && *it == '0') {
-		return 0;
-	}
-
-	bool ok     = *it == '.';
-	bool zeroOK = false;
-	for (; it != i.cend() && *it >= '0' && *it <= '9'; ++it) {
-		ok      = true;
-		zeroOK  = true;
-		integer = integer * 10 + (*it - '0');
-	}
-
-	if (integer > std::numeric_limits<int64_t>::max()) {
-		throws("integer overflow");
-	}
-
-	if (ok == false) {
-		throws("need a number");
-	}
-
-	if (it != i.cend() && *it == '.') {
-		++it;
-		for (double base = 0.1; it != i.cend() && *it >= '0' && *it <= '9';
-		     ++it) {
-			frac += (*it - '0') * base;
-			base /= 10.0;
-		}
-	}
-	if (integer == 0 && frac == 0.0 && zeroOK == false) {
-		throws("empty number");
-	}
-
-	std::string unit;
-	for (; it != i.cend() && (*it < '0' || *it > '9'); ++it) {
-		unit += *it;
-	}
-
-	static std::map<std::string, int64_t> units = {
-	    {"ns", Nanosecond.Nanoseconds()},
-	    {"us", Microsecond.Nanoseconds()},
-	    {"µs", Microsecond.Nanoseconds()},
-	    {"μs", Microsecond.Nanoseconds()},
-	    {"ms", Millisecond.Nanoseconds()},
-	    {"s", Second.Nanoseconds()},
-	    {"m", Minute.Nanoseconds()},
-	    {"h", Hour.Nanoseconds()},
-	};
-	auto fi = units.find(unit);
-	if (fi == units.end()) {
-		throws("unknown unit '" + unit + "'");
-	}
-	if (integer > std::numeric_limits<int64_t>::max() / fi->second) {
-		throws("integer will overflow");
-	}
-	int64_t res     = integer * fi->second;
-	// fractionnal part cannot overflow
-	int64_t resfrac = frac * fi->second;
-
-	if (res > std::numeric_limits<int64_t>::max() - resfrac) {
-		throws("will overflow");
-	}
-	res += resfrac;
-
-	if (it == i.cend()) {
-		if (neg == true) {
-			return -res;
-		};
-		return res;
-	}
-	int64_t other = Parse(std::string(it, i.cend())).Nanoseconds();
-
-	if (neg == true) {
-		if (-res < std::numeric_limits<int64_t>::min() + other) {
-			throws("overflow");
-		}
-		return -res - other;
-	}
-	if (res > std::numeric_limits<int64_t>::max() - other) {
-		throws("overflow");
+namespace details {
+void ThrowDurationParseError(
+    std::string_view input, std::string_view what, std::string_view unit
+) {
+	CountTime(TimeCounter::DURATION_PARSE_FAILURE);
+	std::string message =
+	    "Could not parse '" + std::string(input) + "':" + std::string(what);
+	// an empty unit is quoted too, as in "unknown unit ''".
+	if (unit.empty() == false || what == "unknown unit") {
+		message += " '" + std::string(unit) + "'";
 	}
+	throw std::runtime_error(message);
+}
+} // namespace details
 
-#undef throws
-	return res + other;
+Duration Duration::Parse(const std::string &i) {
+	return ParseConstexpr(i);
 }
 
 // we don't use numeric_limit as we want to force pre-compiled
@@ -199,15 +110,24 @@ uint64_t Time::MonoFromSecNSec(uint64_t sec, uint64_t nsec) {
 }
 
 Time Time::Now() {
+	details::CountTime(TimeCounter::NOW);
+	auto clock = Clock::Installed();
+	if (__builtin_expect(clock != nullptr, 0)) {
+		return clock->Now();
+	}
+	return details::SystemNow();
+}
+
+Time details::SystemNow() {
 	struct timespec wall, mono;
 	p_call(clock_gettime, CLOCK_REALTIME, &wall);
 	p_call(clock_gettime, CLOCK_MONOTONIC, &mono);
 
-	return Time(
-	    wall.tv_sec,
-	    wall.tv_nsec,
-	    MonoFromSecNSec(mono.tv_sec, mono.tv_nsec),
-	    HAS_MONO_BIT | SYSTEM_MONOTONIC_CLOCK
+	return FromRawTime(
+	    {wall.tv_sec,
+	     int32_t(wall.tv_nsec),
+	     Time::MonoFromSecNSec(mono.tv_sec, mono.tv_nsec),
+	     RawTime::HAS_MONO_BIT | Time::SYSTEM_MONOTONIC_CLOCK}
 	);
 }
 
@@ -252,6 +172,43 @@ Time Time::FromUnix(int64_t seconds, int32_t nanoseconds) {
 	return Time(seconds, nanoseconds, 0, 0);
 }
 
+Time Time::FromTimePoint(const std::chrono::system_clock::time_point &t) {
+	int64_t ns  = std::chrono::nanoseconds(t.time_since_epoch()).count();
+	int64_t sec = ns / NANOS_PER_SECOND_SINT64;
+	// one normalization step is needed for negative values.
+	return Time(sec, ns % NANOS_PER_SECOND_SINT64, 0, 0);
+}
+
+Time Time::FromTimePoint(const std::chrono::steady_clock::time_point &t) {
+	uint64_t mono = std::chrono::nanoseconds(t.time_since_epoch()).count();
+	auto     now  = details::SystemNow();
+	return now.Add(int64_t(mono - now.d_mono));
+}
+
+std::chrono::system_clock::time_point Time::ToSystemTimePoint() const {
+	if (d_wallSec > MAX_SECOND_SINT64 - 1 || d_wallSec < MIN_SECOND_SINT64 + 1) {
+		throw Overflow("Wall");
+	}
+	std::chrono::nanoseconds ns(
+	    d_wallSec * NANOS_PER_SECOND_SINT64 + d_wallNsec
+	);
+	return std::chrono::system_clock::time_point(
+	    std::chrono::duration_cast<std::chrono::system_clock::duration>(ns)
+	);
+}
+
+std::chrono::steady_clock::time_point Time::ToSteadyTimePoint() const {
+	if (HasMono() == false || MonoID() != SYSTEM_MONOTONIC_CLOCK) {
+		throw std::invalid_argument(
+		    "Time has no system monotonic value: " + DebugString()
+		);
+	}
+	std::chrono::nanoseconds ns(d_mono);
+	return std::chrono::steady_clock::time_point(
+	    std::chrono::duration_cast<std::chrono::steady_clock::duration>(ns)
+	);
+}
+
 google::protobuf::Timestamp Time::ToTimestamp() const {
 	google::protobuf::Timestamp pb;
 	ToTimestamp(&pb);
@@ -283,6 +240,7 @@ Time Time::FromTimestampAndMonotonic(
 Time Time::Parse(const std::string &input) {
 	google::protobuf::Timestamp pb;
 	if (google::protobuf::util::TimeUtil::FromString(input, &pb) == false) {
+		details::CountTime(TimeCounter::TIME_PARSE_FAILURE);
 		throw std::runtime_error("Time: could not parse '" + input + "'");
 	}
 	return FromTimestamp(pb);
@@ -323,6 +281,17 @@ Time::Time(int64_t wallSec, int32_t wallNsec, uint64_t mono, MonoclockID monoID)
 
 #define MONO_MASK (HAS_MONO_BIT - 1)
 
+// Counts a wall time path, or its fallback if both Time have
+// monotonic values from different clocks. Fallback counters follow
+// their wall counter in TimeCounter.
+static inline void
+CountWallPath(const Time &a, const Time &b, TimeCounter wall) {
+	if constexpr (TimeCounters::Enabled) {
+		bool fallback = a.HasMono() && b.HasMono();
+		details::CountTime(TimeCounter(size_t(wall) + fallback));
+	}
+}
+
 Time Time::Add(const Duration &d) const {
 	uint64_t mono  = d_mono;
 	int64_t  toAdd = d.Nanoseconds();
@@ -411,8 +380,10 @@ Duration Time::Reminder(const Duration &d) const {
 
 bool Time::After(const Time &t) const {
 	if (d_monoID != 0 && d_monoID == t.d_monoID) {
+		details::CountTime(TimeCounter::COMPARE_MONO);
 		return d_mono > t.d_mono;
 	}
+	CountWallPath(*this, t, TimeCounter::COMPARE_WALL);
 	if (d_wallSec == t.d_wallSec) {
 		return d_wallNsec > t.d_wallNsec;
 	}
@@ -421,8 +392,10 @@ bool Time::After(const Time &t) const {
 
 bool Time::Equals(const Time &t) const {
 	if (d_monoID != 0 && d_monoID == t.d_monoID) {
+		details::CountTime(TimeCounter::COMPARE_MONO);
 		return d_mono == t.d_mono;
 	}
+	CountWallPath(*this, t, TimeCounter::COMPARE_WALL);
 	return d_wallSec == t.d_wallSec && d_wallNsec == t.d_wallNsec;
 }
 
@@ -441,8 +414,10 @@ bool Time::IsInfinite() const {
 
 bool Time::Before(const Time &t) const {
 	if (d_monoID != 0 && d_monoID == t.d_monoID) {
+		details::CountTime(TimeCounter::COMPARE_MONO);
 		return d_mono < t.d_mono;
 	}
+	CountWallPath(*this, t, TimeCounter::COMPARE_WALL);
 	if (d_wallSec == t.d_wallSec) {
 		return d_wallNsec < t.d_wallNsec;
 	}
@@ -452,8 +427,11 @@ bool Time::Before(const Time &t) const {
 Duration Time::Sub(const Time &t) const {
 	if (d_monoID != 0 && d_monoID == t.d_monoID) {
 		// both have a monotonic timestamp issued from the same clock
+		details::CountTime(TimeCounter::SUB_MONO);
 		return int64_t(d_mono - t.d_mono);
-	} else if (IsInfinite() == true || t.IsInfinite() == true) {
+	}
+	CountWallPath(*this, t, TimeCounter::SUB_WALL);
+	if (IsInfinite() == true || t.IsInfinite() == true) {
 		throw Overflow("Wall");
 	}
 
@@ -475,6 +453,10 @@ Duration Time::Sub(const Time &t) const {
 }
 
 bool Time::HasMono() const {
+	static_assert(
+	    details::RawTime::HAS_MONO_BIT == HAS_MONO_BIT,
+	    "RawTime and Time disagree on the monotonic flag"
+	);
 	return (d_monoID & HAS_MONO_BIT) != 0;
 }
 
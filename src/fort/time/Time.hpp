@@ -22,9 +22,13 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <utility>
 
 #include <google/protobuf/timestamp.pb.h>
 
+#include "TimeCounters.hpp"
+
 /**
  * the fort namespace
  */
@@ -51,13 +55,13 @@ public:
 	 *
 	 * @param ns the number of nanosecond
 	 */
-	inline Duration(int64_t ns)
+	inline constexpr Duration(int64_t ns)
 	    : d_nanoseconds(ns) {}
 
 	/**
 	 * Default constructor with a zero duration.
 	 */
-	inline Duration()
+	inline constexpr Duration()
 	    : d_nanoseconds(0) {}
 
 	/**
@@ -68,7 +72,7 @@ public:
 	 * @param duration the <std::chrono::duration> to convert
 	 */
 	template <typename T, typename U>
-	Duration(const std::chrono::duration<T, U> &duration)
+	constexpr Duration(const std::chrono::duration<T, U> &duration)
 	    : d_nanoseconds(
 	          std::chrono::duration<int64_t, std::nano>(duration).count()
 	      ) {}
@@ -113,10 +117,20 @@ public:
 	 *
 	 * @return the duration in nanoseconds
 	 */
-	int64_t Nanoseconds() const {
+	constexpr int64_t Nanoseconds() const {
 		return d_nanoseconds;
 	}
 
+	/**
+	 * Converts to a std::chrono::duration
+	 *
+	 * @return the Duration as `std::chrono::nanoseconds`, without any
+	 *         loss of precision.
+	 */
+	constexpr std::chrono::nanoseconds ToChrono() const {
+		return std::chrono::nanoseconds(d_nanoseconds);
+	}
+
 	/**
 	 *  Parses a string to a Duration
 	 *
@@ -134,6 +148,30 @@ public:
 	 */
 	static Duration Parse(const std::string &d);
 
+	/**
+	 * Parses a string to a Duration at compile time
+	 *
+	 * @param d the string to parse, with the same grammar than Parse()
+	 *
+	 * A `constexpr` version of Parse(). When used in a constant
+	 * expression, an invalid string is a compilation error:
+	 *
+	 * ```c++
+	 * using namespace fort;
+	 * constexpr Duration timeout = Duration::ParseConstexpr("4m32s");
+	 * // or, equivalently
+	 * constexpr Duration timeout = "4m32s"_d;
+	 * ```
+	 *
+	 * @throws std::runtime_error if d is an invalid string
+	 *
+	 * @return the Duration represented by the string.
+	 */
+	static constexpr Duration ParseConstexpr(std::string_view d);
+
+	// The constants below are constexpr. As Duration is incomplete
+	// here, they are only declared, and defined after the class.
+
 	/**
 	 * The Value for an hour.
 	 */
@@ -170,7 +208,7 @@ public:
 	 *
 	 * @return a new duration `this + other `
 	 */
-	inline Duration operator+(const Duration &other) const {
+	inline constexpr Duration operator+(const Duration &other) const {
 		return d_nanoseconds + other.d_nanoseconds;
 	}
 
@@ -182,7 +220,7 @@ public:
 	 *
 	 * @return a new duration `this * other `
 	 */
-	inline Duration operator*(const fort::Duration &other) const {
+	inline constexpr Duration operator*(const fort::Duration &other) const {
 		return d_nanoseconds * other.d_nanoseconds;
 	}
 
@@ -193,7 +231,7 @@ public:
 	 * Substracts two Duration.
 	 * @return a new duration `this - other `
 	 */
-	inline Duration operator-(const fort::Duration &other) const {
+	inline constexpr Duration operator-(const fort::Duration &other) const {
 		return d_nanoseconds - other.d_nanoseconds;
 	}
 
@@ -202,7 +240,7 @@ public:
 	 *
 	 * @return the opposite duration `- this`
 	 */
-	inline Duration operator-() const {
+	inline constexpr Duration operator-() const {
 		return -d_nanoseconds;
 	}
 
@@ -214,7 +252,7 @@ public:
 	 *
 	 * @return `this < other`
 	 */
-	inline bool operator<(const Duration &other) const {
+	inline constexpr bool operator<(const Duration &other) const {
 		return d_nanoseconds < other.d_nanoseconds;
 	}
 
@@ -225,7 +263,7 @@ public:
 	 * Compares two Duration.
 	 * @return `this <= other`
 	 */
-	inline bool operator<=(const Duration &other) const {
+	inline constexpr bool operator<=(const Duration &other) const {
 		return d_nanoseconds <= other.d_nanoseconds;
 	}
 
@@ -237,7 +275,7 @@ public:
 	 * @return `this > other`
 	 */
 
-	inline bool operator>(const Duration &other) const {
+	inline constexpr bool operator>(const Duration &other) const {
 		return d_nanoseconds > other.d_nanoseconds;
 	}
 
@@ -248,7 +286,7 @@ public:
 	 * Compares two Duration.
 	 * @return `this >= other`
 	 */
-	inline bool operator>=(const Duration &other) const {
+	inline constexpr bool operator>=(const Duration &other) const {
 		return d_nanoseconds >= other.d_nanoseconds;
 	}
 
@@ -259,7 +297,7 @@ public:
 	 * Compares two Duration.
 	 * @return `this == other`
 	 */
-	inline bool operator==(const Duration &other) const {
+	inline constexpr bool operator==(const Duration &other) const {
 		return d_nanoseconds == other.d_nanoseconds;
 	}
 
@@ -269,6 +307,126 @@ private:
 	int64_t d_nanoseconds;
 };
 
+inline constexpr Duration Duration::Hour        = 3600000000000LL;
+inline constexpr Duration Duration::Minute      = 60000000000LL;
+inline constexpr Duration Duration::Second      = 1000000000LL;
+inline constexpr Duration Duration::Millisecond = 1000000LL;
+inline constexpr Duration Duration::Microsecond = 1000LL;
+inline constexpr Duration Duration::Nanosecond  = 1LL;
+
+namespace details {
+// Not constexpr: reaching it in a constant expression is a compilation
+// error.
+[[noreturn]] void ThrowDurationParseError(
+    std::string_view input, std::string_view what, std::string_view unit = {}
+);
+} // namespace details
+
+constexpr Duration Duration::ParseConstexpr(std::string_view i) {
+	constexpr int64_t max = 0x7fffffffffffffffLL;
+
+	uint64_t integer(0);
+	double   frac(0);
+	bool     neg(false);
+
+	if (i.empty()) {
+		details::ThrowDurationParseError(i, "empty");
+	}
+
+	size_t it = 0;
+	if (i[it] == '-' || i[it] == '+') {
+		neg = i[it] == '-';
+		++it;
+	}
+
+	if (i.size() - it == 1 && i[it] == '0') {
+		return 0;
+	}
+
+	bool ok     = it < i.size() && i[it] == '.';
+	bool zeroOK = false;
+	for (; it < i.size() && i[it] >= '0' && i[it] <= '9'; ++it) {
+		ok      = true;
+		zeroOK  = true;
+		integer = integer * 10 + (i[it] - '0');
+	}
+
+	if (integer > uint64_t(max)) {
+		details::ThrowDurationParseError(i, "integer overflow");
+	}
+
+	if (ok == false) {
+		details::ThrowDurationParseError(i, "need a number");
+	}
+
+	if (it < i.size() && i[it] == '.') {
+		++it;
+		for (double base = 0.1; it < i.size() && i[it] >= '0' && i[it] <= '9';
+		     ++it) {
+			frac += (i[it] - '0') * base;
+			base /= 10.0;
+		}
+	}
+	if (integer == 0 && frac == 0.0 && zeroOK == false) {
+		details::ThrowDurationParseError(i, "empty number");
+	}
+
+	size_t unitStart = it;
+	for (; it < i.size() && (i[it] < '0' || i[it] > '9'); ++it) {
+	}
+	std::string_view unit = i.substr(unitStart, it - unitStart);
+
+	constexpr std::pair<std::string_view, int64_t> units[] = {
+	    {"ns", 1LL},
+	    {"us", 1000LL},
+	    {"µs", 1000LL}, // U+00B5
+	    {"μs", 1000LL}, // U+03BC
+	    {"ms", 1000000LL},
+	    {"s", 1000000000LL},
+	    {"m", 60000000000LL},
+	    {"h", 3600000000000LL},
+	};
+	int64_t scale = 0;
+	for (const auto &[name, value] : units) {
+		if (name == unit) {
+			scale = value;
+		}
+	}
+	if (scale == 0) {
+		details::ThrowDurationParseError(i, "unknown unit", unit);
+	}
+	if (integer > uint64_t(max / scale)) {
+		details::ThrowDurationParseError(i, "integer will overflow");
+	}
+	int64_t res     = integer * scale;
+	// fractionnal part cannot overflow
+	int64_t resfrac = frac * scale;
+
+	if (res > max - resfrac) {
+		details::ThrowDurationParseError(i, "will overflow");
+	}
+	res += resfrac;
+
+	if (it == i.size()) {
+		if (neg == true) {
+			return -res;
+		};
+		return res;
+	}
+	int64_t other = ParseConstexpr(i.substr(it)).Nanoseconds();
+
+	if (neg == true) {
+		if (-res < -max - 1 + other) {
+			details::ThrowDurationParseError(i, "overflow");
+		}
+		return -res - other;
+	}
+	if (res > max - other) {
+		details::ThrowDurationParseError(i, "overflow");
+	}
+	return res + other;
+}
+
 /**
  *  A point in time
  *
@@ -311,11 +469,20 @@ private:
  * MonoclockID() for each of those reading. This class does not
  * enforce any mechanism. The only entry point to define the
  * MonoclockID() is through the utility function
- * FromTimestampAndMonotonic().
+ * FromTimestampAndMonotonic(). Values from `0x7ffffff0` are reserved
+ * for the clocks of SourceClock.
  *
  * Every time are considered UTC.
  *
  */
+class Time;
+
+namespace details {
+struct RawTime;
+inline RawTime ToRawTime(const Time &t);
+inline Time    FromRawTime(const RawTime &raw);
+} // namespace details
+
 class Time {
 public:
 	/**
@@ -328,7 +495,9 @@ public:
 		 * @param clocktype the clock type to use
 		 */
 		Overflow(const std::string &clocktype)
-		    : std::runtime_error(clocktype + " value will overflow") {}
+		    : std::runtime_error(clocktype + " value will overflow") {
+			details::CountTime(TimeCounter::OVERFLOW_THROWN);
+		}
 
 		/**
 		 * default destructor
@@ -384,6 +553,8 @@ public:
 	 * Will always return a positive Duration, even if the wall clock
 	 * has been reset between the two calls to Now()
 	 *
+	 * If a Clock is installed with a Clock::Override, its Clock::Now()
+	 * is returned instead.
 	 *
 	 * @return the current <myrmidon::Time>
 	 */
@@ -428,6 +599,30 @@ public:
 	 */
 	static Time FromUnix(int64_t seconds, int32_t nanoseconds);
 
+	/**
+	 * Creates a Time from a `std::chrono::system_clock` time point
+	 * @param t the time point to convert
+	 *
+	 * The conversion keeps the nanoseconds. The Time will not have
+	 * any monotonic clock value.
+	 *
+	 * @return the converted Time
+	 */
+	static Time FromTimePoint(const std::chrono::system_clock::time_point &t);
+
+	/**
+	 * Creates a Time from a `std::chrono::steady_clock` time point
+	 * @param t the time point to convert
+	 *
+	 * `std::chrono::steady_clock` reads `CLOCK_MONOTONIC`, so t
+	 * becomes the exact #SYSTEM_MONOTONIC_CLOCK value of the
+	 * Time. As a steady time point has no wall time, it is estimated
+	 * from the current offset between the system clocks.
+	 *
+	 * @return the converted Time
+	 */
+	static Time FromTimePoint(const std::chrono::steady_clock::time_point &t);
+
 	/**
 	 * Creates a Time from a protobuf Timestamp and an external Monotonic clock
 	 * @param timestamp the `google.protobuf.Timestamp` message
@@ -485,6 +680,30 @@ public:
 	 */
 	timeval ToTimeval() const;
 
+	/**
+	 * Converts to a `std::chrono::system_clock` time point
+	 *
+	 * @return the time point of the wall time, with nanoseconds.
+	 *
+	 * @throws Overflow if the Time is out of the time point range,
+	 *         i.e. about 292 years around 1970.
+	 */
+	std::chrono::system_clock::time_point ToSystemTimePoint() const;
+
+	/**
+	 * Converts to a `std::chrono::steady_clock` time point
+	 *
+	 * The conversion uses the monotonic value, it can be used as a
+	 * deadline with `std::condition_variable::wait_until()` without
+	 * any clock conversion.
+	 *
+	 * @return the time point of the #SYSTEM_MONOTONIC_CLOCK value.
+	 *
+	 * @throws std::invalid_argument if the Time has no
+	 *         #SYSTEM_MONOTONIC_CLOCK value.
+	 */
+	std::chrono::steady_clock::time_point ToSteadyTimePoint() const;
+
 	/**
 	 * Converts to a protobuf Timestamp message
 	 *
@@ -604,6 +823,10 @@ public:
 	 * @return a Duration representing the time ellapsed between
 	 *         `this` and t. It could be negative.
 	 *
+	 * When both Time do not share a monotonic clock, the UTC wall
+	 * values are used, which ignore leap seconds. Use
+	 * LeapSecondTable::Sub() for exact differences.
+	 *
 	 * @throws Overflow if the time Differance is larger than a signed
 	 *         64-bit amount of nanoseconds.
 	 */
@@ -617,6 +840,32 @@ public:
 	 */
 	const static MonoclockID SYSTEM_MONOTONIC_CLOCK = 0;
 
+	/**
+	 * The coarse system monotonic clock.
+	 *
+	 * The MonoclockID reserved for `CLOCK_MONOTONIC_COARSE`, used by
+	 * the ClockSource::COARSE SourceClock.
+	 */
+	const static MonoclockID COARSE_MONOTONIC_CLOCK = 0x7ffffff0;
+
+	/**
+	 * The system boot time clock.
+	 *
+	 * The MonoclockID reserved for `CLOCK_BOOTTIME`, which unlike
+	 * `CLOCK_MONOTONIC` keeps counting while the system is
+	 * suspended. Used by the ClockSource::BOOTTIME SourceClock.
+	 */
+	const static MonoclockID BOOTTIME_CLOCK = 0x7ffffff1;
+
+	/**
+	 * The system monotonic clock, paired with a TAI wall clock.
+	 *
+	 * The MonoclockID reserved for the ClockSource::TAI SourceClock.
+	 * Its monotonic values are read from `CLOCK_MONOTONIC`, but its
+	 * wall values are TAI and not UTC.
+	 */
+	const static MonoclockID TAI_MONOTONIC_CLOCK = 0x7ffffff2;
+
 	/**
 	 * Reports the presence of a monotonic time value.
 	 *
@@ -728,6 +977,9 @@ public:
 	}
 
 private:
+	friend details::RawTime details::ToRawTime(const Time &t);
+	friend Time details::FromRawTime(const details::RawTime &raw);
+
 	// Number of nanoseconds in a second.
 	const static uint64_t NANOS_PER_SECOND = 1000000000ULL;
 
@@ -745,6 +997,37 @@ private:
 	MonoclockID           d_monoID;
 };
 
+namespace details {
+/**
+ * The fields of a Time
+ *
+ * Reserved to the library components that build Time from raw clock
+ * readings, or scan batches of Time without the checks of the public
+ * accessors.
+ */
+struct RawTime {
+	// Set in MonoID when the Time has a monotonic value.
+	const static uint32_t HAS_MONO_BIT = 0x80000000UL;
+
+	int64_t  WallSec;
+	int32_t  WallNsec;
+	uint64_t Mono;
+	uint32_t MonoID;
+};
+
+inline RawTime ToRawTime(const Time &t) {
+	return {t.d_wallSec, t.d_wallNsec, t.d_mono, t.d_monoID};
+}
+
+// Normalizes WallNsec, and throws Time::Overflow if it cannot.
+inline Time FromRawTime(const RawTime &raw) {
+	return Time(raw.WallSec, raw.WallNsec, raw.Mono, raw.MonoID);
+}
+
+// Reads the system clocks, ignoring any installed Clock.
+Time SystemNow();
+} // namespace details
+
 /**
  * Operator for fort::myrmidon::Duration multiplication
  * @param a a signed integer
@@ -752,10 +1035,137 @@ private:
  *
  * @return `a*b`
  */
-inline fort::Duration operator*(int64_t a, const fort::Duration &b) {
+inline constexpr fort::Duration
+operator*(int64_t a, const fort::Duration &b) {
 	return a * b.Nanoseconds();
 }
 
+/**
+ * User-defined literals for Duration
+ *
+ * ```c++
+ * using namespace fort::literals;
+ * constexpr fort::Duration period = 100_ms;
+ * constexpr fort::Duration timeout = 1.5_h + 30_s;
+ * constexpr fort::Duration maximum = "4m32s"_d;
+ * ```
+ *
+ * This namespace is inline, `using namespace fort;` also brings them.
+ */
+inline namespace literals {
+
+/**
+ * Hours literal
+ * @param v the number of hours
+ * @return a Duration of v hours
+ */
+constexpr Duration operator""_h(unsigned long long v) {
+	return int64_t(v) * Duration::Hour;
+}
+
+/**
+ * Hours literal
+ * @param v the number of hours
+ * @return a Duration of v hours, truncated to the nanosecond
+ */
+constexpr Duration operator""_h(long double v) {
+	return int64_t(v * Duration::Hour.Nanoseconds());
+}
+
+/**
+ * Minutes literal
+ * @param v the number of minutes
+ * @return a Duration of v minutes
+ */
+constexpr Duration operator""_min(unsigned long long v) {
+	return int64_t(v) * Duration::Minute;
+}
+
+/**
+ * Minutes literal
+ * @param v the number of minutes
+ * @return a Duration of v minutes, truncated to the nanosecond
+ */
+constexpr Duration operator""_min(long double v) {
+	return int64_t(v * Duration::Minute.Nanoseconds());
+}
+
+/**
+ * Seconds literal
+ * @param v the number of seconds
+ * @return a Duration of v seconds
+ */
+constexpr Duration operator""_s(unsigned long long v) {
+	return int64_t(v) * Duration::Second;
+}
+
+/**
+ * Seconds literal
+ * @param v the number of seconds
+ * @return a Duration of v seconds, truncated to the nanosecond
+ */
+constexpr Duration operator""_s(long double v) {
+	return int64_t(v * Duration::Second.Nanoseconds());
+}
+
+/**
+ * Milliseconds literal
+ * @param v the number of milliseconds
+ * @return a Duration of v milliseconds
+ */
+constexpr Duration operator""_ms(unsigned long long v) {
+	return int64_t(v) * Duration::Millisecond;
+}
+
+/**
+ * Milliseconds literal
+ * @param v the number of milliseconds
+ * @return a Duration of v milliseconds, truncated to the nanosecond
+ */
+constexpr Duration operator""_ms(long double v) {
+	return int64_t(v * Duration::Millisecond.Nanoseconds());
+}
+
+/**
+ * Microseconds literal
+ * @param v the number of microseconds
+ * @return a Duration of v microseconds
+ */
+constexpr Duration operator""_us(unsigned long long v) {
+	return int64_t(v) * Duration::Microsecond;
+}
+
+/**
+ * Microseconds literal
+ * @param v the number of microseconds
+ * @return a Duration of v microseconds, truncated to the nanosecond
+ */
+constexpr Duration operator""_us(long double v) {
+	return int64_t(v * Duration::Microsecond.Nanoseconds());
+}
+
+/**
+ * Nanoseconds literal
+ * @param v the number of nanoseconds
+ * @return a Duration of v nanoseconds
+ */
+constexpr Duration operator""_ns(unsigned long long v) {
+	return int64_t(v);
+}
+
+/**
+ * Duration string literal
+ * @param d the string to parse, see Duration::Parse()
+ * @param size the size of d
+ * @return the parsed Duration. In a constant expression, an invalid
+ *         string is a compilation error.
+ */
+constexpr Duration operator""_d(const char *d, size_t size) {
+	return Duration::ParseConstexpr(std::string_view(d, size));
+}
+
+} // namespace literals
+
 /**
  * Formats a Duration
  * @param out the std::ostream to format to
@@ -0,0 +1,592 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#include <sstream>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "CachedClock.hpp"
+#include "ClockMonitor.hpp"
+#include "ClockSource.hpp"
+#include "DurationStats.hpp"
+#include "FrameIndex.hpp"
+#include "GapDetector.hpp"
+#include "Histogram.hpp"
+#include "Join.hpp"
+#include "LeapSeconds.hpp"
+#include "LatencyRegistry.hpp"
+#include "Merge.hpp"
+#include "PackedTime.hpp"
+#include "RateLimiter.hpp"
+#include "Time.hpp"
+#include "TimeColumn.hpp"
+#include "TimerReactor.hpp"
+#include "TimerWheel.hpp"
+#include "Trace.hpp"
+
+// This file is compiled once for each of the shared, static and sources
+// variant of the library, so the same benchmark can be compared across
+// them.
+
+namespace fort {
+
+static std::vector<Time> MakeTimes(size_t n) {
+	std::vector<Time> res;
+	res.reserve(n);
+	auto start = Time::Now();
+	for (size_t i = 0; i < n; ++i) {
+		res.push_back(start.Add(int64_t(i * 1000)));
+	}
+	return res;
+}
+
+static void BM_TimeNow(benchmark::State &state) {
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(Time::Now());
+	}
+}
+
+BENCHMARK(BM_TimeNow);
+
+static void BM_CachedClockNow(benchmark::State &state) {
+	static CachedClock clock(Duration::Millisecond);
+	// one Subscription per benchmark thread
+	CachedClock::Subscription subscription(clock);
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(clock.Now());
+	}
+}
+
+BENCHMARK(BM_CachedClockNow)->ThreadRange(1, 8);
+
+static void BM_SourceClockNow(benchmark::State &state) {
+	SourceClock clock(ClockSource(state.range(0)));
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(clock.Now());
+	}
+}
+
+BENCHMARK(BM_SourceClockNow)->DenseRange(0, 3);
+
+static void BM_TimeBefore(benchmark::State &state) {
+	auto   times = MakeTimes(1024);
+	size_t count = 0;
+	for (auto _ : state) {
+		for (size_t i = 1; i < times.size(); ++i) {
+			count += times[i - 1].Before(times[i]);
+		}
+		benchmark::DoNotOptimize(count);
+	}
+	state.SetItemsProcessed(state.iterations() * (times.size() - 1));
+}
+
+BENCHMARK(BM_TimeBefore);
+
+static void BM_TimeSub(benchmark::State &state) {
+	auto    times = MakeTimes(1024);
+	int64_t sum   = 0;
+	for (auto _ : state) {
+		for (size_t i = 1; i < times.size(); ++i) {
+			sum += times[i].Sub(times[i - 1]).Nanoseconds();
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed(state.iterations() * (times.size() - 1));
+}
+
+BENCHMARK(BM_TimeSub);
+
+static void BM_TimeAdd(benchmark::State &state) {
+	auto t = Time::Now();
+	for (auto _ : state) {
+		t = t.Add(Duration::Microsecond);
+		benchmark::DoNotOptimize(t);
+	}
+}
+
+BENCHMARK(BM_TimeAdd);
+
+static void BM_TimeFormat(benchmark::State &state) {
+	auto t = Time::Now();
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(t.Format());
+	}
+}
+
+BENCHMARK(BM_TimeFormat);
+
+static void BM_TimeParse(benchmark::State &state) {
+	const std::string input = "2023-05-12T14:32:45.123456789Z";
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(Time::Parse(input));
+	}
+}
+
+BENCHMARK(BM_TimeParse);
+
+static void BM_DurationParse(benchmark::State &state) {
+	const std::string input = "1h2m3.004s";
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(Duration::Parse(input));
+	}
+}
+
+BENCHMARK(BM_DurationParse);
+
+static void BM_HistogramRecord(benchmark::State &state) {
+	DurationHistogram h;
+	uint64_t          v = 1;
+	for (auto _ : state) {
+		h.Record(int64_t(v >> 32));
+		v = v * 6364136223846793005ULL + 1442695040888963407ULL;
+	}
+	benchmark::DoNotOptimize(h.Count());
+}
+
+BENCHMARK(BM_HistogramRecord);
+
+static void BM_LatencyRegistryRecord(benchmark::State &state) {
+	static LatencyRegistry registry;
+	auto                   metric = registry.Register("benchmark");
+	uint64_t               v      = 1;
+	for (auto _ : state) {
+		metric.Record(int64_t(v >> 32));
+		v = v * 6364136223846793005ULL + 1442695040888963407ULL;
+	}
+}
+
+BENCHMARK(BM_LatencyRegistryRecord)->ThreadRange(1, 8);
+
+static void BM_TraceSpan(benchmark::State &state) {
+	static TraceRecorder trace;
+	for (auto _ : state) {
+		TraceRecorder::Span span(trace, "benchmark");
+	}
+}
+
+BENCHMARK(BM_TraceSpan)->ThreadRange(1, 8);
+
+static void BM_TimerWheelScheduleCancel(benchmark::State &state) {
+	auto       start = Time::Now();
+	TimerWheel wheel(Duration::Millisecond, start);
+	for (int64_t i = 0; i < state.range(0); ++i) {
+		wheel.Schedule(start.Add(i * Duration::Millisecond), nullptr);
+	}
+	int64_t i = 0;
+	for (auto _ : state) {
+		auto ID = wheel.Schedule(
+		    start.Add((++i % 100000) * Duration::Millisecond),
+		    nullptr
+		);
+		wheel.Cancel(ID);
+	}
+}
+
+BENCHMARK(BM_TimerWheelScheduleCancel)->Range(1 << 4, 1 << 16);
+
+static void BM_TimerReactorScheduleCancel(benchmark::State &state) {
+	auto         start = Time::Now();
+	TimerReactor reactor;
+	for (int64_t i = 0; i < state.range(0); ++i) {
+		reactor.Schedule(start.Add(i * Duration::Millisecond), nullptr);
+	}
+	int64_t i = 0;
+	for (auto _ : state) {
+		auto ID = reactor.Schedule(
+		    start.Add((++i % 100000) * Duration::Millisecond),
+		    nullptr
+		);
+		reactor.Cancel(ID);
+	}
+}
+
+BENCHMARK(BM_TimerReactorScheduleCancel)->Range(1 << 4, 1 << 16);
+
+static void BM_TimerReactorExpire(benchmark::State &state) {
+	// each timer re-schedules itself, as a coroutine sleeping in a loop.
+	TimerReactor          reactor;
+	std::function<void()> reschedule = [&reactor, &reschedule]() {
+		reactor.ScheduleIn(0, reschedule);
+	};
+	for (int64_t i = 0; i < state.range(0); ++i) {
+		reactor.ScheduleIn(0, reschedule);
+	}
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(reactor.RunOnce());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_TimerReactorExpire)->Range(1 << 4, 1 << 12);
+
+static void BM_TokenBucketTryAcquire(benchmark::State &state) {
+	static TokenBucket bucket(Duration::Nanosecond, 1000000);
+	auto               now = Time::Now();
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(bucket.TryAcquire(now));
+	}
+}
+
+BENCHMARK(BM_TokenBucketTryAcquire)->ThreadRange(1, 8);
+
+static void BM_SlidingWindowTryAcquire(benchmark::State &state) {
+	static SlidingWindowLimiter limiter(Duration::Millisecond, 1000000);
+	auto                        now = Time::Now();
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(limiter.TryAcquire(now));
+	}
+}
+
+BENCHMARK(BM_SlidingWindowTryAcquire)->ThreadRange(1, 8);
+
+static std::vector<std::vector<Time>> MergeSources(size_t k) {
+	std::vector<std::vector<Time>> res(k);
+	auto                           start = Time::Now();
+	uint64_t                       seed  = 42;
+	for (size_t i = 0; i < k; ++i) {
+		int64_t t = 0;
+		for (size_t j = 0; j < 4096; ++j) {
+			seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+			t += (seed >> 33) % 1000000;
+			res[i].push_back(Time::FromTimestampAndMonotonic(
+			    start.Add(t).ToTimestamp(),
+			    t,
+			    i + 1
+			));
+		}
+	}
+	return res;
+}
+
+static void BM_TimeMerge(benchmark::State &state) {
+	auto sources = MergeSources(state.range(0));
+	typedef std::vector<Time>::const_iterator  Iterator;
+	std::vector<std::pair<Iterator, Iterator>> ranges;
+	for (const auto &s : sources) {
+		ranges.push_back({s.begin(), s.end()});
+	}
+	std::vector<Time> merged;
+	merged.reserve(4096 * sources.size());
+	for (auto _ : state) {
+		merged.clear();
+		TimeMerge merge(ranges);
+		merge.Drain(std::back_inserter(merged));
+	}
+	state.SetItemsProcessed(state.iterations() * merged.size());
+}
+
+BENCHMARK(BM_TimeMerge)->RangeMultiplier(4)->Range(2, 128);
+
+static void BM_TimeConcatSort(benchmark::State &state) {
+	auto              sources = MergeSources(state.range(0));
+	std::vector<Time> merged;
+	merged.reserve(4096 * sources.size());
+	for (auto _ : state) {
+		merged.clear();
+		for (const auto &s : sources) {
+			merged.insert(merged.end(), s.begin(), s.end());
+		}
+		std::stable_sort(
+		    merged.begin(),
+		    merged.end(),
+		    [](const Time &a, const Time &b) { return a.Before(b); }
+		);
+	}
+	state.SetItemsProcessed(state.iterations() * merged.size());
+}
+
+BENCHMARK(BM_TimeConcatSort)->RangeMultiplier(4)->Range(2, 128);
+
+static std::vector<Duration> MakeDurations(size_t n) {
+	std::vector<Duration> res;
+	res.reserve(n);
+	uint64_t seed = 42;
+	for (size_t i = 0; i < n; ++i) {
+		seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+		res.push_back(int64_t((seed >> 33) % 100000000));
+	}
+	return res;
+}
+
+static void BM_DurationStatsGetters(benchmark::State &state) {
+	auto durations = MakeDurations(state.range(0));
+	for (auto _ : state) {
+		double sum = 0.0, squares = 0.0;
+		for (const auto &d : durations) {
+			double ms = d.Milliseconds();
+			sum += ms;
+			squares += ms * ms;
+		}
+		benchmark::DoNotOptimize(sum);
+		benchmark::DoNotOptimize(squares);
+	}
+	state.SetItemsProcessed(state.iterations() * durations.size());
+}
+
+BENCHMARK(BM_DurationStatsGetters)->Range(1 << 10, 1 << 22);
+
+static void BM_DurationStats(benchmark::State &state) {
+	auto durations = MakeDurations(state.range(0));
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(ComputeDurationStats(durations));
+	}
+	state.SetItemsProcessed(state.iterations() * durations.size());
+}
+
+BENCHMARK(BM_DurationStats)->Range(1 << 10, 1 << 22);
+
+static void BM_DurationCountAbove(benchmark::State &state) {
+	auto durations = MakeDurations(state.range(0));
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(
+		    CountDurationsAbove(durations, 50 * Duration::Millisecond)
+		);
+	}
+	state.SetItemsProcessed(state.iterations() * durations.size());
+}
+
+BENCHMARK(BM_DurationCountAbove)->Range(1 << 10, 1 << 22);
+
+static void BM_GapDetector(benchmark::State &state) {
+	// an hour at 30 fps for 10 cameras, with a drop every 1000 frames.
+	const int64_t     period = 33333333;
+	auto              start  = Time::FromUnix(1700000000, 0);
+	std::vector<Time> frames;
+	frames.reserve(10 * 108000);
+	for (Time::MonoclockID camera = 1; camera <= 10; ++camera) {
+		for (int64_t i = 0; i < 108000; ++i) {
+			if (i % 1000 == 999) {
+				continue;
+			}
+			frames.push_back(Time::FromTimestampAndMonotonic(
+			    start.Add(i * period).ToTimestamp(),
+			    i * period,
+			    camera
+			));
+		}
+	}
+	std::vector<FrameGap> gaps;
+	for (auto _ : state) {
+		gaps.clear();
+		GapDetector detector(period, Duration::Millisecond);
+		detector.Add(frames, gaps);
+	}
+	state.SetItemsProcessed(state.iterations() * frames.size());
+}
+
+BENCHMARK(BM_GapDetector)->Unit(benchmark::kMillisecond);
+
+static std::vector<Time> FrameEvents(const Time &start, size_t n) {
+	std::vector<Time> res;
+	res.reserve(n);
+	uint64_t seed = 42;
+	for (size_t i = 0; i < n; ++i) {
+		seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+		res.push_back(start.Add(int64_t((seed >> 33) % Duration::Hour.Nanoseconds())));
+	}
+	return res;
+}
+
+static void BM_FrameIndexSubDivide(benchmark::State &state) {
+	auto                 start  = Time::Now();
+	auto                 events = FrameEvents(start, 1 << 16);
+	std::vector<int64_t> indices(events.size());
+	// a runtime period, as in FrameIndexer.
+	int64_t period = 33333333;
+	benchmark::DoNotOptimize(period);
+	for (auto _ : state) {
+		for (size_t i = 0; i < events.size(); ++i) {
+			indices[i] = events[i].Sub(start).Nanoseconds() / period;
+		}
+		benchmark::DoNotOptimize(indices.data());
+	}
+	state.SetItemsProcessed(state.iterations() * events.size());
+}
+
+BENCHMARK(BM_FrameIndexSubDivide);
+
+static void BM_FrameIndexer(benchmark::State &state) {
+	auto                 start  = Time::Now();
+	auto                 events = FrameEvents(start, 1 << 16);
+	FrameIndexer         indexer(start, 33333333);
+	std::vector<int64_t> indices;
+	for (auto _ : state) {
+		indexer.ToIndices(events, indices);
+		benchmark::DoNotOptimize(indices.data());
+	}
+	state.SetItemsProcessed(state.iterations() * events.size());
+}
+
+BENCHMARK(BM_FrameIndexer);
+
+static void BM_JoinBinarySearch(benchmark::State &state) {
+	auto left  = MakeTimes(state.range(0));
+	auto right = MakeTimes(state.range(0));
+	auto before = [](const Time &a, const Time &b) { return a.Before(b); };
+	std::vector<std::pair<size_t, size_t>> matches;
+	for (auto _ : state) {
+		matches.clear();
+		for (size_t i = 0; i < left.size(); ++i) {
+			auto fi = std::upper_bound(right.begin(), right.end(), left[i], before);
+			if (fi != right.begin()) {
+				matches.push_back({i, fi - 1 - right.begin()});
+			}
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * left.size());
+}
+
+BENCHMARK(BM_JoinBinarySearch)->Range(1 << 10, 1 << 20);
+
+static void BM_AsOfJoin(benchmark::State &state) {
+	auto left  = MakeTimes(state.range(0));
+	auto right = MakeTimes(state.range(0));
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(AsOfJoin(left, right));
+	}
+	state.SetItemsProcessed(state.iterations() * left.size());
+}
+
+BENCHMARK(BM_AsOfJoin)->Range(1 << 10, 1 << 20);
+
+static std::string MakeTimeCSV(size_t n) {
+	std::ostringstream oss;
+	oss << "frame,time,tags\n";
+	auto t = Time::FromUnix(1700000000, 0);
+	for (size_t i = 0; i < n; ++i) {
+		t = t.Add(33333333);
+		oss << i << "," << t.Format() << ",12\n";
+	}
+	return oss.str();
+}
+
+static void BM_TimeParseLines(benchmark::State &state) {
+	auto csv = MakeTimeCSV(1 << 16);
+	for (auto _ : state) {
+		std::istringstream iss(csv);
+		std::string        line;
+		std::vector<Time>  times;
+		std::getline(iss, line);
+		while (std::getline(iss, line)) {
+			auto first = line.find(',');
+			auto last  = line.find(',', first + 1);
+			times.push_back(Time::Parse(line.substr(first + 1, last - first - 1)));
+		}
+		benchmark::DoNotOptimize(times);
+	}
+	state.SetBytesProcessed(state.iterations() * csv.size());
+}
+
+BENCHMARK(BM_TimeParseLines)->Unit(benchmark::kMillisecond);
+
+static void BM_ParseTimeColumn(benchmark::State &state) {
+	auto              csv = MakeTimeCSV(1 << 16);
+	TimeColumnOptions options;
+	options.Column  = "time";
+	options.Threads = state.range(0);
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(ParseTimeColumn(csv, options));
+	}
+	state.SetBytesProcessed(state.iterations() * csv.size());
+}
+
+BENCHMARK(BM_ParseTimeColumn)
+    ->Unit(benchmark::kMillisecond)
+    ->RangeMultiplier(2)
+    ->Range(1, 8);
+
+static void BM_TimePacker(benchmark::State &state) {
+	auto            times = MakeTimes(state.range(0));
+	pb::PackedTimes packed;
+	std::string     data;
+	for (auto _ : state) {
+		TimePacker::Pack(times, &packed);
+		packed.SerializeToString(&data);
+		packed.ParseFromString(data);
+		TimePacker::Unpack(packed, times);
+	}
+	state.SetItemsProcessed(state.iterations() * times.size());
+	state.counters["bytes_per_time"] = double(data.size()) / times.size();
+}
+
+BENCHMARK(BM_TimePacker)->Range(1 << 10, 1 << 16);
+
+static void BM_ClockMonitor(benchmark::State &state) {
+	auto                    frames = MakeTimes(1 << 16);
+	std::vector<ClockEvent> events;
+	for (auto _ : state) {
+		ClockMonitor monitor;
+		events.clear();
+		benchmark::DoNotOptimize(monitor.Add(frames, events));
+	}
+	state.SetItemsProcessed(state.iterations() * frames.size());
+}
+
+BENCHMARK(BM_ClockMonitor);
+
+static std::vector<Time> MakeWallTimes(size_t n) {
+	auto times = MakeTimes(n);
+	for (auto &t : times) {
+		t = t.Round(Duration::Nanosecond);
+	}
+	return times;
+}
+
+static void BM_TimeWallSub(benchmark::State &state) {
+	auto    times = MakeWallTimes(1 << 16);
+	int64_t sum   = 0;
+	for (auto _ : state) {
+		for (size_t i = 1; i < times.size(); ++i) {
+			sum += times[i].Sub(times[i - 1]).Nanoseconds();
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed(state.iterations() * (times.size() - 1));
+}
+
+BENCHMARK(BM_TimeWallSub);
+
+static void BM_LeapSecondSub(benchmark::State &state) {
+	auto        times = MakeWallTimes(1 << 16);
+	const auto &table = LeapSecondTable::Embedded();
+	int64_t     sum   = 0;
+	for (auto _ : state) {
+		for (size_t i = 1; i < times.size(); ++i) {
+			sum += table.Sub(times[i], times[i - 1]).Nanoseconds();
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed(state.iterations() * (times.size() - 1));
+}
+
+BENCHMARK(BM_LeapSecondSub);
+
+static void BM_LeapSecondToTAI(benchmark::State &state) {
+	auto        times = MakeTimes(1 << 16);
+	const auto &table = LeapSecondTable::Embedded();
+	for (auto _ : state) {
+		table.ToTAI(times);
+		table.ToUTC(times);
+	}
+	state.SetItemsProcessed(state.iterations() * times.size() * 2);
+}
+
+BENCHMARK(BM_LeapSecondToTAI);
+
+} // namespace fort
@@ -0,0 +1,339 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "TimeColumn.hpp"
+#include "TimeCounters.hpp"
+
+namespace fort {
+
+namespace {
+
+// Seconds of 0001-01-01T00:00:00Z and 9999-12-31T23:59:59Z, the
+// google.protobuf.Timestamp range.
+const int64_t MIN_SECONDS = -62135596800LL;
+const int64_t MAX_SECONDS = 253402300799LL;
+
+// Minimal size of a chunk parsed by a thread.
+const size_t MIN_CHUNK = 1 << 20;
+
+// Parses exactly n digits.
+inline bool Digits(const char *&p, const char *end, int n, int &value) {
+	if (end - p < n) {
+		return false;
+	}
+	value = 0;
+	for (int i = 0; i < n; ++i, ++p) {
+		unsigned d = unsigned(*p - '0');
+		if (d > 9) {
+			return false;
+		}
+		value = value * 10 + d;
+	}
+	return true;
+}
+
+inline bool Expect(const char *&p, const char *end, char c) {
+	if (p == end || *p != c) {
+		return false;
+	}
+	++p;
+	return true;
+}
+
+inline bool IsLeapYear(int y) {
+	return (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+}
+
+inline int DaysInMonth(int y, int m) {
+	static const int days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+	return m == 2 && IsLeapYear(y) ? 29 : days[m - 1];
+}
+
+// Days since 1970-01-01 of a proleptic Gregorian date, from
+// H. Hinnant's days_from_civil.
+inline int64_t DaysFromCivil(int64_t y, int m, int d) {
+	y -= m <= 2;
+	int64_t  era = (y >= 0 ? y : y - 399) / 400;
+	unsigned yoe = unsigned(y - era * 400);
+	unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+	unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+	return era * 146097 + int64_t(doe) - 719468;
+}
+
+struct Line {
+	const char *Begin, *End;
+};
+
+// Finds the column of a line, stripping quotes.
+inline bool
+Field(Line line, char delimiter, size_t column, std::string_view &field) {
+	const char *p = line.Begin;
+	for (size_t i = 0; i < column; ++i) {
+		p = static_cast<const char *>(memchr(p, delimiter, line.End - p));
+		if (p == nullptr) {
+			return false;
+		}
+		++p;
+	}
+	const char *e =
+	    static_cast<const char *>(memchr(p, delimiter, line.End - p));
+	if (e == nullptr) {
+		e = line.End;
+	}
+	if (e - p >= 2 && *p == '"' && *(e - 1) == '"') {
+		++p;
+		--e;
+	}
+	field = std::string_view(p, e - p);
+	return true;
+}
+
+// Splits the next line of [p,end), without its line ending.
+inline Line NextLine(const char *&p, const char *end) {
+	const char *nl = static_cast<const char *>(memchr(p, '\n', end - p));
+	Line        res{p, nl == nullptr ? end : nl};
+	p = nl == nullptr ? end : nl + 1;
+	if (res.End != res.Begin && *(res.End - 1) == '\r') {
+		--res.End;
+	}
+	return res;
+}
+
+size_t CountLines(const char *p, const char *end) {
+	size_t res = 0;
+	while (p < end) {
+		NextLine(p, end);
+		++res;
+	}
+	return res;
+}
+
+size_t FindColumn(Line header, const TimeColumnOptions &options) {
+	if (options.Column.empty()) {
+		return options.ColumnIndex;
+	}
+	if (options.Header == false) {
+		throw std::invalid_argument(
+		    "a named column ('" + options.Column + "') requires a header"
+		);
+	}
+	std::string_view field;
+	for (size_t i = 0; Field(header, options.Delimiter, i, field); ++i) {
+		if (field == options.Column) {
+			return i;
+		}
+	}
+	throw std::invalid_argument(
+	    "no column '" + options.Column + "' in header '" +
+	    std::string(header.Begin, header.End) + "'"
+	);
+}
+
+} // namespace
+
+// TryParseTime() without counting failures.
+static inline TimeParseStatus ParseTime(std::string_view input, Time &t) {
+	const char *p   = input.data();
+	const char *end = p + input.size();
+	int         year, month, day, hour, minute, second;
+	if (Digits(p, end, 4, year) == false || Expect(p, end, '-') == false ||
+	    Digits(p, end, 2, month) == false || Expect(p, end, '-') == false ||
+	    Digits(p, end, 2, day) == false || Expect(p, end, 'T') == false ||
+	    Digits(p, end, 2, hour) == false || Expect(p, end, ':') == false ||
+	    Digits(p, end, 2, minute) == false || Expect(p, end, ':') == false ||
+	    Digits(p, end, 2, second) == false) {
+		return TimeParseStatus::INVALID_FORMAT;
+	}
+	if (year < 1 || month < 1 || month > 12 || day < 1 ||
+	    day > DaysInMonth(year, month) || hour > 23 || minute > 59 ||
+	    second > 59) {
+		return TimeParseStatus::INVALID_FORMAT;
+	}
+
+	int32_t nanos = 0;
+	if (p != end && *p == '.') {
+		++p;
+		// only the first nine digits are significant.
+		int digits = 0;
+		for (; p != end && unsigned(*p - '0') <= 9; ++p, ++digits) {
+			if (digits < 9) {
+				nanos = nanos * 10 + (*p - '0');
+			}
+		}
+		if (digits == 0) {
+			return TimeParseStatus::INVALID_FORMAT;
+		}
+		for (; digits < 9; ++digits) {
+			nanos *= 10;
+		}
+	}
+
+	int64_t offset = 0;
+	if (Expect(p, end, 'Z') == false) {
+		if (p == end || (*p != '+' && *p != '-')) {
+			return TimeParseStatus::INVALID_FORMAT;
+		}
+		int sign = *p++ == '+' ? 1 : -1;
+		int offsetHour, offsetMinute;
+		if (Digits(p, end, 2, offsetHour) == false ||
+		    Expect(p, end, ':') == false ||
+		    Digits(p, end, 2, offsetMinute) == false || offsetHour > 23 ||
+		    offsetMinute > 59) {
+			return TimeParseStatus::INVALID_FORMAT;
+		}
+		offset = sign * (offsetHour * 3600 + offsetMinute * 60);
+	}
+	if (p != end) {
+		return TimeParseStatus::INVALID_FORMAT;
+	}
+
+	int64_t seconds = DaysFromCivil(year, month, day) * 86400 + hour * 3600 +
+	                  minute * 60 + second - offset;
+	if (seconds < MIN_SECONDS || seconds > MAX_SECONDS) {
+		return TimeParseStatus::OUT_OF_RANGE;
+	}
+	t = Time::FromUnix(seconds, nanos);
+	return TimeParseStatus::OK;
+}
+
+TimeParseStatus TryParseTime(std::string_view input, Time &t) {
+	auto res = ParseTime(input, t);
+	if (res != TimeParseStatus::OK) {
+		details::CountTime(TimeCounter::TIME_TRY_PARSE_FAILURE);
+	}
+	return res;
+}
+
+MappedFile::MappedFile(const std::string &path)
+    : d_data(nullptr)
+    , d_size(0) {
+	int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		throw std::system_error(errno, std::generic_category(), "open " + path);
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		int err = errno;
+		close(fd);
+		throw std::system_error(err, std::generic_category(), "stat " + path);
+	}
+	d_size = st.st_size;
+	if (d_size > 0) {
+		void *data = mmap(nullptr, d_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data == MAP_FAILED) {
+			int err = errno;
+			close(fd);
+			throw std::system_error(
+			    err,
+			    std::generic_category(),
+			    "mmap " + path
+			);
+		}
+		madvise(data, d_size, MADV_SEQUENTIAL);
+		d_data = static_cast<const char *>(data);
+	}
+	close(fd);
+}
+
+MappedFile::~MappedFile() {
+	if (d_data != nullptr) {
+		munmap(const_cast<char *>(d_data), d_size);
+	}
+}
+
+TimeColumn
+ParseTimeColumn(std::string_view text, const TimeColumnOptions &options) {
+	const char *begin = text.data();
+	const char *end   = begin + text.size();
+	Line        header{begin, begin};
+	if (options.Header == true && begin != end) {
+		header = NextLine(begin, end);
+	}
+	size_t column = FindColumn(header, options);
+
+	// newline-aligned chunks
+	size_t size   = end - begin;
+	size_t chunks = std::max(
+	    std::min(options.Threads, size / MIN_CHUNK),
+	    size_t(1)
+	);
+	std::vector<const char *> bounds = {begin};
+	for (size_t c = 1; c < chunks; ++c) {
+		const char *p = std::max(begin + c * size / chunks, bounds.back());
+		const char *nl =
+		    static_cast<const char *>(memchr(p, '\n', end - p));
+		bounds.push_back(nl == nullptr ? end : nl + 1);
+	}
+	bounds.push_back(end);
+
+	auto parallel = [chunks](auto fn) {
+		std::vector<std::thread> workers;
+		for (size_t c = 1; c < chunks; ++c) {
+			workers.emplace_back(fn, c);
+		}
+		fn(0);
+		for (auto &w : workers) {
+			w.join();
+		}
+	};
+
+	std::vector<size_t> rows(chunks + 1, 0);
+	parallel([&](size_t c) {
+		rows[c + 1] = CountLines(bounds[c], bounds[c + 1]);
+	});
+	for (size_t c = 0; c < chunks; ++c) {
+		rows[c + 1] += rows[c];
+	}
+
+	TimeColumn                                res;
+	std::vector<std::vector<TimeColumnError>> errors(chunks);
+	res.Times.resize(rows.back());
+	parallel([&](size_t c) {
+		const char *p   = bounds[c];
+		size_t      row = rows[c];
+		for (; p < bounds[c + 1]; ++row) {
+			std::string_view field;
+			TimeParseStatus  status = TimeParseStatus::MISSING_COLUMN;
+			Line             line   = NextLine(p, bounds[c + 1]);
+			if (Field(line, options.Delimiter, column, field)) {
+				status = TryParseTime(field, res.Times[row]);
+			}
+			if (status != TimeParseStatus::OK) {
+				errors[c].push_back({row, status});
+			}
+		}
+	});
+	for (const auto &e : errors) {
+		res.Errors.insert(res.Errors.end(), e.begin(), e.end());
+	}
+	return res;
+}
+
+} // namespace fort
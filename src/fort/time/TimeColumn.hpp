@@ -0,0 +1,190 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Time.hpp"
+
+namespace fort {
+
+/**
+ * The outcome of parsing a Time
+ */
+enum class TimeParseStatus : uint8_t {
+	/**
+	 * The Time was parsed.
+	 */
+	OK = 0,
+	/**
+	 * The row has no such column.
+	 */
+	MISSING_COLUMN,
+	/**
+	 * The field is not a RFC 3339 date.
+	 */
+	INVALID_FORMAT,
+	/**
+	 * The date is not within years 0001 to 9999, as for
+	 * Time::ToTimestamp().
+	 */
+	OUT_OF_RANGE,
+};
+
+/**
+ * Parses a RFC 3339 date without allocating or throwing
+ *
+ * Accepts the same `1972-01-01T10:00:20.021-05:00` strings as
+ * Time::Parse(), except that each date and time field must have
+ * exactly its two or four digits.
+ *
+ * @param input the string to parse
+ * @param t set to the parsed Time on success
+ *
+ * @return TimeParseStatus::OK on success, or the reason of the failure.
+ */
+TimeParseStatus TryParseTime(std::string_view input, Time &t);
+
+/**
+ * A read-only memory mapped file
+ */
+class MappedFile {
+public:
+	/**
+	 * Maps a file
+	 *
+	 * @param path the path of the file to map
+	 *
+	 * @throws std::system_error if the file cannot be opened or mapped.
+	 */
+	MappedFile(const std::string &path);
+	/**
+	 * Unmaps the file.
+	 */
+	~MappedFile();
+
+	MappedFile(const MappedFile &)            = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	/**
+	 * Gets the content of the file
+	 *
+	 * @return the mapped file content.
+	 */
+	inline std::string_view Content() const {
+		return std::string_view(d_data, d_size);
+	}
+
+private:
+	const char *d_data;
+	size_t      d_size;
+};
+
+/**
+ * Options of ParseTimeColumn()
+ */
+struct TimeColumnOptions {
+	/**
+	 * The field delimiter, e.g. `','` for CSV or `'\t'` for TSV.
+	 */
+	char Delimiter = ',';
+	/**
+	 * If the first line is a header. It is not a row.
+	 */
+	bool Header = true;
+	/**
+	 * The name of the column to parse. Requires Header. If empty,
+	 * ColumnIndex is used instead.
+	 */
+	std::string Column;
+	/**
+	 * The zero-based index of the column to parse.
+	 */
+	size_t ColumnIndex = 0;
+	/**
+	 * The maximal number of threads to use.
+	 */
+	size_t Threads = 1;
+};
+
+/**
+ * An error on a row of a parsed column
+ */
+struct TimeColumnError {
+	/**
+	 * The zero-based index of the row, the header excluded.
+	 */
+	size_t Row;
+	/**
+	 * The reason of the failure.
+	 */
+	TimeParseStatus Status;
+};
+
+/**
+ * A parsed Time column
+ */
+struct TimeColumn {
+	/**
+	 * The Time of each row. Rows in error hold a default Time.
+	 */
+	std::vector<Time> Times;
+	/**
+	 * The rows in error, in row order.
+	 */
+	std::vector<TimeColumnError> Errors;
+};
+
+/**
+ * Parses a Time column of delimited text
+ *
+ * The text is split in newline-aligned chunks parsed in parallel,
+ * first counting rows to write each Time in place. Fields are parsed
+ * with TryParseTime(), so parsing does not allocate per row, and
+ * invalid rows are reported in TimeColumn::Errors instead of
+ * throwing.
+ *
+ * Lines end with `\n` or `\r\n`, and a field may be enclosed in
+ * double quotes. Quoted fields containing delimiters or newlines are
+ * not supported.
+ *
+ * ```c++
+ * using namespace fort;
+ * MappedFile file("frames.csv");
+ * TimeColumnOptions options;
+ * options.Column = "time";
+ * options.Threads = 8;
+ * auto column = ParseTimeColumn(file.Content(), options);
+ * ```
+ *
+ * @param text the text to parse
+ * @param options the TimeColumnOptions
+ *
+ * @return the parsed TimeColumn
+ *
+ * @throws std::invalid_argument if the named column is not in the
+ *         header.
+ */
+TimeColumn
+ParseTimeColumn(std::string_view text, const TimeColumnOptions &options);
+
+} // namespace fort
@@ -0,0 +1,188 @@
+#include "TimeColumn.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+#include "TimeColumnUTest.hpp"
+
+namespace fort {
+
+TEST_F(TimeColumnUTest, ParsesLikeTimeParse) {
+	std::vector<std::string> testdata = {
+	    "1970-01-01T00:00:00Z",
+	    "1972-01-01T10:00:20.021-05:00",
+	    "2019-11-02T23:12:13.000343+01:00",
+	    "2000-02-29T23:59:59.999999999Z",
+	    "2023-05-12T14:32:45.123456789123Z",
+	    "1900-03-01T00:00:00.1Z",
+	    "0001-01-01T00:00:00Z",
+	    "9999-12-31T23:59:59.999999999Z",
+	    "0001-01-01T00:00:00-01:00",
+	    "9999-12-31T22:59:59+01:00",
+	};
+
+	for (const auto &input : testdata) {
+		SCOPED_TRACE(input);
+		Time t;
+		EXPECT_EQ(TryParseTime(input, t), TimeParseStatus::OK);
+		EXPECT_TRUE(t.Equals(Time::Parse(input)));
+	}
+
+	std::mt19937 rng(42);
+	for (size_t i = 0; i < 1000; ++i) {
+		auto expected = Time::FromUnix(
+		    int64_t(rng() % 8000000000ULL) - 2000000000LL,
+		    rng() % 1000000000
+		);
+		Time t;
+		ASSERT_EQ(TryParseTime(expected.Format(), t), TimeParseStatus::OK);
+		EXPECT_TRUE(t.Equals(expected)) << expected;
+	}
+}
+
+TEST_F(TimeColumnUTest, RejectsInvalidDates) {
+	std::vector<std::pair<std::string, TimeParseStatus>> testdata = {
+	    {"", TimeParseStatus::INVALID_FORMAT},
+	    {"2015-5-20T00:00:00Z", TimeParseStatus::INVALID_FORMAT},
+	    {"2015-05-20t00:00:00Z", TimeParseStatus::INVALID_FORMAT},
+	    {"2015-05-20 00:00:00Z", TimeParseStatus::INVALID_FORMAT},
+	    {"2015-05-20T00:00:00", TimeParseStatus::INVALID_FORMAT},
+	    {"2015-05-20T00:00:00z", TimeParseStatus::INVALID_FORMAT},
+	    {"2015-05-20T00:00:00.Z", TimeParseStatus::INVALID_FORMAT},
+	    {"2015-05-20T00:00:00Zfoo", TimeParseStatus::INVALID_FORMAT},
+	    {"2015-05-20T00:00:00+0100", TimeParseStatus::INVALID_FORMAT},
+	    {"2015-05-20T00:00:00+24:00", TimeParseStatus::INVALID_FORMAT},
+	    {"2015-13-20T00:00:00Z", TimeParseStatus::INVALID_FORMAT},
+	    {"2015-02-29T00:00:00Z", TimeParseStatus::INVALID_FORMAT},
+	    {"2015-04-31T00:00:00Z", TimeParseStatus::INVALID_FORMAT},
+	    {"2015-05-20T24:00:00Z", TimeParseStatus::INVALID_FORMAT},
+	    {"2015-05-20T00:60:00Z", TimeParseStatus::INVALID_FORMAT},
+	    {"2015-05-20T00:00:60Z", TimeParseStatus::INVALID_FORMAT},
+	    {"0000-01-01T00:00:00Z", TimeParseStatus::INVALID_FORMAT},
+	    {"0001-01-01T00:00:00+01:00", TimeParseStatus::OUT_OF_RANGE},
+	    {"9999-12-31T23:59:59-01:00", TimeParseStatus::OUT_OF_RANGE},
+	};
+
+	for (const auto &[input, expected] : testdata) {
+		SCOPED_TRACE(input);
+		Time t = Time::FromUnix(42, 0);
+		EXPECT_EQ(TryParseTime(input, t), expected);
+		EXPECT_TRUE(t.Equals(Time::FromUnix(42, 0)));
+	}
+}
+
+TEST_F(TimeColumnUTest, ParsesColumns) {
+	std::string csv = "frame,\"time\",comment\r\n"
+	                  "0,\"2023-05-12T14:32:45Z\",a\r\n"
+	                  "1,2023-05-12T14:32:46.5Z,b\r\n"
+	                  "2,2023-05-12 14:32:47,c\r\n"
+	                  "3\r\n"
+	                  "\r\n"
+	                  "5,2023-05-12T14:32:49+02:00";
+
+	TimeColumnOptions options;
+	options.Column = "time";
+	auto res       = ParseTimeColumn(csv, options);
+	ASSERT_EQ(res.Times.size(), 6);
+	EXPECT_TRUE(res.Times[0].Equals(Time::Parse("2023-05-12T14:32:45Z")));
+	EXPECT_TRUE(res.Times[1].Equals(Time::Parse("2023-05-12T14:32:46.5Z")));
+	EXPECT_TRUE(res.Times[5].Equals(Time::Parse("2023-05-12T12:32:49Z")));
+	ASSERT_EQ(res.Errors.size(), 3);
+	EXPECT_EQ(res.Errors[0].Row, 2);
+	EXPECT_EQ(res.Errors[0].Status, TimeParseStatus::INVALID_FORMAT);
+	EXPECT_EQ(res.Errors[1].Row, 3);
+	EXPECT_EQ(res.Errors[1].Status, TimeParseStatus::MISSING_COLUMN);
+	EXPECT_EQ(res.Errors[2].Row, 4);
+	EXPECT_EQ(res.Errors[2].Status, TimeParseStatus::MISSING_COLUMN);
+
+	std::string tsv = "2023-05-12T14:32:45Z\t0\n"
+	                  "2023-05-12T14:32:46Z\t1\n";
+	options           = TimeColumnOptions();
+	options.Delimiter = '\t';
+	options.Header    = false;
+	res               = ParseTimeColumn(tsv, options);
+	ASSERT_EQ(res.Times.size(), 2);
+	EXPECT_TRUE(res.Errors.empty());
+	EXPECT_TRUE(res.Times[1].Equals(Time::Parse("2023-05-12T14:32:46Z")));
+
+	options.ColumnIndex = 1;
+	res                 = ParseTimeColumn(tsv, options);
+	ASSERT_EQ(res.Errors.size(), 2);
+	EXPECT_EQ(res.Errors[1].Status, TimeParseStatus::INVALID_FORMAT);
+
+	options.ColumnIndex = 2;
+	res                 = ParseTimeColumn(tsv, options);
+	ASSERT_EQ(res.Errors.size(), 2);
+	EXPECT_EQ(res.Errors[1].Status, TimeParseStatus::MISSING_COLUMN);
+
+	EXPECT_TRUE(ParseTimeColumn("", options).Times.empty());
+
+	options        = TimeColumnOptions();
+	options.Column = "timestamp";
+	EXPECT_THROW(ParseTimeColumn(csv, options), std::invalid_argument);
+	options.Header = false;
+	EXPECT_THROW(ParseTimeColumn(csv, options), std::invalid_argument);
+}
+
+TEST_F(TimeColumnUTest, ThreadsDoNotChangeResult) {
+	std::ostringstream oss;
+	oss << "frame,time\n";
+	auto         t = Time::FromUnix(1700000000, 0);
+	std::mt19937 rng(42);
+	for (size_t i = 0; i < 200000; ++i) {
+		t = t.Add(int64_t(rng() % 100000000));
+		if (rng() % 1000 == 0) {
+			oss << i << ",garbage\n";
+		} else {
+			oss << i << "," << t.Format() << "\n";
+		}
+	}
+	auto csv = oss.str();
+
+	TimeColumnOptions options;
+	options.Column = "time";
+	auto expected  = ParseTimeColumn(csv, options);
+	EXPECT_EQ(expected.Times.size(), 200000);
+	EXPECT_FALSE(expected.Errors.empty());
+	for (size_t threads : {2, 3, 8}) {
+		SCOPED_TRACE(threads);
+		options.Threads = threads;
+		auto res        = ParseTimeColumn(csv, options);
+		ASSERT_EQ(res.Times.size(), expected.Times.size());
+		for (size_t i = 0; i < res.Times.size(); ++i) {
+			ASSERT_TRUE(res.Times[i].Equals(expected.Times[i])) << i;
+		}
+		ASSERT_EQ(res.Errors.size(), expected.Errors.size());
+		for (size_t i = 0; i < res.Errors.size(); ++i) {
+			EXPECT_EQ(res.Errors[i].Row, expected.Errors[i].Row);
+		}
+	}
+}
+
+TEST_F(TimeColumnUTest, MapsFiles) {
+	std::string path = ::testing::TempDir() + "/fort-time-column.csv";
+	{
+		std::ofstream file(path);
+		file << "time\n2023-05-12T14:32:45Z\n";
+	}
+	{
+		MappedFile file(path);
+		EXPECT_EQ(file.Content(), "time\n2023-05-12T14:32:45Z\n");
+		TimeColumnOptions options;
+		options.Column = "time";
+		auto res       = ParseTimeColumn(file.Content(), options);
+		ASSERT_EQ(res.Times.size(), 1);
+		EXPECT_TRUE(res.Times[0].Equals(Time::Parse("2023-05-12T14:32:45Z")));
+	}
+	{ std::ofstream file(path); }
+	{
+		MappedFile file(path);
+		EXPECT_TRUE(file.Content().empty());
+	}
+	std::remove(path.c_str());
+	EXPECT_THROW(MappedFile{path}, std::system_error);
+}
+
+} // namespace fort
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+namespace fort {
+
+class TimeColumnUTest : public ::testing::Test {};
+
+} // namespace fort
@@ -0,0 +1,125 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+#include "TimeCounters.hpp"
+
+namespace fort {
+
+#if FORT_TIME_ENABLE_COUNTERS
+namespace {
+
+// Counters of the running threads, and the sum of the exited ones.
+struct ThreadTimeCountersList {
+	std::mutex                                 Mutex;
+	std::vector<details::ThreadTimeCounters *> Threads;
+	TimeCounters                               Exited;
+};
+
+ThreadTimeCountersList &List() {
+	// never destroyed, as threads may exit after static destructors.
+	static auto list = new ThreadTimeCountersList();
+	return *list;
+}
+
+// Folds the counters of the exiting thread in the exited ones.
+struct ThreadExit {
+	~ThreadExit() {
+		auto &counters = details::t_timeCounters;
+		{
+			auto                       &list = List();
+			std::lock_guard<std::mutex> lock(list.Mutex);
+			for (size_t i = 0; i < size_t(TimeCounter::SIZE); ++i) {
+				list.Exited.Values[i] +=
+				    counters.Values[i].load(std::memory_order_relaxed);
+			}
+			list.Threads.erase(
+			    std::find(list.Threads.begin(), list.Threads.end(), &counters)
+			);
+		}
+		counters.Registration = details::ThreadTimeCounters::EXITED;
+	}
+};
+
+} // namespace
+
+namespace details {
+
+thread_local ThreadTimeCounters t_timeCounters;
+
+void RegisterThreadTimeCounters() {
+	if (t_timeCounters.Registration != ThreadTimeCounters::UNREGISTERED) {
+		// counts after the thread exit are lost.
+		return;
+	}
+	{
+		auto                       &list = List();
+		std::lock_guard<std::mutex> lock(list.Mutex);
+		list.Threads.push_back(&t_timeCounters);
+	}
+	t_timeCounters.Registration = ThreadTimeCounters::REGISTERED;
+	static thread_local ThreadExit exit;
+	(void)exit;
+}
+
+} // namespace details
+#endif
+
+TimeCounters TimeCounters::Snapshot() {
+	TimeCounters res;
+#if FORT_TIME_ENABLE_COUNTERS
+	auto                       &list = List();
+	std::lock_guard<std::mutex> lock(list.Mutex);
+	res = list.Exited;
+	for (const auto t : list.Threads) {
+		for (size_t i = 0; i < res.Values.size(); ++i) {
+			res.Values[i] += t->Values[i].load(std::memory_order_relaxed);
+		}
+	}
+#endif
+	return res;
+}
+
+const char *TimeCounters::Name(TimeCounter counter) {
+	static const char *names[] = {
+	    "now",
+	    "compare_mono",
+	    "compare_wall",
+	    "compare_wall_fallback",
+	    "sub_mono",
+	    "sub_wall",
+	    "sub_wall_fallback",
+	    "overflow_thrown",
+	    "time_parse_failure",
+	    "time_try_parse_failure",
+	    "duration_parse_failure",
+	};
+	static_assert(
+	    sizeof(names) / sizeof(names[0]) == size_t(TimeCounter::SIZE),
+	    "a TimeCounter has no name"
+	);
+	if (size_t(counter) >= size_t(TimeCounter::SIZE)) {
+		return "unknown";
+	}
+	return names[size_t(counter)];
+}
+
+} // namespace fort
@@ -0,0 +1,212 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef FORT_TIME_ENABLE_COUNTERS
+#define FORT_TIME_ENABLE_COUNTERS 0
+#endif
+
+namespace fort {
+
+/**
+ * A hot-path event counted by TimeCounters
+ */
+enum class TimeCounter : size_t {
+	/**
+	 * Calls to Time::Now().
+	 */
+	NOW = 0,
+	/**
+	 * Time::Before(), Time::After() or Time::Equals() on the monotonic
+	 * values of the same clock.
+	 */
+	COMPARE_MONO,
+	/**
+	 * Time::Before(), Time::After() or Time::Equals() on wall times,
+	 * as one Time has no monotonic value.
+	 */
+	COMPARE_WALL,
+	/**
+	 * Time::Before(), Time::After() or Time::Equals() falling back to
+	 * wall times, as both Time have monotonic values from different
+	 * clocks.
+	 */
+	COMPARE_WALL_FALLBACK,
+	/**
+	 * Time::Sub() on the monotonic values of the same clock.
+	 */
+	SUB_MONO,
+	/**
+	 * Time::Sub() on wall times, as one Time has no monotonic value.
+	 */
+	SUB_WALL,
+	/**
+	 * Time::Sub() falling back to wall times, as both Time have
+	 * monotonic values from different clocks.
+	 */
+	SUB_WALL_FALLBACK,
+	/**
+	 * Time::Overflow constructed, i.e. thrown.
+	 */
+	OVERFLOW_THROWN,
+	/**
+	 * Time::Parse() failures.
+	 */
+	TIME_PARSE_FAILURE,
+	/**
+	 * TryParseTime() failures, including rows of ParseTimeColumn().
+	 */
+	TIME_TRY_PARSE_FAILURE,
+	/**
+	 * Duration::Parse() failures, and runtime Duration::ParseConstexpr()
+	 * failures.
+	 */
+	DURATION_PARSE_FAILURE,
+	/**
+	 * The number of TimeCounter.
+	 */
+	SIZE,
+};
+
+/**
+ * A snapshot of the hot-path counters of the library
+ *
+ * When libfort-time is built with the `FORT_TIME_ENABLE_COUNTERS`
+ * CMake option, it counts each TimeCounter event, e.g. how often
+ * comparisons silently fall back from monotonic to wall times, or how
+ * many Time::Overflow are thrown. Otherwise Enabled is `false`, counting
+ * compiles to nothing, and Snapshot() returns only zeros.
+ *
+ * Each thread increments its own counters with relaxed atomic loads and
+ * stores, without any lock or read-modify-write operation. Snapshot()
+ * sums the counters of all threads, including threads that
+ * exited. Events counted concurrently to a Snapshot() may only appear in
+ * the next one.
+ *
+ * ```c++
+ * using namespace fort;
+ * auto start = TimeCounters::Snapshot();
+ * ProcessFrames();
+ * auto delta = TimeCounters::Snapshot() - start;
+ * for (size_t i = 0; i < size_t(TimeCounter::SIZE); ++i) {
+ *     std::cout << TimeCounters::Name(TimeCounter(i)) << ": "
+ *               << delta.Values[i] << std::endl;
+ * }
+ * ```
+ */
+struct TimeCounters {
+	/**
+	 * If the counters are compiled in.
+	 */
+	static constexpr bool Enabled = FORT_TIME_ENABLE_COUNTERS != 0;
+
+	/**
+	 * The value of each TimeCounter.
+	 */
+	std::array<uint64_t, size_t(TimeCounter::SIZE)> Values = {};
+
+	/**
+	 * Sums the counters of all threads
+	 *
+	 * @return the counts since the start of the process.
+	 */
+	static TimeCounters Snapshot();
+
+	/**
+	 * Gets the name of a TimeCounter
+	 *
+	 * @param counter the TimeCounter to name
+	 *
+	 * @return a lower case name, e.g. `"compare_wall_fallback"`.
+	 */
+	static const char *Name(TimeCounter counter);
+
+	/**
+	 * Gets the value of a TimeCounter
+	 *
+	 * @param counter the TimeCounter to get
+	 *
+	 * @return the value of counter
+	 */
+	inline uint64_t operator[](TimeCounter counter) const {
+		return Values[size_t(counter)];
+	}
+
+	/**
+	 * Counts since an earlier snapshot
+	 *
+	 * @param earlier an earlier TimeCounters
+	 *
+	 * @return the counts between earlier and this snapshot.
+	 */
+	inline TimeCounters operator-(const TimeCounters &earlier) const {
+		TimeCounters res;
+		for (size_t i = 0; i < Values.size(); ++i) {
+			res.Values[i] = Values[i] - earlier.Values[i];
+		}
+		return res;
+	}
+};
+
+namespace details {
+
+#if FORT_TIME_ENABLE_COUNTERS
+// Counters of a thread, only written by their thread. It is trivially
+// constructible, so accessing it does not need any thread_local
+// initialization check, and registers in the list read by
+// TimeCounters::Snapshot() on its first count.
+struct alignas(64) ThreadTimeCounters {
+	enum State : uint8_t {
+		UNREGISTERED = 0,
+		REGISTERED,
+		EXITED,
+	};
+
+	std::atomic<uint64_t> Values[size_t(TimeCounter::SIZE)];
+	State                 Registration;
+};
+
+extern thread_local ThreadTimeCounters t_timeCounters;
+
+void RegisterThreadTimeCounters();
+#endif
+
+inline void CountTime([[maybe_unused]] TimeCounter counter) {
+#if FORT_TIME_ENABLE_COUNTERS
+	auto &counters = t_timeCounters;
+	if (__builtin_expect(
+	        counters.Registration != ThreadTimeCounters::REGISTERED,
+	        0
+	    )) {
+		RegisterThreadTimeCounters();
+	}
+	auto &c = counters.Values[size_t(counter)];
+	// single writer: no need for an atomic read-modify-write.
+	c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+#endif
+}
+
+} // namespace details
+
+} // namespace fort
@@ -0,0 +1,123 @@
+#include "TimeCounters.hpp"
+
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+#include "Time.hpp"
+#include "TimeColumn.hpp"
+#include "TimeCountersUTest.hpp"
+
+namespace fort {
+
+TEST_F(TimeCountersUTest, HaveNames) {
+	std::set<std::string> names;
+	for (size_t i = 0; i < size_t(TimeCounter::SIZE); ++i) {
+		names.insert(TimeCounters::Name(TimeCounter(i)));
+	}
+	EXPECT_EQ(names.size(), size_t(TimeCounter::SIZE));
+	EXPECT_STREQ(
+	    TimeCounters::Name(TimeCounter::COMPARE_WALL_FALLBACK),
+	    "compare_wall_fallback"
+	);
+	EXPECT_STREQ(TimeCounters::Name(TimeCounter::SIZE), "unknown");
+}
+
+TEST_F(TimeCountersUTest, CountsHotPaths) {
+	auto mono  = Time::Now();
+	auto other = Time::FromTimestampAndMonotonic(mono.ToTimestamp(), 42, 1);
+	auto wall  = Time::FromUnix(0, 0);
+
+	auto start = TimeCounters::Snapshot();
+	Time::Now();
+	Time::Now();
+	mono.Before(mono);
+	mono.After(mono);
+	mono.Equals(wall);
+	mono.Before(other);
+	other.Equals(mono);
+	mono.Sub(mono);
+	mono.Sub(wall);
+	wall.Sub(wall);
+	mono.Sub(other);
+	try {
+		Time::Forever().Sub(wall);
+	} catch (const Time::Overflow &) {
+	}
+	try {
+		Time::Parse("yesterday");
+	} catch (const std::runtime_error &) {
+	}
+	try {
+		Duration::Parse("1fortnight");
+	} catch (const std::runtime_error &) {
+	}
+	Time t;
+	TryParseTime("yesterday", t);
+	TryParseTime("2023-05-12T14:32:45Z", t);
+	auto delta = TimeCounters::Snapshot() - start;
+
+	if (TimeCounters::Enabled == false) {
+		for (auto v : TimeCounters::Snapshot().Values) {
+			EXPECT_EQ(v, 0);
+		}
+		return;
+	}
+	EXPECT_EQ(delta[TimeCounter::NOW], 2);
+	EXPECT_EQ(delta[TimeCounter::COMPARE_MONO], 2);
+	EXPECT_EQ(delta[TimeCounter::COMPARE_WALL], 1);
+	EXPECT_EQ(delta[TimeCounter::COMPARE_WALL_FALLBACK], 2);
+	EXPECT_EQ(delta[TimeCounter::SUB_MONO], 1);
+	EXPECT_EQ(delta[TimeCounter::SUB_WALL], 3);
+	EXPECT_EQ(delta[TimeCounter::SUB_WALL_FALLBACK], 1);
+	EXPECT_EQ(delta[TimeCounter::OVERFLOW_THROWN], 1);
+	EXPECT_EQ(delta[TimeCounter::TIME_PARSE_FAILURE], 1);
+	EXPECT_EQ(delta[TimeCounter::TIME_TRY_PARSE_FAILURE], 1);
+	EXPECT_EQ(delta[TimeCounter::DURATION_PARSE_FAILURE], 1);
+}
+
+TEST_F(TimeCountersUTest, SumsAllThreads) {
+	if (TimeCounters::Enabled == false) {
+		GTEST_SKIP() << "counters are disabled";
+	}
+	auto start = TimeCounters::Snapshot();
+
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < 4; ++i) {
+		threads.emplace_back([]() {
+			for (size_t j = 0; j < 1000; ++j) {
+				Time::Now();
+			}
+		});
+	}
+	for (auto &t : threads) {
+		t.join();
+	}
+	// counters of exited threads are kept.
+	EXPECT_EQ((TimeCounters::Snapshot() - start)[TimeCounter::NOW], 4000);
+
+	bool                    counted = false, done = false;
+	std::mutex              mutex;
+	std::condition_variable cv;
+	std::thread             running([&]() {
+		Time::Now();
+		std::unique_lock<std::mutex> lock(mutex);
+		counted = true;
+		cv.notify_all();
+		cv.wait(lock, [&]() { return done; });
+	});
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		cv.wait(lock, [&]() { return counted; });
+		// counters of running threads too.
+		EXPECT_EQ((TimeCounters::Snapshot() - start)[TimeCounter::NOW], 4001);
+		done = true;
+		cv.notify_all();
+	}
+	running.join();
+	EXPECT_EQ((TimeCounters::Snapshot() - start)[TimeCounter::NOW], 4001);
+}
+
+} // namespace fort
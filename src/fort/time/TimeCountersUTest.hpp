@@ -0,0 +1,9 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+namespace fort {
+
+class TimeCountersUTest : public ::testing::Test {};
+
+} // namespace fort
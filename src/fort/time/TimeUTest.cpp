@@ -170,6 +170,41 @@ TEST_F(TimeUTest,DurationParsing) {
 	}
 }
 
+TEST_F(TimeUTest,DurationParseErrorsQuoteTheUnit) {
+	auto message = [](const std::string & input) -> std::string {
+		try {
+			Duration::Parse(input);
+		} catch ( const std::runtime_error & e ) {
+			return e.what();
+		}
+		return "";
+	};
+	EXPECT_EQ(message("3"), "Could not parse '3':unknown unit ''");
+	EXPECT_EQ(message("3d"), "Could not parse '3d':unknown unit 'd'");
+	EXPECT_EQ(message(""), "Could not parse '':empty");
+}
+
+TEST_F(TimeUTest,DurationIsConstexpr) {
+	static_assert(Duration::Hour == 60 * Duration::Minute);
+	static_assert(Duration::Second.Nanoseconds() == 1000000000);
+	static_assert(2_h + 30_min == 150 * Duration::Minute);
+	static_assert(1.5_h == 90_min);
+	static_assert(100_ms == 0.1_s);
+	static_assert(-3_us < 2_ns);
+	static_assert(Duration(std::chrono::seconds(2)) == 2_s);
+	static_assert("4m32s"_d == 4_min + 32_s);
+	static_assert("-2m3.4s"_d == -(2_min + 3400_ms));
+	static_assert("1h2m3s4ms5us6ns"_d == 1_h + 2_min + 3_s + 4_ms + 5_us + 6_ns);
+	static_assert("12µs"_d == 12_us);
+	static_assert("12μs"_d == 12_us);
+	static_assert(Duration::ParseConstexpr("9223372036854775807ns").Nanoseconds()
+	              == std::numeric_limits<int64_t>::max());
+
+	constexpr Duration fromConfig = "39h9m14.425s"_d;
+	EXPECT_EQ(fromConfig, Duration::Parse("39h9m14.425s"));
+	EXPECT_THROW(Duration::ParseConstexpr("4x"), std::runtime_error);
+	EXPECT_THROW("3000000h"_d, std::runtime_error);
+}
 
 TEST_F(TimeUTest,DurationFormatting) {
 	struct TestData {
@@ -476,6 +511,37 @@ TEST_F(TimeUTest,TimeConversion) {
 	EXPECT_EQ(resInPlace,pb);
 }
 
+TEST_F(TimeUTest,ChronoConversion) {
+	using namespace std::chrono;
+
+	EXPECT_EQ(Duration(-1234567891011LL).ToChrono(),nanoseconds(-1234567891011LL));
+	EXPECT_EQ(Duration(Duration(42ns).ToChrono()),42);
+	static_assert(Duration::Millisecond.ToChrono() == 1ms);
+
+	for ( const auto & t : {Time::FromUnix(1,999999999),
+	                        Time::FromUnix(-2,3),
+	                        Time::FromUnix(1700000000,123456789)} ) {
+		auto tp = t.ToSystemTimePoint();
+		EXPECT_TRUE(Time::FromTimePoint(tp).Equals(t)) << t;
+	}
+	EXPECT_EQ(nanoseconds(Time::FromUnix(-2,3).ToSystemTimePoint().time_since_epoch()),
+	          -1999999997ns);
+	EXPECT_THROW(Time::Forever().ToSystemTimePoint(),Time::Overflow);
+
+	auto now = Time::Now();
+	auto steady = now.ToSteadyTimePoint();
+	EXPECT_EQ(uint64_t(nanoseconds(steady.time_since_epoch()).count()),
+	          now.MonotonicValue());
+	auto back = Time::FromTimePoint(steady);
+	EXPECT_EQ(back.MonotonicValue(),now.MonotonicValue());
+	EXPECT_EQ(back.Sub(now),0);
+	// the wall value is only estimated
+	EXPECT_TRUE(now.Round(Duration::Nanosecond).Sub(back.Round(Duration::Nanosecond)) < Duration::Millisecond);
+	EXPECT_TRUE(steady <= steady_clock::now());
+
+	EXPECT_THROW(Time::FromUnix(0,0).ToSteadyTimePoint(),std::invalid_argument);
+}
+
 TEST_F(TimeUTest,TimeFormat) {
 	struct TestData {
 		Time        T;
@@ -0,0 +1,271 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+#include <system_error>
+
+#include "TimerReactor.hpp"
+
+namespace fort {
+
+static void ThrowErrno(const char *fnct) {
+	throw std::system_error(
+	    errno,
+	    std::system_category(),
+	    std::string("On call of ") + fnct + "()"
+	);
+}
+
+// Consumes a Stop() request when leaving its scope, even on exceptions.
+struct StopConsumer {
+	bool &Stopped;
+
+	~StopConsumer() {
+		Stopped = false;
+	}
+};
+
+static uint64_t MonoNow() {
+	struct timespec mono;
+	clock_gettime(CLOCK_MONOTONIC, &mono);
+	return uint64_t(mono.tv_sec) * 1000000000ULL + mono.tv_nsec;
+}
+
+TimerReactor::TimerReactor()
+    : d_epoll(-1)
+    , d_timer(-1)
+    , d_armed(0)
+    , d_nextID(1)
+    , d_expiring(false)
+    , d_stopped(false) {
+	d_epoll = epoll_create1(EPOLL_CLOEXEC);
+	if (d_epoll < 0) {
+		ThrowErrno("epoll_create1");
+	}
+	d_timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	if (d_timer < 0) {
+		int err = errno;
+		close(d_epoll);
+		errno = err;
+		ThrowErrno("timerfd_create");
+	}
+	struct epoll_event event = {};
+	event.events             = EPOLLIN;
+	event.data.fd            = d_timer;
+	if (epoll_ctl(d_epoll, EPOLL_CTL_ADD, d_timer, &event) < 0) {
+		int err = errno;
+		close(d_timer);
+		close(d_epoll);
+		errno = err;
+		ThrowErrno("epoll_ctl");
+	}
+}
+
+TimerReactor::~TimerReactor() {
+	close(d_timer);
+	close(d_epoll);
+}
+
+TimerReactor::TimerID
+TimerReactor::Schedule(const Time &deadline, Callback callback) {
+	if (deadline.HasMono() == false ||
+	    deadline.MonoID() != Time::SYSTEM_MONOTONIC_CLOCK) {
+		throw std::invalid_argument(
+		    "TimerReactor: deadline has no system monotonic value: " +
+		    deadline.DebugString()
+		);
+	}
+	return Insert(deadline.MonotonicValue(), std::move(callback));
+}
+
+TimerReactor::TimerID
+TimerReactor::ScheduleIn(const Duration &timeout, Callback callback) {
+	uint64_t deadline = MonoNow();
+	if (timeout > 0) {
+		uint64_t ns = timeout.Nanoseconds();
+		deadline    = deadline > UINT64_MAX - ns ? UINT64_MAX : deadline + ns;
+	}
+	return Insert(deadline, std::move(callback));
+}
+
+TimerReactor::TimerID
+TimerReactor::Insert(uint64_t deadline, Callback callback) {
+	TimerID ID = d_nextID++;
+	d_callbacks.emplace(ID, std::move(callback));
+	d_heap.push_back({deadline, ID});
+	std::push_heap(d_heap.begin(), d_heap.end(), std::greater<Entry>());
+	// timers scheduled by callbacks are armed once, after them.
+	if (d_expiring == false) {
+		Arm();
+	}
+	return ID;
+}
+
+bool TimerReactor::Cancel(TimerID ID) {
+	if (d_callbacks.erase(ID) == 0) {
+		return false;
+	}
+	// bounds the cancelled entries kept in the heap.
+	if (d_heap.size() > 2 * d_callbacks.size() + 64) {
+		d_heap.erase(
+		    std::remove_if(
+		        d_heap.begin(),
+		        d_heap.end(),
+		        [this](const Entry &e) { return d_callbacks.count(e.ID) == 0; }
+		    ),
+		    d_heap.end()
+		);
+		std::make_heap(d_heap.begin(), d_heap.end(), std::greater<Entry>());
+	}
+	return true;
+}
+
+void TimerReactor::Arm() {
+	while (d_heap.empty() == false &&
+	       d_callbacks.count(d_heap.front().ID) == 0) {
+		std::pop_heap(d_heap.begin(), d_heap.end(), std::greater<Entry>());
+		d_heap.pop_back();
+	}
+	// a zero it_value disarms the timer.
+	uint64_t deadline =
+	    d_heap.empty() ? 0 : std::max(d_heap.front().Deadline, uint64_t(1));
+	if (deadline == d_armed) {
+		return;
+	}
+	struct itimerspec spec = {};
+	spec.it_value.tv_sec   = deadline / 1000000000ULL;
+	spec.it_value.tv_nsec  = deadline % 1000000000ULL;
+	if (timerfd_settime(d_timer, TFD_TIMER_ABSTIME, &spec, nullptr) < 0) {
+		ThrowErrno("timerfd_settime");
+	}
+	d_armed = deadline;
+}
+
+size_t TimerReactor::RunOnce(const Duration &timeout) {
+	if (d_stopped) {
+		d_stopped = false;
+		return 0;
+	}
+	StopConsumer consume{d_stopped};
+	return Poll(timeout);
+}
+
+size_t TimerReactor::Poll(const Duration &timeout) {
+	Arm();
+	if (d_callbacks.empty() && timeout < 0) {
+		return 0;
+	}
+	int ms = -1;
+	if (timeout >= 0) {
+		// rounds up, not to wake up before a deadline.
+		ms = int(std::min(
+		    (timeout.Nanoseconds() + 999999) / 1000000,
+		    int64_t(INT_MAX)
+		));
+	}
+	struct epoll_event event;
+	int                res;
+	while ((res = epoll_wait(d_epoll, &event, 1, ms)) < 0 && errno == EINTR) {
+	}
+	if (res < 0) {
+		ThrowErrno("epoll_wait");
+	}
+	if (res > 0) {
+		uint64_t expirations;
+		if (read(d_timer, &expirations, sizeof(expirations)) < 0 &&
+		    errno != EAGAIN) {
+			ThrowErrno("read");
+		}
+		// the timer is one-shot.
+		d_armed = 0;
+	}
+	size_t called = Expire(MonoNow());
+	Arm();
+	return called;
+}
+
+size_t TimerReactor::Expire(uint64_t now) {
+	// collects due timers first, so callbacks scheduling new due timers
+	// do not starve this call.
+	std::vector<Entry> due;
+	due.swap(d_due);
+	due.clear();
+	while (d_heap.empty() == false && d_heap.front().Deadline <= now) {
+		std::pop_heap(d_heap.begin(), d_heap.end(), std::greater<Entry>());
+		due.push_back(d_heap.back());
+		d_heap.pop_back();
+	}
+
+	// keeps the due timers after it for a later call.
+	auto requeue = [&](std::vector<Entry>::iterator it) {
+		for (++it; it != due.end(); ++it) {
+			d_heap.push_back(*it);
+			std::push_heap(d_heap.begin(), d_heap.end(), std::greater<Entry>());
+		}
+	};
+
+	size_t called = 0;
+	d_expiring    = true;
+	for (auto it = due.begin(); it != due.end(); ++it) {
+		// a previous callback may have cancelled it.
+		auto found = d_callbacks.find(it->ID);
+		if (found == d_callbacks.end()) {
+			continue;
+		}
+		auto callback = std::move(found->second);
+		d_callbacks.erase(found);
+		try {
+			callback();
+		} catch (...) {
+			requeue(it);
+			d_due.swap(due);
+			d_expiring = false;
+			Arm();
+			throw;
+		}
+		++called;
+		if (d_stopped) {
+			requeue(it);
+			break;
+		}
+	}
+	d_due.swap(due);
+	d_expiring = false;
+	return called;
+}
+
+void TimerReactor::Run() {
+	StopConsumer consume{d_stopped};
+	while (d_stopped == false && d_callbacks.empty() == false) {
+		Poll(-1);
+	}
+}
+
+void TimerReactor::Stop() {
+	d_stopped = true;
+}
+
+} // namespace fort
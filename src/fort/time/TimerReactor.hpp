@@ -0,0 +1,346 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#define FORT_TIME_HAS_COROUTINES 1
+#endif
+
+#include "Time.hpp"
+
+namespace fort {
+
+/**
+ * A single-threaded event loop for Time deadlines
+ *
+ * TimerReactor schedules callbacks at Time deadlines on the
+ * #Time::SYSTEM_MONOTONIC_CLOCK. Timers are kept in a binary heap, and
+ * a single `timerfd` is armed at the earliest deadline, so any number
+ * of timers only need one file descriptor, watched by an `epoll`
+ * instance. Run() sleeps in `epoll_wait()` until the earliest deadline
+ * and calls the due callbacks, in deadline order.
+ *
+ * ```c++
+ * using namespace fort;
+ * TimerReactor reactor;
+ * reactor.ScheduleIn(2 * Duration::Second, []() {
+ *     std::cout << "two seconds" << std::endl;
+ * });
+ * reactor.Run();
+ * ```
+ *
+ * With C++20 coroutines, SleepFor() and SleepUntil() suspend a
+ * coroutine until a deadline, so thousands of concurrent timeouts can
+ * share one thread:
+ *
+ * ```c++
+ * Task Acquire(TimerReactor &reactor, Camera &camera) {
+ *     for (;;) {
+ *         co_await SleepFor(reactor, 100 * Duration::Millisecond);
+ *         camera.Trigger();
+ *     }
+ * }
+ * ```
+ *
+ * Timers scheduled from callbacks or resumed coroutines re-arm the
+ * `timerfd` only once, after them. Since it uses `CLOCK_MONOTONIC`,
+ * timers ignore any Clock installed with a Clock::Override. A
+ * TimerReactor is not thread-safe: all methods must be called from the
+ * thread running it, including from callbacks.
+ */
+class TimerReactor {
+public:
+	/**
+	 * Identifies a scheduled timer
+	 */
+	typedef uint64_t TimerID;
+
+	/**
+	 * A timer callback
+	 */
+	typedef std::function<void()> Callback;
+
+	/**
+	 * Creates a TimerReactor
+	 *
+	 * @throws std::system_error if the `epoll` instance or the `timerfd`
+	 *         cannot be created.
+	 */
+	TimerReactor();
+
+	/**
+	 * Closes the file descriptors. Pending timers never fire.
+	 */
+	~TimerReactor();
+
+	TimerReactor(const TimerReactor &)            = delete;
+	TimerReactor &operator=(const TimerReactor &) = delete;
+
+	/**
+	 * Schedules a callback at a deadline
+	 *
+	 * @param deadline the Time to call callback at. It must have a
+	 *        #Time::SYSTEM_MONOTONIC_CLOCK value, like any Time derived
+	 *        from Time::Now().
+	 * @param callback the function to call. It is called from Run() or
+	 *        RunOnce(), never before deadline.
+	 *
+	 * @return a TimerID to Cancel() the timer
+	 *
+	 * @throws std::invalid_argument if deadline has no
+	 *         #Time::SYSTEM_MONOTONIC_CLOCK value.
+	 */
+	TimerID Schedule(const Time &deadline, Callback callback);
+
+	/**
+	 * Schedules a callback after a timeout
+	 *
+	 * @param timeout the Duration to wait for, from now. Negative
+	 *        values are considered zero.
+	 * @param callback the function to call
+	 *
+	 * @return a TimerID to Cancel() the timer
+	 */
+	TimerID ScheduleIn(const Duration &timeout, Callback callback);
+
+	/**
+	 * Cancels a pending timer
+	 *
+	 * @param ID the TimerID returned by Schedule() or ScheduleIn()
+	 *
+	 * @return `true` if the timer was pending, `false` if it already
+	 *         fired or was cancelled.
+	 */
+	bool Cancel(TimerID ID);
+
+	/**
+	 * Waits for and calls due callbacks once
+	 *
+	 * @param timeout the maximal Duration to wait for the earliest
+	 *        deadline. Negative values wait until it.
+	 *
+	 * @return the number of callbacks called, possibly zero. Returns
+	 *         immediately if there are no pending timers and timeout is
+	 *         negative.
+	 *
+	 * @throws std::system_error on `epoll_wait()` or `timerfd` errors.
+	 */
+	size_t RunOnce(const Duration &timeout = -1);
+
+	/**
+	 * Calls callbacks until no timer is pending, or Stop() is called
+	 */
+	void Run();
+
+	/**
+	 * Makes Run() or RunOnce() return after the current callback.
+	 *
+	 * The remaining due callbacks are kept for later calls. A Stop()
+	 * only ends one call: if neither Run() nor RunOnce() is running,
+	 * the next call to one of them returns without calling any
+	 * callback.
+	 */
+	void Stop();
+
+	/**
+	 * Gets the number of pending timers
+	 *
+	 * @return the number of timers scheduled and not yet fired or
+	 *         cancelled.
+	 */
+	inline size_t Size() const {
+		return d_callbacks.size();
+	}
+
+	/**
+	 * Gets the `epoll` file descriptor
+	 *
+	 * @return a file descriptor readable when a timer is due, to
+	 *         nest the TimerReactor in another event loop calling
+	 *         RunOnce() with a zero timeout.
+	 */
+	inline int FileDescriptor() const {
+		return d_epoll;
+	}
+
+private:
+	struct Entry {
+		uint64_t Deadline;
+		TimerID  ID;
+
+		inline bool operator>(const Entry &other) const {
+			return Deadline > other.Deadline ||
+			       (Deadline == other.Deadline && ID > other.ID);
+		}
+	};
+
+	TimerID Insert(uint64_t deadline, Callback callback);
+
+	void Arm();
+
+	size_t Poll(const Duration &timeout);
+
+	size_t Expire(uint64_t now);
+
+	int d_epoll;
+	int d_timer;
+
+	// min-heap of deadlines. Cancelled timers are only removed from
+	// d_callbacks, and skipped once on top of the heap.
+	std::vector<Entry>                    d_heap;
+	std::unordered_map<TimerID, Callback> d_callbacks;
+	std::vector<Entry>                    d_due;
+
+	uint64_t d_armed;
+	TimerID  d_nextID;
+	bool     d_expiring;
+	bool     d_stopped;
+};
+
+#ifdef FORT_TIME_HAS_COROUTINES
+/**
+ * An awaitable suspending a coroutine on a TimerReactor
+ *
+ * Returned by SleepFor() and SleepUntil(). The coroutine is resumed
+ * from TimerReactor::Run() or TimerReactor::RunOnce() once the deadline
+ * is passed, never inline. If the coroutine is destroyed while
+ * suspended, its timer is cancelled.
+ *
+ * Only available when compiled with C++20 coroutine support.
+ */
+class [[nodiscard]] TimerReactorSleep {
+public:
+	/**
+	 * Sleeps until a deadline
+	 *
+	 * @param reactor the TimerReactor resuming the coroutine
+	 * @param deadline the Time to resume at. It must have a
+	 *        #Time::SYSTEM_MONOTONIC_CLOCK value.
+	 */
+	inline TimerReactorSleep(TimerReactor &reactor, const Time &deadline)
+	    : d_reactor(reactor)
+	    , d_deadline(deadline)
+	    , d_timeout(0)
+	    , d_hasDeadline(true)
+	    , d_ID(0) {}
+
+	/**
+	 * Sleeps for a Duration from the suspension
+	 *
+	 * @param reactor the TimerReactor resuming the coroutine
+	 * @param timeout the Duration to sleep for
+	 */
+	inline TimerReactorSleep(TimerReactor &reactor, const Duration &timeout)
+	    : d_reactor(reactor)
+	    , d_timeout(timeout)
+	    , d_hasDeadline(false)
+	    , d_ID(0) {}
+
+	/**
+	 * Cancels the timer if the coroutine was not resumed yet.
+	 */
+	inline ~TimerReactorSleep() {
+		if (d_ID != 0) {
+			d_reactor.Cancel(d_ID);
+		}
+	}
+
+	TimerReactorSleep(const TimerReactorSleep &)            = delete;
+	TimerReactorSleep &operator=(const TimerReactorSleep &) = delete;
+
+	/**
+	 * Always suspends.
+	 */
+	inline bool await_ready() const noexcept {
+		return false;
+	}
+
+	/**
+	 * Schedules the resumption of the coroutine
+	 *
+	 * @param coroutine the suspended coroutine
+	 *
+	 * @throws std::invalid_argument if the deadline has no
+	 *         #Time::SYSTEM_MONOTONIC_CLOCK value.
+	 */
+	inline void await_suspend(std::coroutine_handle<> coroutine) {
+		auto resume = [this, coroutine]() {
+			d_ID = 0;
+			coroutine.resume();
+		};
+		d_ID = d_hasDeadline ? d_reactor.Schedule(d_deadline, resume)
+		                     : d_reactor.ScheduleIn(d_timeout, resume);
+	}
+
+	/**
+	 * Resumes without value.
+	 */
+	inline void await_resume() const noexcept {}
+
+private:
+	TimerReactor         &d_reactor;
+	Time                  d_deadline;
+	Duration              d_timeout;
+	bool                  d_hasDeadline;
+	TimerReactor::TimerID d_ID;
+};
+
+/**
+ * Suspends a coroutine for a Duration
+ *
+ * ```c++
+ * co_await SleepFor(reactor, 10 * Duration::Millisecond);
+ * ```
+ *
+ * @param reactor the TimerReactor resuming the coroutine
+ * @param timeout the Duration to sleep for, from the suspension
+ *
+ * @return an awaitable TimerReactorSleep
+ */
+[[nodiscard]] inline TimerReactorSleep
+SleepFor(TimerReactor &reactor, const Duration &timeout) {
+	return TimerReactorSleep(reactor, timeout);
+}
+
+/**
+ * Suspends a coroutine until a deadline
+ *
+ * ```c++
+ * co_await SleepUntil(reactor, start.Add(10 * Duration::Millisecond));
+ * ```
+ *
+ * @param reactor the TimerReactor resuming the coroutine
+ * @param deadline the Time to resume at. It must have a
+ *        #Time::SYSTEM_MONOTONIC_CLOCK value.
+ *
+ * @return an awaitable TimerReactorSleep
+ */
+[[nodiscard]] inline TimerReactorSleep
+SleepUntil(TimerReactor &reactor, const Time &deadline) {
+	return TimerReactorSleep(reactor, deadline);
+}
+#endif
+
+} // namespace fort
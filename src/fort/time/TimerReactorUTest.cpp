@@ -0,0 +1,237 @@
+#include "TimerReactor.hpp"
+
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "TimerReactorUTest.hpp"
+
+namespace fort {
+
+TEST_F(TimerReactorUTest, FiresInDeadlineOrder) {
+	TimerReactor     reactor;
+	std::vector<int> fired;
+	auto             start = Time::Now();
+	reactor.ScheduleIn(3 * Duration::Millisecond, [&]() { fired.push_back(3); });
+	reactor.Schedule(start.Add(Duration::Millisecond), [&]() {
+		fired.push_back(1);
+	});
+	reactor.ScheduleIn(2 * Duration::Millisecond, [&]() { fired.push_back(2); });
+	// in the past
+	reactor.Schedule(start.Add(-Duration::Second), [&]() {
+		fired.push_back(0);
+	});
+	EXPECT_EQ(reactor.Size(), 4);
+	EXPECT_GE(reactor.FileDescriptor(), 0);
+
+	reactor.Run();
+	EXPECT_EQ(fired, std::vector<int>({0, 1, 2, 3}));
+	EXPECT_GE(Time::Now().Sub(start), 3 * Duration::Millisecond);
+	EXPECT_EQ(reactor.Size(), 0);
+	EXPECT_EQ(reactor.RunOnce(), 0);
+	EXPECT_EQ(reactor.RunOnce(0), 0);
+}
+
+TEST_F(TimerReactorUTest, CancelsTimers) {
+	TimerReactor reactor;
+	int          fired = 0;
+
+	auto first  = reactor.ScheduleIn(Duration::Millisecond, [&]() { ++fired; });
+	auto second = reactor.ScheduleIn(Duration::Millisecond, [&]() {
+		fired += 10;
+	});
+	// cancelled from a due callback
+	reactor.ScheduleIn(0, [&]() { reactor.Cancel(second); });
+	EXPECT_TRUE(reactor.Cancel(first));
+	EXPECT_FALSE(reactor.Cancel(first));
+	EXPECT_FALSE(reactor.Cancel(0));
+	reactor.Run();
+	EXPECT_EQ(fired, 0);
+
+	// many cancelled timers do not accumulate
+	for (size_t i = 0; i < 10000; ++i) {
+		reactor.Cancel(reactor.ScheduleIn(Duration::Second, []() {}));
+	}
+	EXPECT_EQ(reactor.Size(), 0);
+	EXPECT_EQ(reactor.RunOnce(0), 0);
+}
+
+TEST_F(TimerReactorUTest, RunsNestedSchedules) {
+	TimerReactor          reactor;
+	int                   ticks = 0;
+	std::function<void()> tick;
+	tick = [&]() {
+		if (++ticks == 5) {
+			reactor.Stop();
+		}
+		reactor.ScheduleIn(Duration::Microsecond, tick);
+	};
+	reactor.ScheduleIn(0, tick);
+	reactor.Run();
+	EXPECT_EQ(ticks, 5);
+	EXPECT_EQ(reactor.Size(), 1);
+}
+
+TEST_F(TimerReactorUTest, StopsAfterTheCurrentCallback) {
+	TimerReactor reactor;
+	int          fired = 0;
+	reactor.ScheduleIn(0, [&]() {
+		++fired;
+		reactor.Stop();
+	});
+	reactor.ScheduleIn(0, [&]() { ++fired; });
+	reactor.Run();
+	EXPECT_EQ(fired, 1);
+	EXPECT_EQ(reactor.Size(), 1);
+
+	// a Stop() outside of Run() applies to the next one.
+	reactor.Stop();
+	reactor.Run();
+	EXPECT_EQ(fired, 1);
+	reactor.Run();
+	EXPECT_EQ(fired, 2);
+	EXPECT_EQ(reactor.Size(), 0);
+}
+
+TEST_F(TimerReactorUTest, StopOnlyEndsOneRunOnce) {
+	TimerReactor reactor;
+	int          fired = 0;
+	reactor.ScheduleIn(0, [&]() {
+		++fired;
+		reactor.Stop();
+	});
+	reactor.ScheduleIn(0, [&]() { ++fired; });
+	EXPECT_EQ(reactor.RunOnce(), 1);
+	EXPECT_EQ(reactor.Size(), 1);
+
+	reactor.ScheduleIn(0, [&]() { ++fired; });
+	reactor.ScheduleIn(0, [&]() { ++fired; });
+	EXPECT_EQ(reactor.RunOnce(), 3);
+	EXPECT_EQ(fired, 4);
+	EXPECT_EQ(reactor.Size(), 0);
+
+	// a Stop() outside of RunOnce() applies to the next one.
+	reactor.ScheduleIn(0, [&]() { ++fired; });
+	reactor.Stop();
+	EXPECT_EQ(reactor.RunOnce(Duration(0)), 0);
+	EXPECT_EQ(reactor.RunOnce(), 1);
+	EXPECT_EQ(fired, 5);
+}
+
+TEST_F(TimerReactorUTest, KeepsTimersOnExceptions) {
+	TimerReactor reactor;
+	int          fired = 0;
+	reactor.ScheduleIn(0, []() { throw std::runtime_error("callback"); });
+	reactor.ScheduleIn(0, [&]() { ++fired; });
+	EXPECT_THROW(reactor.RunOnce(), std::runtime_error);
+	EXPECT_EQ(reactor.Size(), 1);
+	reactor.Run();
+	EXPECT_EQ(fired, 1);
+}
+
+TEST_F(TimerReactorUTest, RejectsWallDeadlines) {
+	TimerReactor reactor;
+	EXPECT_THROW(
+	    reactor.Schedule(Time::FromUnix(0, 0), []() {}),
+	    std::invalid_argument
+	);
+	EXPECT_EQ(reactor.Size(), 0);
+}
+
+#ifdef FORT_TIME_HAS_COROUTINES
+namespace {
+
+// A minimal eager coroutine, destroyed with its Task.
+struct Task {
+	struct promise_type {
+		Task get_return_object() {
+			return Task{
+			    std::coroutine_handle<promise_type>::from_promise(*this)};
+		}
+
+		std::suspend_never initial_suspend() noexcept {
+			return {};
+		}
+
+		std::suspend_always final_suspend() noexcept {
+			return {};
+		}
+
+		void return_void() {}
+
+		void unhandled_exception() {
+			std::terminate();
+		}
+	};
+
+	Task(std::coroutine_handle<promise_type> handle)
+	    : Handle(handle) {}
+
+	Task(Task &&other)
+	    : Handle(other.Handle) {
+		other.Handle = nullptr;
+	}
+
+	~Task() {
+		if (Handle) {
+			Handle.destroy();
+		}
+	}
+
+	std::coroutine_handle<promise_type> Handle;
+};
+
+Task Sleeper(TimerReactor &reactor, Duration timeout, Time &wokeUp) {
+	co_await SleepFor(reactor, timeout);
+	wokeUp = Time::Now();
+}
+
+Task Ticks(TimerReactor &reactor, Time start, int &ticks) {
+	for (int i = 1; i <= 3; ++i) {
+		co_await SleepUntil(reactor, start.Add(i * Duration::Millisecond));
+		++ticks;
+	}
+}
+
+} // namespace
+
+TEST_F(TimerReactorUTest, ResumesCoroutines) {
+	TimerReactor reactor;
+
+	const size_t          n = 2000;
+	std::mt19937          rng(42);
+	std::vector<Duration> timeouts;
+	std::vector<Time>     wokeUp(n);
+	std::vector<Task>     tasks;
+	auto                  start = Time::Now();
+	for (size_t i = 0; i < n; ++i) {
+		timeouts.push_back(int64_t(rng() % 20000000));
+		tasks.push_back(Sleeper(reactor, timeouts.back(), wokeUp[i]));
+	}
+	int ticks = 0;
+	tasks.push_back(Ticks(reactor, start, ticks));
+	EXPECT_EQ(reactor.Size(), n + 1);
+
+	reactor.Run();
+	for (size_t i = 0; i < n; ++i) {
+		ASSERT_TRUE(tasks[i].Handle.done());
+		EXPECT_GE(wokeUp[i].Sub(start), timeouts[i]);
+	}
+	EXPECT_EQ(ticks, 3);
+	EXPECT_TRUE(tasks.back().Handle.done());
+}
+
+TEST_F(TimerReactorUTest, CancelsDestroyedCoroutines) {
+	TimerReactor reactor;
+	Time         wokeUp;
+	{
+		auto task = Sleeper(reactor, Duration::Millisecond, wokeUp);
+		EXPECT_EQ(reactor.Size(), 1);
+	}
+	EXPECT_EQ(reactor.Size(), 0);
+	reactor.Run();
+	EXPECT_TRUE(wokeUp.Equals(Time()));
+}
+#endif
+
+} // namespace fort
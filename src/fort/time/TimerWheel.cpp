@@ -0,0 +1,244 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+#include "TimerWheel.hpp"
+
+namespace fort {
+
+TimerWheel::TimerWheel(const Duration &resolution, const Time &start)
+    : d_resolution(resolution)
+    , d_startMono(MonoValue(start, "start"))
+    , d_tick(0)
+    , d_size(0) {
+	if (resolution <= 0) {
+		throw std::invalid_argument("TimerWheel resolution must be positive");
+	}
+	d_lists.fill({NONE, NONE});
+	d_levelSizes.fill(0);
+}
+
+uint64_t TimerWheel::MonoValue(const Time &t, const char *what) const {
+	if (t.HasMono() == false || t.MonoID() != Time::SYSTEM_MONOTONIC_CLOCK) {
+		throw std::invalid_argument(
+		    std::string("TimerWheel: ") + what +
+		    " has no system monotonic value: " + t.DebugString()
+		);
+	}
+	return t.MonotonicValue();
+}
+
+TimerWheel::TimerID
+TimerWheel::Schedule(const Time &deadline, Callback callback) {
+	uint64_t mono = MonoValue(deadline, "deadline");
+	uint64_t res  = d_resolution.Nanoseconds();
+	uint64_t tick = 0;
+	if (mono > d_startMono) {
+		// rounds up: a timer never fires before its deadline.
+		tick = (mono - d_startMono + res - 1) / res;
+	}
+
+	uint32_t index;
+	if (d_free.empty() == false) {
+		index = d_free.back();
+		d_free.pop_back();
+	} else {
+		index = d_nodes.size();
+		d_nodes.push_back(Node{0, nullptr, 0, NONE, NONE, NONE});
+	}
+	auto &node = d_nodes[index];
+	node.Tick  = tick;
+	node.Fn    = std::move(callback);
+	Insert(index);
+	++d_size;
+	return (uint64_t(node.Generation) << 32) | index;
+}
+
+TimerWheel::TimerID
+TimerWheel::ScheduleIn(const Duration &timeout, Callback callback) {
+	return Schedule(Time::Now().Add(timeout), std::move(callback));
+}
+
+bool TimerWheel::Cancel(TimerID ID) {
+	uint32_t index      = ID & 0xffffffff;
+	uint32_t generation = ID >> 32;
+	if (index >= d_nodes.size() || d_nodes[index].Generation != generation ||
+	    d_nodes[index].List == NONE) {
+		return false;
+	}
+	Free(index);
+	return true;
+}
+
+void TimerWheel::Insert(uint32_t index) {
+	auto    &node = d_nodes[index];
+	uint32_t list = DUE;
+	if (node.Tick > d_tick) {
+		uint64_t delta = node.Tick - d_tick;
+		size_t   level = 0;
+		while (level < LEVELS - 1 &&
+		       (delta >> (SLOT_BITS * (level + 1))) != 0) {
+			++level;
+		}
+		uint64_t tick = node.Tick;
+		if ((delta >> (SLOT_BITS * LEVELS)) != 0) {
+			// too far in the future, it will be cascaded again
+			tick = d_tick + (uint64_t(1) << (SLOT_BITS * LEVELS)) - 1;
+		}
+		list = level * SLOTS + ((tick >> (SLOT_BITS * level)) & (SLOTS - 1));
+	}
+	// appends to preserve the scheduling order within a tick.
+	node.List = list;
+	node.Prev = d_lists[list].Tail;
+	node.Next = NONE;
+	if (node.Prev != NONE) {
+		d_nodes[node.Prev].Next = index;
+	} else {
+		d_lists[list].Head = index;
+	}
+	d_lists[list].Tail = index;
+	if (list < DUE) {
+		++d_levelSizes[list / SLOTS];
+	}
+}
+
+void TimerWheel::Unlink(uint32_t index) {
+	auto &node = d_nodes[index];
+	if (node.List == NONE || node.List == BATCH) {
+		return;
+	}
+	if (node.Prev != NONE) {
+		d_nodes[node.Prev].Next = node.Next;
+	} else {
+		d_lists[node.List].Head = node.Next;
+	}
+	if (node.Next != NONE) {
+		d_nodes[node.Next].Prev = node.Prev;
+	} else {
+		d_lists[node.List].Tail = node.Prev;
+	}
+	if (node.List < DUE) {
+		--d_levelSizes[node.List / SLOTS];
+	}
+	node.List = NONE;
+}
+
+void TimerWheel::Free(uint32_t index) {
+	Unlink(index);
+	auto &node = d_nodes[index];
+	node.Fn    = nullptr;
+	node.List  = NONE;
+	++node.Generation;
+	d_free.push_back(index);
+	--d_size;
+}
+
+void TimerWheel::Cascade(size_t level) {
+	uint32_t list =
+	    level * SLOTS + ((d_tick >> (SLOT_BITS * level)) & (SLOTS - 1));
+	uint32_t index = d_lists[list].Head;
+	while (index != NONE) {
+		uint32_t next = d_nodes[index].Next;
+		Unlink(index);
+		Insert(index);
+		index = next;
+	}
+}
+
+void TimerWheel::Collect(uint32_t list) {
+	uint32_t index = d_lists[list].Head;
+	while (index != NONE) {
+		uint32_t next = d_nodes[index].Next;
+		Unlink(index);
+		d_nodes[index].List = BATCH;
+		d_batch.push_back({index, d_nodes[index].Generation});
+		index = next;
+	}
+}
+
+uint64_t TimerWheel::NextEventTick() const {
+	// Only boundaries of the finest non-empty level can expire or
+	// cascade timers, we can safely jump to the next one.
+	for (size_t l = 0; l < LEVELS; ++l) {
+		if (d_levelSizes[l] == 0) {
+			continue;
+		}
+		uint64_t width = uint64_t(1) << (SLOT_BITS * l);
+		return (d_tick / width + 1) * width;
+	}
+	return std::numeric_limits<uint64_t>::max();
+}
+
+size_t TimerWheel::Advance(const Time &now) {
+	uint64_t mono   = MonoValue(now, "now");
+	uint64_t target = 0;
+	if (mono > d_startMono) {
+		target = (mono - d_startMono) / d_resolution.Nanoseconds();
+	}
+
+	Collect(DUE);
+	while (d_tick < target) {
+		d_tick = std::min(target, NextEventTick());
+		size_t levels = 1;
+		while (levels < LEVELS &&
+		       (d_tick & ((uint64_t(1) << (SLOT_BITS * levels)) - 1)) == 0) {
+			++levels;
+		}
+		for (size_t l = levels - 1; l > 0; --l) {
+			Cascade(l);
+		}
+		Collect(d_tick & (SLOTS - 1));
+		Collect(DUE);
+	}
+
+	// callbacks may re-enter the wheel, we work on our own batch.
+	std::vector<std::pair<uint32_t, uint32_t>> batch;
+	batch.swap(d_batch);
+	size_t fired = 0;
+	for (auto it = batch.begin(); it != batch.end(); ++it) {
+		const auto [index, generation] = *it;
+		if (d_nodes[index].Generation != generation) {
+			// cancelled by a previous callback
+			continue;
+		}
+		auto fn = std::move(d_nodes[index].Fn);
+		Free(index);
+		++fired;
+		if (fn == nullptr) {
+			continue;
+		}
+		try {
+			fn();
+		} catch (...) {
+			// keeps the remaining due timers for the next Advance().
+			d_batch.insert(d_batch.begin(), std::next(it), batch.end());
+			throw;
+		}
+	}
+	batch.clear();
+	if (d_batch.empty()) {
+		d_batch.swap(batch);
+	}
+	return fired;
+}
+
+} // namespace fort
@@ -0,0 +1,224 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "Time.hpp"
+
+namespace fort {
+
+/**
+ * A hierarchical timer wheel for Time deadlines
+ *
+ * TimerWheel schedules callbacks at Time deadlines on the
+ * #Time::SYSTEM_MONOTONIC_CLOCK, quantized to a fixed resolution
+ * (tick). Timers are kept in #LEVELS wheels of #SLOTS slots, each
+ * level being #SLOTS times coarser than the previous one. Schedule()
+ * and Cancel() are O(1), and Advance() expires all timers due in a
+ * tick in a single batch, cascading far timers to finer levels as
+ * time passes.
+ *
+ * ```c++
+ * using namespace fort;
+ * TimerWheel wheel(10 * Duration::Millisecond);
+ * auto watchdog = wheel.ScheduleIn(2 * Duration::Second, []() {
+ *     RestartCamera();
+ * });
+ * for (;;) {
+ *     ProcessFrame();
+ *     wheel.Cancel(watchdog);
+ *     watchdog = wheel.ScheduleIn(2 * Duration::Second, ...);
+ *     wheel.Advance(Time::Now());
+ * }
+ * ```
+ *
+ * A timer never fires before its deadline, but may fire up to one
+ * resolution after it. A TimerWheel is not thread-safe.
+ */
+class TimerWheel {
+public:
+	/**
+	 * Identifies a scheduled timer
+	 */
+	typedef uint64_t TimerID;
+
+	/**
+	 * Function called when a timer expires
+	 */
+	typedef std::function<void()> Callback;
+
+	/**
+	 * Number of bits of each level.
+	 */
+	const static size_t SLOT_BITS = 6;
+
+	/**
+	 * Number of slots per level.
+	 */
+	const static size_t SLOTS = size_t(1) << SLOT_BITS;
+
+	/**
+	 * Number of levels.
+	 *
+	 * Deadlines further than `SLOTS^LEVELS` ticks are cascaded again
+	 * once they come in range.
+	 */
+	const static size_t LEVELS = 6;
+
+	/**
+	 * Constructor
+	 *
+	 * @param resolution the duration of a tick.
+	 * @param start the initial current Time of the wheel. It must
+	 *        have a #Time::SYSTEM_MONOTONIC_CLOCK value.
+	 *
+	 * @throws std::invalid_argument if resolution is not positive or
+	 *         start has no #Time::SYSTEM_MONOTONIC_CLOCK value.
+	 */
+	TimerWheel(
+	    const Duration &resolution = Duration::Millisecond,
+	    const Time     &start      = Time::Now()
+	);
+
+	/**
+	 * Schedules a timer at a deadline
+	 *
+	 * @param deadline the deadline of the timer. It must have a
+	 *        #Time::SYSTEM_MONOTONIC_CLOCK value, like any Time
+	 *        derived from Time::Now().
+	 * @param callback the function to call on expiration
+	 *
+	 * Timers whose deadline has already passed expire on the next
+	 * call to Advance().
+	 *
+	 * @return a TimerID to Cancel() the timer
+	 *
+	 * @throws std::invalid_argument if deadline has no
+	 *         #Time::SYSTEM_MONOTONIC_CLOCK value.
+	 */
+	TimerID Schedule(const Time &deadline, Callback callback);
+
+	/**
+	 * Schedules a timer after a timeout
+	 *
+	 * @param timeout the Duration from Time::Now() to expiration.
+	 * @param callback the function to call on expiration
+	 *
+	 * @return a TimerID to Cancel() the timer
+	 */
+	TimerID ScheduleIn(const Duration &timeout, Callback callback);
+
+	/**
+	 * Cancels a timer
+	 *
+	 * @param ID the TimerID of the timer to cancel
+	 *
+	 * @return `true` if the timer was cancelled, `false` if it
+	 *         already expired or was cancelled.
+	 */
+	bool Cancel(TimerID ID);
+
+	/**
+	 * Advances the wheel and expires due timers
+	 *
+	 * @param now the current Time. It must have a
+	 *        #Time::SYSTEM_MONOTONIC_CLOCK value.
+	 *
+	 * Calls the callback of every timer due at now, in deadline
+	 * tick order. Callbacks can safely Schedule() or Cancel() timers.
+	 * An exception thrown by a callback is propagated, and the timers
+	 * not yet called are kept for the next Advance().
+	 *
+	 * @return the number of expired timers
+	 *
+	 * @throws std::invalid_argument if now has no
+	 *         #Time::SYSTEM_MONOTONIC_CLOCK value.
+	 */
+	size_t Advance(const Time &now);
+
+	/**
+	 * Gets the number of scheduled timers.
+	 *
+	 * @return the number of timers not yet expired or cancelled.
+	 */
+	inline size_t Size() const {
+		return d_size;
+	}
+
+	/**
+	 * Gets the resolution of the wheel.
+	 *
+	 * @return the Duration of a tick.
+	 */
+	inline Duration Resolution() const {
+		return d_resolution;
+	}
+
+private:
+	const static uint32_t NONE  = 0xffffffff;
+	const static uint32_t DUE   = LEVELS * SLOTS;
+	const static uint32_t BATCH = DUE + 1;
+
+	struct List {
+		uint32_t Head;
+		uint32_t Tail;
+	};
+
+	struct Node {
+		uint64_t Tick;
+		Callback Fn;
+		uint32_t Generation;
+		uint32_t List;
+		uint32_t Prev;
+		uint32_t Next;
+	};
+
+	uint64_t MonoValue(const Time &t, const char *what) const;
+
+	void Insert(uint32_t index);
+
+	void Unlink(uint32_t index);
+
+	void Free(uint32_t index);
+
+	void Cascade(size_t level);
+
+	void Collect(uint32_t list);
+
+	uint64_t NextEventTick() const;
+
+	const Duration d_resolution;
+	const uint64_t d_startMono;
+	uint64_t       d_tick;
+	size_t         d_size;
+
+	std::vector<Node>     d_nodes;
+	std::vector<uint32_t> d_free;
+
+	std::array<List, LEVELS * SLOTS + 1> d_lists;
+	std::array<size_t, LEVELS>           d_levelSizes;
+
+	std::vector<std::pair<uint32_t, uint32_t>> d_batch;
+};
+
+} // namespace fort
@@ -0,0 +1,158 @@
+#include "TimerWheel.hpp"
+
+#include <map>
+#include <random>
+
+#include "TimerWheelUTest.hpp"
+
+namespace fort {
+
+TEST_F(TimerWheelUTest, RejectsNonMonotonicTimes) {
+	EXPECT_THROW(TimerWheel(0), std::invalid_argument);
+	EXPECT_THROW(
+	    TimerWheel(Duration::Millisecond, Time::FromUnix(10, 0)),
+	    std::invalid_argument
+	);
+	TimerWheel wheel;
+	EXPECT_THROW(
+	    wheel.Schedule(Time::FromUnix(10, 0), []() {}),
+	    std::invalid_argument
+	);
+	google::protobuf::Timestamp pb;
+	EXPECT_THROW(
+	    wheel.Schedule(Time::FromTimestampAndMonotonic(pb, 10, 2), []() {}),
+	    std::invalid_argument
+	);
+	EXPECT_THROW(wheel.Advance(Time::Forever()), std::invalid_argument);
+}
+
+TEST_F(TimerWheelUTest, NeverFiresEarly) {
+	auto       start = Time::Now();
+	TimerWheel wheel(Duration::Millisecond, start);
+
+	std::vector<int> fired;
+	wheel.Schedule(start.Add(1500 * Duration::Microsecond), [&]() {
+		fired.push_back(1);
+	});
+	wheel.Schedule(start.Add(-1 * Duration::Second), [&]() {
+		fired.push_back(0);
+	});
+	wheel.Schedule(start.Add(2500 * Duration::Microsecond), [&]() {
+		fired.push_back(2);
+	});
+	EXPECT_EQ(wheel.Size(), 3);
+
+	EXPECT_EQ(wheel.Advance(start), 1);
+	EXPECT_EQ(fired, std::vector<int>({0}));
+	EXPECT_EQ(wheel.Advance(start.Add(1999 * Duration::Microsecond)), 0);
+	EXPECT_EQ(wheel.Advance(start.Add(2 * Duration::Millisecond)), 1);
+	EXPECT_EQ(fired, std::vector<int>({0, 1}));
+	EXPECT_EQ(wheel.Advance(start.Add(3 * Duration::Millisecond)), 1);
+	EXPECT_EQ(fired, std::vector<int>({0, 1, 2}));
+	EXPECT_EQ(wheel.Size(), 0);
+}
+
+TEST_F(TimerWheelUTest, MatchesReferenceOnRandomDeadlines) {
+	auto       start = Time::Now();
+	TimerWheel wheel(Duration::Millisecond, start);
+
+	std::mt19937_64                        rng(1234);
+	std::uniform_int_distribution<int64_t> deadlines(0, int64_t(1) << 40);
+	std::uniform_int_distribution<int64_t> steps(1, int64_t(1) << 24);
+	std::uniform_int_distribution<int>     coin(0, 9);
+	std::vector<int64_t>                   expected;
+	std::vector<int64_t>                   firedAt;
+	std::vector<bool>                      cancelled;
+	std::vector<TimerWheel::TimerID>       IDs;
+	int64_t                                now = 0, previous = 0;
+	std::map<int64_t, int64_t>             previousAdvance;
+
+	for (size_t i = 0; i < 2000; ++i) {
+		int64_t d = deadlines(rng);
+		// a fifth of the timers are far beyond the wheel range
+		if (coin(rng) < 2) {
+			d <<= 12;
+		}
+		expected.push_back(d);
+		firedAt.push_back(-1);
+		cancelled.push_back(false);
+		IDs.push_back(wheel.Schedule(start.Add(d), [&, i]() {
+			firedAt[i] = now;
+		}));
+	}
+	for (size_t i = 0; i < IDs.size(); i += 7) {
+		EXPECT_TRUE(wheel.Cancel(IDs[i]));
+		EXPECT_FALSE(wheel.Cancel(IDs[i]));
+		cancelled[i] = true;
+	}
+
+	while (wheel.Size() > 0) {
+		previous = now;
+		now += steps(rng) << (coin(rng) < 2 ? 18 : 0);
+		previousAdvance[now] = previous;
+		wheel.Advance(start.Add(now));
+	}
+
+	for (size_t i = 0; i < expected.size(); ++i) {
+		if (cancelled[i] == true) {
+			EXPECT_EQ(firedAt[i], -1);
+			continue;
+		}
+		ASSERT_GE(firedAt[i], expected[i]) << "timer " << i;
+		// fired on the first Advance() after its deadline tick
+		int64_t deadlineTick =
+		    (expected[i] + Duration::Millisecond.Nanoseconds() - 1) /
+		    Duration::Millisecond.Nanoseconds() *
+		    Duration::Millisecond.Nanoseconds();
+		EXPECT_GE(firedAt[i], deadlineTick);
+		EXPECT_LT(previousAdvance[firedAt[i]], deadlineTick);
+		EXPECT_FALSE(wheel.Cancel(IDs[i]));
+	}
+}
+
+TEST_F(TimerWheelUTest, CallbacksCanReenter) {
+	auto       start = Time::Now();
+	TimerWheel wheel(Duration::Millisecond, start);
+
+	int                 count = 0;
+	TimerWheel::TimerID second;
+	wheel.Schedule(start.Add(Duration::Millisecond), [&]() {
+		++count;
+		EXPECT_TRUE(wheel.Cancel(second));
+		wheel.Schedule(start.Add(5 * Duration::Millisecond), [&]() {
+			count += 10;
+		});
+	});
+	second = wheel.Schedule(start.Add(Duration::Millisecond), [&]() {
+		count += 100;
+	});
+
+	EXPECT_EQ(wheel.Advance(start.Add(Duration::Millisecond)), 1);
+	EXPECT_EQ(count, 1);
+	EXPECT_EQ(wheel.Size(), 1);
+	EXPECT_EQ(wheel.Advance(start.Add(Duration::Second)), 1);
+	EXPECT_EQ(count, 11);
+}
+
+TEST_F(TimerWheelUTest, KeepsTimersOnExceptions) {
+	auto       start = Time::Now();
+	TimerWheel wheel(Duration::Millisecond, start);
+
+	int fired = 0;
+	wheel.Schedule(start.Add(Duration::Millisecond), []() {
+		throw std::runtime_error("callback");
+	});
+	wheel.Schedule(start.Add(Duration::Millisecond), [&]() { ++fired; });
+
+	EXPECT_THROW(
+	    wheel.Advance(start.Add(Duration::Millisecond)),
+	    std::runtime_error
+	);
+	EXPECT_EQ(fired, 0);
+	EXPECT_EQ(wheel.Size(), 1);
+	EXPECT_EQ(wheel.Advance(start.Add(20 * Duration::Second)), 1);
+	EXPECT_EQ(fired, 1);
+	EXPECT_EQ(wheel.Size(), 0);
+}
+
+} // namespace fort
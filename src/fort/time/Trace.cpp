@@ -0,0 +1,303 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+
+#include "Trace.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define FORT_TIME_HAS_TSC 1
+#else
+#define FORT_TIME_HAS_TSC 0
+#endif
+
+namespace fort {
+
+struct TraceRecorder::ThreadBuffer {
+	// Event, but readable while the owning thread overwrites it.
+	struct Slot {
+		std::atomic<const char *> Name;
+		std::atomic<uint64_t>     Ticks;
+		std::atomic<char>         Phase;
+	};
+
+	ThreadBuffer(size_t capacity)
+	    : Events(capacity)
+	    , Written(0)
+	    , Flushed(0)
+	    , TID(syscall(SYS_gettid)) {}
+
+	// only written by the owning thread
+	std::vector<Slot>     Events;
+	std::atomic<uint64_t> Written;
+
+	// protected by d_mutex
+	uint64_t    Flushed;
+	long        TID;
+	std::string Name;
+};
+
+std::atomic<uint64_t> TraceRecorder::s_nextSerial(0);
+
+namespace {
+thread_local std::map<uint64_t, void *> t_buffers;
+thread_local uint64_t                   t_lastSerial = 0;
+thread_local void                      *t_last       = nullptr;
+
+bool HasInvariantTSC() {
+#if FORT_TIME_HAS_TSC
+	unsigned int eax, ebx, ecx, edx;
+	if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) == 0) {
+		return false;
+	}
+	return (edx & (1 << 8)) != 0;
+#else
+	return false;
+#endif
+}
+
+uint64_t MonoNanoseconds() {
+	struct timespec mono;
+	clock_gettime(CLOCK_MONOTONIC, &mono);
+	return uint64_t(mono.tv_sec) * 1000000000ULL + mono.tv_nsec;
+}
+
+size_t NextPowerOfTwo(size_t v) {
+	size_t res = 1;
+	while (res < v) {
+		res <<= 1;
+	}
+	return res;
+}
+
+void WriteJSONString(std::ostream &out, const char *s) {
+	out << '"';
+	for (; *s != 0; ++s) {
+		switch (*s) {
+		case '"':
+			out << "\\\"";
+			break;
+		case '\\':
+			out << "\\\\";
+			break;
+		case '\n':
+			out << "\\n";
+			break;
+		case '\t':
+			out << "\\t";
+			break;
+		default:
+			if ((unsigned char)(*s) < 0x20) {
+				out << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+				    << int(*s) << std::dec << std::setfill(' ');
+			} else {
+				out << *s;
+			}
+		}
+	}
+	out << '"';
+}
+
+void WriteMicroseconds(std::ostream &out, uint64_t ns) {
+	out << ns / 1000 << '.' << std::setw(3) << std::setfill('0') << ns % 1000
+	    << std::setfill(' ');
+}
+} // namespace
+
+TraceRecorder::TraceRecorder(size_t capacity)
+    : d_serial(++s_nextSerial)
+    , d_capacity(NextPowerOfTwo(std::max(capacity, size_t(2))))
+    , d_useTSC(HasInvariantTSC())
+    , d_start(Time::Now()) {
+	Calibrate(d_startTicks, d_startMono);
+}
+
+TraceRecorder::~TraceRecorder() {}
+
+TraceRecorder::ThreadBuffer *TraceRecorder::LocalBuffer() {
+	if (t_lastSerial == d_serial && t_last != nullptr) {
+		return static_cast<ThreadBuffer *>(t_last);
+	}
+	auto &buffer = t_buffers[d_serial];
+	if (buffer == nullptr) {
+		std::lock_guard<std::mutex> lock(d_mutex);
+		d_buffers.push_back(std::make_unique<ThreadBuffer>(d_capacity));
+		buffer = d_buffers.back().get();
+	}
+	t_lastSerial = d_serial;
+	t_last       = buffer;
+	return static_cast<ThreadBuffer *>(buffer);
+}
+
+inline uint64_t TraceRecorder::Ticks() const {
+#if FORT_TIME_HAS_TSC
+	if (d_useTSC) {
+		return __rdtsc();
+	}
+#endif
+	return MonoNanoseconds();
+}
+
+void TraceRecorder::Calibrate(uint64_t &ticks, uint64_t &mono) const {
+	// brackets the tick reading with two clock readings, to reduce
+	// the error of the (ticks,mono) pair.
+	uint64_t before = MonoNanoseconds();
+	ticks           = Ticks();
+	uint64_t after  = MonoNanoseconds();
+	mono            = before + (after - before) / 2;
+}
+
+void TraceRecorder::Record(const char *name, char phase) {
+	auto     buffer = LocalBuffer();
+	uint64_t ticks  = Ticks();
+	uint64_t i      = buffer->Written.load(std::memory_order_relaxed);
+	auto    &e      = buffer->Events[i & (d_capacity - 1)];
+	// orders the previous Written store before the slot overwrite, so
+	// a Flush() that reads the new values sees Written >= i.
+	std::atomic_thread_fence(std::memory_order_release);
+	e.Name.store(name, std::memory_order_relaxed);
+	e.Ticks.store(ticks, std::memory_order_relaxed);
+	e.Phase.store(phase, std::memory_order_relaxed);
+	buffer->Written.store(i + 1, std::memory_order_release);
+}
+
+void TraceRecorder::Begin(const char *name) {
+	Record(name, 'B');
+}
+
+void TraceRecorder::End() {
+	Record(nullptr, 'E');
+}
+
+void TraceRecorder::Instant(const char *name) {
+	Record(name, 'i');
+}
+
+void TraceRecorder::SetThreadName(const std::string &name) {
+	auto                        buffer = LocalBuffer();
+	std::lock_guard<std::mutex> lock(d_mutex);
+	buffer->Name = name;
+}
+
+void TraceRecorder::Flush(std::ostream &out) {
+	std::lock_guard<std::mutex> lock(d_mutex);
+
+	const auto pid     = getpid();
+	uint64_t   dropped = 0;
+	bool       first   = true;
+
+	auto separate = [&]() {
+		if (first == false) {
+			out << ",\n";
+		}
+		first = false;
+	};
+
+	uint64_t nowTicks, nowMono;
+	Calibrate(nowTicks, nowMono);
+	double nanosPerTick = 1.0;
+	if (d_useTSC && nowTicks > d_startTicks) {
+		nanosPerTick =
+		    double(nowMono - d_startMono) / double(nowTicks - d_startTicks);
+	}
+	auto toMono = [&](uint64_t ticks) -> uint64_t {
+		if (d_useTSC == false) {
+			return ticks;
+		}
+		return d_startMono +
+		       int64_t(double(int64_t(ticks - d_startTicks)) * nanosPerTick);
+	};
+
+	out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+	std::vector<Event> events;
+	for (const auto &buffer : d_buffers) {
+		if (buffer->Name.empty() == false) {
+			separate();
+			out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+			    << ",\"tid\":" << buffer->TID << ",\"args\":{\"name\":";
+			WriteJSONString(out, buffer->Name.c_str());
+			out << "}}";
+		}
+
+		uint64_t end   = buffer->Written.load(std::memory_order_acquire);
+		uint64_t start =
+		    std::max(buffer->Flushed, end - std::min(end, d_capacity));
+		dropped += start - buffer->Flushed;
+		events.clear();
+		for (uint64_t i = start; i < end; ++i) {
+			const auto &e = buffer->Events[i & (d_capacity - 1)];
+			events.push_back(
+			    {e.Name.load(std::memory_order_relaxed),
+			     e.Ticks.load(std::memory_order_relaxed),
+			     e.Phase.load(std::memory_order_relaxed)}
+			);
+		}
+		// discards the events that were overwritten while we copied
+		// them. Event after may already be overwriting after+1-capacity.
+		std::atomic_thread_fence(std::memory_order_acquire);
+		uint64_t after = buffer->Written.load(std::memory_order_relaxed) + 1;
+		uint64_t valid = after - std::min(after, d_capacity);
+		if (valid > start) {
+			dropped += std::min(valid, end) - start;
+		}
+		buffer->Flushed = end;
+
+		for (uint64_t i = std::max(start, valid); i < end; ++i) {
+			const auto &e = events[i - start];
+			separate();
+			out << "{\"ph\":\"" << e.Phase << "\",\"pid\":" << pid
+			    << ",\"tid\":" << buffer->TID << ",\"ts\":";
+			WriteMicroseconds(out, toMono(e.Ticks));
+			if (e.Name != nullptr) {
+				out << ",\"name\":";
+				WriteJSONString(out, e.Name);
+			}
+			if (e.Phase == 'i') {
+				out << ",\"s\":\"t\"";
+			}
+			out << "}";
+		}
+	}
+	out << "\n],\"otherData\":{\"clock\":\"CLOCK_MONOTONIC\",\"monoclockID\":"
+	    << Time::SYSTEM_MONOTONIC_CLOCK << ",\"start\":\"" << d_start.Format()
+	    << "\",\"startMono\":" << d_start.MonotonicValue()
+	    << ",\"droppedEvents\":" << dropped << "}}\n";
+}
+
+void TraceRecorder::Flush(const std::string &filepath) {
+	std::ofstream out(filepath, std::ios::trunc);
+	if (!out) {
+		throw std::runtime_error("Could not open '" + filepath + "'");
+	}
+	Flush(out);
+	out.close();
+	if (!out) {
+		throw std::runtime_error("Could not write '" + filepath + "'");
+	}
+}
+
+} // namespace fort
@@ -0,0 +1,193 @@
+// libfort-time - Time Utilities for the FORmicidae Tracker.
+//
+// Copyright (C) 2017-2023  Universitée de Lausanne.
+//
+//  This file is part of libfort-time.
+//
+// libfort-time is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// libfort-time is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License along with
+// libfort-time.  If not, see <http://www.gnu.org/licenses/>.
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Time.hpp"
+
+namespace fort {
+
+/**
+ * Records per-thread spans and exports them as a Chrome trace
+ *
+ * A TraceRecorder records begin and end events, stamped with the
+ * #Time::SYSTEM_MONOTONIC_CLOCK value, in a fixed size ring buffer
+ * owned by each recording thread. Recording only reads the clock and
+ * writes to the thread buffer: it takes no lock and does not
+ * allocate, except for the first event of each thread. On x86 CPUs
+ * with an invariant time-stamp counter, events are stamped with the
+ * TSC and converted to monotonic nanoseconds on Flush(), which is
+ * several times cheaper than `clock_gettime()`.
+ *
+ * Flush() writes all buffered events in the [Chrome Trace Event
+ * Format](https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU),
+ * which can be opened in `chrome://tracing` or in the
+ * [Perfetto UI](https://ui.perfetto.dev).
+ *
+ * ```c++
+ * using namespace fort;
+ * TraceRecorder trace;
+ * trace.SetThreadName("detection");
+ * for ( const auto & frame : frames ) {
+ *     TraceRecorder::Span span(trace,"process");
+ *     Process(frame);
+ * }
+ * trace.Flush("/tmp/detection.json");
+ * ```
+ *
+ * When a thread records more events than the ring buffer capacity
+ * between two Flush(), the oldest events are dropped. As the thread
+ * may overwrite a slot while Flush() reads it, a full ring buffer
+ * only yields its capacity minus one latest events.
+ */
+class TraceRecorder {
+public:
+	/**
+	 * Records a span for the lifetime of a scope.
+	 */
+	class Span {
+	public:
+		/**
+		 * Begins a span
+		 *
+		 * @param recorder the TraceRecorder to record to
+		 * @param name the name of the span. It must outlive the
+		 *        recorder, typically a string literal.
+		 */
+		inline Span(TraceRecorder &recorder, const char *name)
+		    : d_recorder(recorder) {
+			d_recorder.Begin(name);
+		}
+
+		/**
+		 * Ends the span.
+		 */
+		inline ~Span() {
+			d_recorder.End();
+		}
+
+		Span(const Span &)            = delete;
+		Span &operator=(const Span &) = delete;
+
+	private:
+		TraceRecorder &d_recorder;
+	};
+
+	/**
+	 * Default number of events per thread ring buffer.
+	 */
+	const static size_t DEFAULT_CAPACITY = 65536;
+
+	/**
+	 * Constructor
+	 *
+	 * @param capacity the number of events each thread can buffer,
+	 *        rounded up to the next power of two.
+	 */
+	TraceRecorder(size_t capacity = DEFAULT_CAPACITY);
+
+	/**
+	 * Destructor
+	 */
+	~TraceRecorder();
+
+	TraceRecorder(const TraceRecorder &)            = delete;
+	TraceRecorder &operator=(const TraceRecorder &) = delete;
+
+	/**
+	 * Begins a span on the current thread
+	 *
+	 * @param name the name of the span. It must outlive the
+	 *        recorder, typically a string literal.
+	 */
+	void Begin(const char *name);
+
+	/**
+	 * Ends the latest begun span on the current thread
+	 */
+	void End();
+
+	/**
+	 * Records an instant event on the current thread
+	 *
+	 * @param name the name of the event. It must outlive the
+	 *        recorder, typically a string literal.
+	 */
+	void Instant(const char *name);
+
+	/**
+	 * Names the current thread in the exported trace
+	 *
+	 * @param name the name of the current thread.
+	 */
+	void SetThreadName(const std::string &name);
+
+	/**
+	 * Writes and discards all buffered events
+	 *
+	 * @param out the stream to write the Chrome trace JSON to.
+	 */
+	void Flush(std::ostream &out);
+
+	/**
+	 * Writes and discards all buffered events to a file
+	 *
+	 * @param filepath the path of the file to write the Chrome trace
+	 *        JSON to. It will be overwritten.
+	 *
+	 * @throws std::runtime_error if the file cannot be written.
+	 */
+	void Flush(const std::string &filepath);
+
+private:
+	struct Event {
+		const char *Name;
+		uint64_t    Ticks;
+		char        Phase;
+	};
+
+	struct ThreadBuffer;
+
+	ThreadBuffer *LocalBuffer();
+
+	void Record(const char *name, char phase);
+
+	uint64_t Ticks() const;
+
+	void Calibrate(uint64_t &ticks, uint64_t &mono) const;
+
+	static std::atomic<uint64_t> s_nextSerial;
+
+	const uint64_t d_serial;
+	const size_t   d_capacity;
+	const bool     d_useTSC;
+	const Time     d_start;
+	uint64_t       d_startTicks, d_startMono;
+
+	std::mutex                                 d_mutex;
+	std::vector<std::unique_ptr<ThreadBuffer>> d_buffers;
+};
+
+} // namespace fort
@@ -0,0 +1,107 @@
+#include "Trace.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "TraceUTest.hpp"
+
+namespace fort {
+
+static size_t CountOccurences(const std::string &s, const std::string &what) {
+	size_t res = 0;
+	for (auto pos = s.find(what); pos != std::string::npos;
+	     pos      = s.find(what, pos + what.size())) {
+		++res;
+	}
+	return res;
+}
+
+TEST_F(TraceUTest, RecordsSpansFromThreads) {
+	TraceRecorder trace;
+
+	auto work = [&](const std::string &threadName) {
+		trace.SetThreadName(threadName);
+		for (size_t i = 0; i < 10; ++i) {
+			TraceRecorder::Span outer(trace, "frame");
+			{
+				TraceRecorder::Span inner(trace, "detect \"tags\"");
+				trace.Instant("tag");
+			}
+		}
+	};
+
+	std::thread a(work, "camera"), b(work, "detection");
+	a.join();
+	b.join();
+
+	std::ostringstream out;
+	trace.Flush(out);
+	auto json = out.str();
+
+	EXPECT_EQ(CountOccurences(json, "\"ph\":\"B\""), 40);
+	EXPECT_EQ(CountOccurences(json, "\"ph\":\"E\""), 40);
+	EXPECT_EQ(CountOccurences(json, "\"ph\":\"i\""), 20);
+	EXPECT_EQ(CountOccurences(json, "\"name\":\"frame\""), 20);
+	EXPECT_EQ(CountOccurences(json, "\"name\":\"detect \\\"tags\\\"\""), 20);
+	EXPECT_EQ(CountOccurences(json, "\"thread_name\""), 2);
+	EXPECT_EQ(CountOccurences(json, "\"name\":\"camera\""), 1);
+	EXPECT_EQ(CountOccurences(json, "\"name\":\"detection\""), 1);
+	EXPECT_EQ(CountOccurences(json, "\"droppedEvents\":0"), 1);
+
+	// events are discarded once flushed
+	std::ostringstream again;
+	trace.Flush(again);
+	EXPECT_EQ(CountOccurences(again.str(), "\"ph\":"), 2);
+}
+
+TEST_F(TraceUTest, TimestampsAreMonotonic) {
+	TraceRecorder trace;
+	auto          before = Time::Now();
+	trace.Begin("a");
+	trace.End();
+	auto after = Time::Now();
+
+	std::ostringstream out;
+	trace.Flush(out);
+	auto json = out.str();
+
+	std::vector<double> ts;
+	for (auto pos = json.find("\"ts\":"); pos != std::string::npos;
+	     pos      = json.find("\"ts\":", pos + 1)) {
+		ts.push_back(std::stod(json.substr(pos + 5)));
+	}
+	ASSERT_EQ(ts.size(), 2);
+	EXPECT_LE(ts[0], ts[1]);
+	EXPECT_GE(ts[0] * 1000.0, double(before.MonotonicValue() - 1000));
+	EXPECT_LE(ts[1] * 1000.0, double(after.MonotonicValue() + 1000));
+}
+
+TEST_F(TraceUTest, DropsOldestEvents) {
+	TraceRecorder trace(10);
+	for (size_t i = 0; i < 100; ++i) {
+		trace.Instant("event");
+	}
+	std::ostringstream out;
+	trace.Flush(out);
+	auto json = out.str();
+	// the slot after the latest event may be overwritten while
+	// flushing, so only capacity - 1 events are kept.
+	EXPECT_EQ(CountOccurences(json, "\"ph\":\"i\""), 15);
+	EXPECT_EQ(CountOccurences(json, "\"droppedEvents\":85"), 1);
+}
+
+TEST_F(TraceUTest, FlushToFile) {
+	TraceRecorder trace;
+	trace.Instant("event");
+	std::string path = testing::TempDir() + "/fort-time-trace.json";
+	trace.Flush(path);
+	std::ifstream      in(path);
+	std::ostringstream content;
+	content << in.rdbuf();
+	EXPECT_EQ(CountOccurences(content.str(), "\"name\":\"event\""), 1);
+
+	EXPECT_THROW(trace.Flush("/does/not/exist/trace.json"), std::runtime_error);
+}
+
+} // namespace fort